@@ -19,27 +19,13 @@
 
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
-#include <QCoreApplication>
 #include <QDebug>
 #include <QFile>
 
-#include "audiodecoder.h"
-#include "audiorenderer.h"
 #include "audioplugincache.h"
-
-#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
-
- #if defined(__APPLE__) || defined(Q_OS_MAC)
-   #include "audiorenderer_portaudio.h"
- #elif defined(WIN32) || defined(Q_OS_WIN)
-   #include "audiorenderer_waveout.h"
- #else
-   #include "audiorenderer_alsa.h"
- #endif
-#else
- #include "audiorenderer_qt.h"
-#endif
-
+#include "audiodecoder.h"
+#include "mastertimer.h"
+#include "audiomixer.h"
 #include "audio.h"
 #include "doc.h"
 
@@ -54,7 +40,9 @@ Audio::Audio(Doc* doc)
   : Function(doc, Function::AudioType)
   , m_doc(doc)
   , m_decoder(NULL)
-  , m_audio_out(NULL)
+  , m_mixer(NULL)
+  , m_voice(AudioMixer::invalidVoice())
+  , m_fadingOut(false)
   , m_audioDevice(QString())
   , m_sourceFileName("")
   , m_audioDuration(0)
@@ -69,11 +57,8 @@ Audio::Audio(Doc* doc)
 
 Audio::~Audio()
 {
-    if (m_audio_out != NULL)
-    {
-        m_audio_out->stop();
-        delete m_audio_out;
-    }
+    if (m_voice != AudioMixer::invalidVoice())
+        m_mixer->removeVoice(m_voice);
     if (m_decoder != NULL)
         delete m_decoder;
 }
@@ -201,25 +186,32 @@ int Audio::adjustAttribute(qreal fraction, int attributeId)
 {
     int attrIndex = Function::adjustAttribute(fraction, attributeId);
 
-    if (m_audio_out != NULL && attrIndex == Intensity)
-        m_audio_out->adjustIntensity(getAttributeValue(Function::Intensity));
+    /* Ramp over a tick, so that intensity changes coming from the
+     * MasterTimer don't click */
+    if (m_voice != AudioMixer::invalidVoice() && m_fadingOut == false && attrIndex == Intensity)
+        m_mixer->setVoiceGain(m_voice, getAttributeValue(Function::Intensity), MasterTimer::tick());
 
     return attrIndex;
 }
 
 void Audio::slotEndOfStream()
 {
-    if (m_audio_out != NULL)
+    if (m_voice != AudioMixer::invalidVoice())
     {
-        m_audio_out->stop();
-        m_audio_out->deleteLater();
-        m_audio_out = NULL;
+        m_mixer->removeVoice(m_voice);
+        m_voice = AudioMixer::invalidVoice();
         m_decoder->seek(0);
     }
     if (!stopped())
         stop(FunctionParent::master());
 }
 
+void Audio::slotVoiceFinished(quint32 voice)
+{
+    if (voice != AudioMixer::invalidVoice() && voice == m_voice)
+        slotEndOfStream();
+}
+
 void Audio::slotFunctionRemoved(quint32 fid)
 {
     Q_UNUSED(fid)
@@ -318,28 +310,23 @@ void Audio::preRun(MasterTimer* timer)
     if (m_decoder != NULL)
     {
         m_decoder->seek(elapsed());
-        AudioParameters ap = m_decoder->audioParameters();
-#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
- #if defined(__APPLE__) || defined(Q_OS_MAC)
-        //m_audio_out = new AudioRendererCoreAudio();
-        m_audio_out = new AudioRendererPortAudio(m_audioDevice);
- #elif defined(WIN32) || defined(Q_OS_WIN)
-        m_audio_out = new AudioRendererWaveOut(m_audioDevice);
- #else
-        m_audio_out = new AudioRendererAlsa(m_audioDevice);
- #endif
-        m_audio_out->moveToThread(QCoreApplication::instance()->thread());
-#else
-        m_audio_out = new AudioRendererQt(m_audioDevice);
-#endif
-        m_audio_out->setDecoder(m_decoder);
-        m_audio_out->initialize(ap.sampleRate(), ap.channels(), ap.format());
-        m_audio_out->adjustIntensity(getAttributeValue(Intensity));
-        m_audio_out->setFadeIn(fadeInSpeed());
-        m_audio_out->setLooped(runOrder() == Audio::Loop);
-        m_audio_out->start();
-        connect(m_audio_out, SIGNAL(endOfStreamReached()),
-                this, SLOT(slotEndOfStream()));
+        m_fadingOut = false;
+
+        if (m_mixer == NULL || m_mixer->device() != m_audioDevice)
+        {
+            if (m_mixer != NULL)
+                disconnect(m_mixer, SIGNAL(voiceFinished(quint32)),
+                           this, SLOT(slotVoiceFinished(quint32)));
+            m_mixer = m_doc->audioPluginCache()->mixer(m_audioDevice);
+            connect(m_mixer, SIGNAL(voiceFinished(quint32)),
+                    this, SLOT(slotVoiceFinished(quint32)));
+        }
+
+        /* Audio functions started during the same tick start
+         * on the very same sample */
+        m_voice = m_mixer->addVoice(m_decoder, m_mixer->startFrame(timer->tickCount()),
+                                    getAttributeValue(Intensity), fadeInSpeed(),
+                                    runOrder() == Audio::Loop);
     }
 
     Function::preRun(timer);
@@ -349,13 +336,8 @@ void Audio::setPause(bool enable)
 {
     if (isRunning())
     {
-        if (m_audio_out != NULL)
-        {
-            if (enable)
-                m_audio_out->suspend();
-            else
-                m_audio_out->resume();
-        }
+        if (m_voice != AudioMixer::invalidVoice())
+            m_mixer->setVoicePaused(m_voice, enable);
 
         Function::setPause(enable);
     }
@@ -373,8 +355,12 @@ void Audio::write(MasterTimer* timer, QList<Universe *> universes)
 
     if (fadeOutSpeed() != 0)
     {
-        if (m_audio_out != NULL && totalDuration() - elapsed() <= fadeOutSpeed())
-            m_audio_out->setFadeOut(fadeOutSpeed());
+        if (m_voice != AudioMixer::invalidVoice() && m_fadingOut == false &&
+            totalDuration() - elapsed() <= fadeOutSpeed())
+        {
+            m_mixer->setVoiceGain(m_voice, 0, fadeOutSpeed());
+            m_fadingOut = true;
+        }
     }
 }
 
@@ -22,11 +22,11 @@
 
 #include <QColor>
 
-#include "audiorenderer.h"
 #include "audiodecoder.h"
 #include "function.h"
 
 class QXmlStreamReader;
+class AudioMixer;
 
 /** @addtogroup engine_functions Functions
  * @{
@@ -122,11 +122,19 @@ signals:
 protected slots:
     void slotEndOfStream();
 
+    /** Catches AudioMixer::voiceFinished() to stop when this function's
+        voice has been played to its end */
+    void slotVoiceFinished(quint32 voice);
+
 private:
     /** Instance of an AudioDecoder to perform actual audio decoding */
     AudioDecoder *m_decoder;
-    /** output interface to render audio data got from m_decoder */
-    AudioRenderer *m_audio_out;
+    /** The mixer playing m_decoder on the audio device */
+    AudioMixer *m_mixer;
+    /** The mixer voice playing m_decoder while running */
+    quint32 m_voice;
+    /** True when a fade out has been requested to the mixer */
+    bool m_fadingOut;
     /** Audio device to use for rendering */
     QString m_audioDevice;
     /** Absolute start time of Audio over a timeline (in milliseconds) */
@@ -43,6 +43,8 @@ AudioCapture::AudioCapture (QObject* parent)
     , m_audioBuffer(NULL)
     , m_fftInputBuffer(NULL)
     , m_fftOutputBuffer(NULL)
+    , m_fftPlan(NULL)
+    , m_fftPlanSize(0)
 {
     int bufferSize = AUDIO_DEFAULT_BUFFER_SIZE;
     m_sampleRate = AUDIO_DEFAULT_SAMPLE_RATE;
@@ -75,6 +77,8 @@ AudioCapture::~AudioCapture()
     // stop() has to be called from the implementation class
     Q_ASSERT(!this->isRunning());
 
+    releaseFFT();
+
     delete[] m_audioBuffer;
     delete[] m_fftInputBuffer;
 #ifdef HAS_FFTW3
@@ -145,27 +149,75 @@ void AudioCapture::stop()
     }
 }
 
+void AudioCapture::prepareFFT()
+{
+#ifdef HAS_FFTW3
+    if (m_fftPlan != NULL && m_fftPlanSize == m_captureSize)
+        return;
+
+    releaseFFT();
+
+    if (m_captureSize == 0)
+        return;
+
+    // The plan is computed once, so it's worth measuring the fastest one.
+    // Planning overwrites the input buffer, which is filled afterwards.
+    m_fftPlan = fftw_plan_dft_r2c_1d(m_captureSize, m_fftInputBuffer,
+                                     (fftw_complex*)m_fftOutputBuffer, FFTW_MEASURE);
+    m_fftPlanSize = m_captureSize;
+
+    m_fftWindow.resize(m_captureSize);
+    for (unsigned int i = 0; i < m_captureSize; i++)
+    {
+#ifdef USE_BLACKMAN
+        double a0 = (1-0.16)/2;
+        double a1 = 0.5;
+        double a2 = 0.16/2;
+        m_fftWindow[i] = a0 - a1 * qCos((M_2PI * i) / (m_captureSize - 1)) +
+                         a2 * qCos((2 * M_2PI * i) / (m_captureSize - 1));
+#endif
+#ifdef USE_HANNING
+        m_fftWindow[i] = 0.5 * (1.00 - qCos((M_2PI * i) / (m_captureSize - 1)));
+#endif
+#ifdef USE_NO_WINDOW
+        m_fftWindow[i] = 1.0;
+#endif
+    }
+#endif
+}
+
+void AudioCapture::releaseFFT()
+{
+#ifdef HAS_FFTW3
+    if (m_fftPlan != NULL)
+        fftw_destroy_plan((fftw_plan)m_fftPlan);
+#endif
+    m_fftPlan = NULL;
+    m_fftPlanSize = 0;
+}
+
 double AudioCapture::fillBandsData(int number)
 {
-    // m_fftOutputBuffer contains the real and imaginary data of a spectrum
-    // representing all the frequencies from 0 to m_sampleRate Hz.
-    // I will just consider 0 to 5000Hz and will calculate average magnitude
+    // m_fftMagnitude contains the magnitude of the spectrum from 0 to
+    // SPECTRUM_MAX_FREQUENCY Hz. Calculate the average magnitude
     // for the number of desired bands.
     double maxMagnitude = 0;
 #ifdef HAS_FFTW3
-    unsigned int i = 0;
+    const double *magnitude = m_fftMagnitude.constData();
+    int binsCount = m_fftMagnitude.size();
     int subBandWidth = ((m_captureSize * SPECTRUM_MAX_FREQUENCY) / m_sampleRate) / number;
+    int i = 0;
+
+    if (subBandWidth == 0)
+        return 0;
 
     for (int b = 0; b < number; b++)
     {
-        quint64 magnitudeSum = 0;
-        for (int s = 0; s < subBandWidth; s++, i++)
-        {
-            if (i == m_captureSize)
-                break;
-            magnitudeSum += qSqrt((((fftw_complex*)m_fftOutputBuffer)[i][0] * ((fftw_complex*)m_fftOutputBuffer)[i][0]) +
-                                  (((fftw_complex*)m_fftOutputBuffer)[i][1] * ((fftw_complex*)m_fftOutputBuffer)[i][1]));
-        }
+        int end = qMin(i + subBandWidth, binsCount);
+        double magnitudeSum = 0;
+        for (; i < end; i++)
+            magnitudeSum += magnitude[i];
+
         double bandMagnitude = (magnitudeSum / subBandWidth);
         m_fftMagnitudeMap[number].m_fftMagnitudeBuffer[b] = bandMagnitude;
         if (maxMagnitude < bandMagnitude)
@@ -183,12 +235,14 @@ void AudioCapture::processData()
     unsigned int i;
     quint64 pwrSum = 0;
 
-    // 1 ********* Initialize FFTW
-    fftw_plan plan_forward;
-    plan_forward = fftw_plan_dft_r2c_1d(m_captureSize, m_fftInputBuffer, (fftw_complex*)m_fftOutputBuffer , 0);
+    // 1 ********* Initialize FFTW, once per capture size
+    prepareFFT();
+    if (m_fftPlan == NULL)
+        return;
 
     // 2 ********* Apply a window to audio data
     // *********** and convert it to doubles
+    const double *window = m_fftWindow.constData();
 
     for (i = 0; i < m_captureSize; i++)
     {
@@ -197,24 +251,11 @@ void AudioCapture::processData()
         else
             pwrSum += m_audioBuffer[i];
 
-#ifdef USE_BLACKMAN
-        double a0 = (1-0.16)/2;
-        double a1 = 0.5;
-        double a2 = 0.16/2;
-        m_fftInputBuffer[i] = m_audioBuffer[i]  * (a0 - a1 * qCos((M_2PI * i) / (m_captureSize - 1)) +
-                              a2 * qCos((2 * M_2PI * i) / (m_captureSize - 1)));
-#endif
-#ifdef USE_HANNING
-        m_fftInputBuffer[i] = m_audioBuffer[i] * (0.5 * (1.00 - qCos((M_2PI * i) / (m_captureSize - 1))));
-#endif
-#ifdef USE_NO_WINDOW
-        m_fftInputBuffer[i] = (double)m_audioBuffer[i];
-#endif
+        m_fftInputBuffer[i] = m_audioBuffer[i] * window[i];
     }
 
     // 3 ********* Perform FFT
-    fftw_execute(plan_forward);
-    fftw_destroy_plan(plan_forward);
+    fftw_execute((fftw_plan)m_fftPlan);
 
     // 4 ********* Clear FFT noise
 #ifdef CLEAR_FFT_NOISE
@@ -229,7 +270,18 @@ void AudioCapture::processData()
     // 5 ********* Calculate the average signal power
     m_signalPower = pwrSum / m_captureSize;
 
-    // 6 ********* Calculate vector magnitude
+    // 6 ********* Calculate the magnitude spectrum, once for all the bands.
+    // *********** A real FFT output holds m_captureSize / 2 + 1 valid bins
+    unsigned int binsCount = qMin((m_captureSize * SPECTRUM_MAX_FREQUENCY) / m_sampleRate,
+                                  m_captureSize / 2 + 1);
+    m_fftMagnitude.resize(binsCount);
+
+    const fftw_complex *spectrum = (const fftw_complex*)m_fftOutputBuffer;
+    double *magnitude = m_fftMagnitude.data();
+    for (i = 0; i < binsCount; i++)
+        magnitude[i] = qSqrt(spectrum[i][0] * spectrum[i][0] + spectrum[i][1] * spectrum[i][1]);
+
+    // 7 ********* Aggregate the magnitudes for each registered bands number
     foreach(int barsNumber, m_fftMagnitudeMap.keys())
     {
         double maxMagnitude = fillBandsData(barsNumber);
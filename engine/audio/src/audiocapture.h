@@ -120,7 +120,15 @@ protected:
     void stop();
 
 private:
-    /** This is called at every processData to fill a single BandsData structure */
+    /** Create the FFT plan and the window coefficients for the current
+     *  capture size. Nothing is done if they are already up to date */
+    void prepareFFT();
+
+    /** Release the FFT plan created by prepareFFT */
+    void releaseFFT();
+
+    /** This is called at every processData to fill a single BandsData structure
+     *  out of the magnitude spectrum, which is shared by all the bands layouts */
     double fillBandsData(int number);
 
     /** This is the method where captured audio data is processed in this order
@@ -156,6 +164,15 @@ protected:
     double *m_fftInputBuffer;
     void *m_fftOutputBuffer;
 
+    /** The FFTW plan, reused as long as the capture size doesn't change */
+    void *m_fftPlan;
+    /** The capture size m_fftPlan and m_fftWindow have been prepared for */
+    unsigned int m_fftPlanSize;
+    /** The window coefficients applied to the audio samples */
+    QVector<double> m_fftWindow;
+    /** The magnitude of the spectrum bins up to SPECTRUM_MAX_FREQUENCY */
+    QVector<double> m_fftMagnitude;
+
     /** Map of the registered clients (key is the number of bands) */
     QMap <int, BandsData> m_fftMagnitudeMap;
 };
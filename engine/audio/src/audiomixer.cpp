@@ -0,0 +1,875 @@
+/*
+  Q Light Controller Plus
+  audiomixer.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QCoreApplication>
+#include <QVarLengthArray>
+#include <QWaitCondition>
+#include <QMutexLocker>
+#include <QThread>
+#include <QDebug>
+#include <climits>
+#include <cstring>
+
+#include "audiodecoder.h"
+#include "audiomixer.h"
+#include "mastertimer.h"
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+ #if defined(__APPLE__) || defined(Q_OS_MAC)
+   #include "audiorenderer_portaudio.h"
+ #elif defined(WIN32) || defined(Q_OS_WIN)
+   #include "audiorenderer_waveout.h"
+ #else
+   #include "audiorenderer_alsa.h"
+ #endif
+#else
+ #include "audiorenderer_qt.h"
+#endif
+
+/** Maximum number of source frames decoded in a single read */
+#define DECODE_FRAMES   4096
+
+/** Interval between two feeder runs while voices are playing, in milliseconds */
+#define FEED_INTERVAL   10
+
+#define VOICE_MASK      (AUDIOMIXER_VOICE_FRAMES - 1)
+#define QUEUE_MASK      (AUDIOMIXER_QUEUE_SIZE - 1)
+
+/*****************************************************************************
+ * Private classes
+ *****************************************************************************/
+
+struct AudioMixer::Voice
+{
+    quint32 id;
+
+    /** Next voice in the pending chain */
+    Voice *next;
+
+    /** The decoder and its output format */
+    AudioDecoder *decoder;
+    quint32 sourceRate;
+    int sourceChannels;
+    int sourceSampleSize;
+    bool looped;
+
+    /** Held while the decoder is in use */
+    QMutex decoderMutex;
+
+    /** Set by removeVoice(). The decoder must not be used anymore */
+    QAtomicInt removed;
+    /** Set by the feeder when the decoder has no more data */
+    QAtomicInt ended;
+    /** Set by the mixer when the voice is not referenced anymore */
+    QAtomicInt released;
+
+    /** Feeder state */
+    bool queued;
+    QByteArray decodeBuffer;
+    double resamplePosition;
+    qint16 lastFrame[AUDIOMIXER_CHANNELS];
+
+    /** Single producer (feeder), single consumer (mixer) ring buffer
+     *  of frames in the mixer format */
+    QVector<qint16> frames;
+    QAtomicInteger<quint32> writePos;
+    QAtomicInteger<quint32> readPos;
+
+    /** Mixer state */
+    quint32 startFrame;
+    bool started;
+    float gain;
+    float targetGain;
+    float gainStep;
+    quint32 rampFrames;
+    bool paused;
+};
+
+/**
+ * The decoder handed to the renderer: instead of decoding a file,
+ * it pulls mixed frames from the mixer. It never reaches the end
+ * of the stream, so the renderer keeps running until stopped.
+ */
+class AudioMixer::Source : public AudioDecoder
+{
+public:
+    Source(AudioMixer *mixer)
+        : m_mixer(mixer)
+    {
+        configure(AUDIOMIXER_SAMPLE_RATE, AUDIOMIXER_CHANNELS, PCM_S16LE);
+    }
+
+    AudioDecoder *createCopy() { return NULL; }
+    int priority() const { return 0; }
+    QStringList supportedFormats() { return QStringList(); }
+    bool initialize(const QString &) { return true; }
+    qint64 totalTime() { return 0; }
+    void seek(qint64) { }
+    int bitrate() { return AUDIOMIXER_SAMPLE_RATE * AUDIOMIXER_CHANNELS * 16 / 1000; }
+
+    qint64 read(char *data, qint64 maxSize)
+    {
+        int frames = int(maxSize / (AUDIOMIXER_CHANNELS * sizeof(qint16)));
+        m_mixer->mix((qint16 *)data, frames);
+        return frames * AUDIOMIXER_CHANNELS * sizeof(qint16);
+    }
+
+private:
+    AudioMixer *m_mixer;
+};
+
+class AudioMixer::Feeder : public QThread
+{
+public:
+    Feeder(AudioMixer *mixer)
+        : m_mixer(mixer)
+        , m_running(false)
+        , m_wakeRequested(false)
+    {
+    }
+
+    void start()
+    {
+        m_running = true;
+        QThread::start(QThread::HighPriority);
+    }
+
+    void stop()
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_running = false;
+            m_condition.wakeOne();
+        }
+        wait();
+    }
+
+    /** Have the feeder run as soon as possible */
+    void wake()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_wakeRequested = true;
+        m_condition.wakeOne();
+    }
+
+protected:
+    void run()
+    {
+        QMutexLocker locker(&m_mutex);
+
+        while (m_running)
+        {
+            m_wakeRequested = false;
+            locker.unlock();
+
+            bool playing = m_mixer->feedVoices();
+            if (playing)
+                m_mixer->startRendering();
+
+            locker.relock();
+
+            /* Keep the playing voices fed. Without voices, sleep
+             * until addVoice() wakes the thread up */
+            if (m_running && m_wakeRequested == false)
+                m_condition.wait(&m_mutex, playing ? FEED_INTERVAL : ULONG_MAX);
+        }
+    }
+
+private:
+    AudioMixer *m_mixer;
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    bool m_running;
+    bool m_wakeRequested;
+};
+
+/*****************************************************************************
+ * Initialization
+ *****************************************************************************/
+
+AudioMixer::AudioMixer(const QString &device, QObject *parent)
+    : QObject(parent)
+    , m_device(device)
+    , m_pendingVoices(NULL)
+    , m_lastVoiceId(invalidVoice())
+    , m_scheduleValid(false)
+    , m_scheduleTick(0)
+    , m_scheduleFrame(0)
+    , m_queueHead(0)
+    , m_queueTail(0)
+    , m_frame(0)
+    , m_framesMixed(0)
+    , m_source(new AudioMixer::Source(this))
+    , m_renderer(NULL)
+    , m_feeder(new AudioMixer::Feeder(this))
+{
+    for (quint32 i = 0; i < AUDIOMIXER_QUEUE_SIZE; i++)
+        m_queue[i].sequence.store(i);
+
+    m_mixing.reserve(32);
+
+    /* Voices are released by the feeder thread. Let the owner of the
+     * mixer know about it from the thread the mixer lives in */
+    connect(this, SIGNAL(voiceReleased(quint32,bool)),
+            this, SLOT(slotVoiceReleased(quint32,bool)), Qt::QueuedConnection);
+
+    m_feeder->start();
+}
+
+AudioMixer::~AudioMixer()
+{
+    /* Stop the feeder first, so that it can't restart the renderer */
+    stopFeeder();
+    delete m_feeder;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        stopRendering();
+    }
+
+    qDeleteAll(m_voices);
+    m_voices.clear();
+
+    Voice *voice = m_pendingVoices.fetchAndStoreAcquire(NULL);
+    while (voice != NULL)
+    {
+        Voice *next = voice->next;
+        delete voice;
+        voice = next;
+    }
+
+    delete m_source;
+}
+
+QString AudioMixer::device() const
+{
+    return m_device;
+}
+
+/*****************************************************************************
+ * Voices
+ *****************************************************************************/
+
+quint32 AudioMixer::invalidVoice()
+{
+    return 0;
+}
+
+quint32 AudioMixer::addVoice(AudioDecoder *decoder, quint32 startFrame,
+                             qreal gain, uint fadeIn, bool looped)
+{
+    if (decoder == NULL)
+        return invalidVoice();
+
+    AudioParameters ap = decoder->audioParameters();
+    if (ap.sampleRate() == 0)
+    {
+        qWarning() << Q_FUNC_INFO << "Invalid decoder sample rate";
+        return invalidVoice();
+    }
+
+    Voice *voice = new Voice;
+    voice->next = NULL;
+    voice->decoder = decoder;
+    voice->sourceRate = ap.sampleRate();
+    voice->sourceChannels = qMax(1, ap.channels());
+    /* Decoders output at most 16 bit samples, whatever the file format is */
+    voice->sourceSampleSize = ap.sampleSize() == 1 ? 1 : 2;
+    voice->looped = looped;
+    voice->queued = false;
+    voice->resamplePosition = 0;
+    for (int c = 0; c < AUDIOMIXER_CHANNELS; c++)
+        voice->lastFrame[c] = 0;
+    voice->writePos.store(0);
+    voice->readPos.store(0);
+    voice->startFrame = startFrame;
+    voice->started = false;
+    voice->targetGain = qBound(0.0, gain, 1.0);
+    voice->gain = fadeIn ? 0.0 : voice->targetGain;
+    voice->rampFrames = quint32(quint64(fadeIn) * AUDIOMIXER_SAMPLE_RATE / 1000);
+    voice->gainStep = voice->rampFrames ? voice->targetGain / voice->rampFrames : 0;
+    voice->paused = false;
+
+    do
+    {
+        voice->id = m_lastVoiceId.fetchAndAddRelaxed(1) + 1;
+    } while (voice->id == invalidVoice());
+
+    /* The feeder allocates the voice buffers and prebuffers the voice
+     * before handing it to the mixer, so that the caller never waits */
+    Voice *head;
+    do
+    {
+        head = m_pendingVoices.loadAcquire();
+        voice->next = head;
+    } while (m_pendingVoices.testAndSetRelease(head, voice) == false);
+
+    m_feeder->wake();
+
+    return voice->id;
+}
+
+void AudioMixer::removeVoice(quint32 voice)
+{
+    QMutexLocker locker(&m_mutex);
+
+    Voice *v = m_voices.value(voice, NULL);
+    if (v == NULL)
+    {
+        /* The feeder takes in the pending voices with m_mutex
+         * held, so the chain can't change under our feet */
+        for (Voice *p = m_pendingVoices.loadAcquire(); p != NULL; p = p->next)
+        {
+            if (p->id == voice)
+            {
+                v = p;
+                break;
+            }
+        }
+    }
+
+    if (v == NULL)
+        return;
+
+    /* The mixer drops the voice as soon as it sees the flag. Wait for the
+     * feeder to leave the decoder, if it is using it right now */
+    v->removed.storeRelease(1);
+    QMutexLocker decoderLocker(&v->decoderMutex);
+}
+
+void AudioMixer::setVoiceGain(quint32 voice, qreal gain, uint fadeTime)
+{
+    Command command;
+    command.type = SetGain;
+    command.voiceId = voice;
+    command.voice = NULL;
+    command.value = qBound(0.0, gain, 1.0);
+    command.frames = quint32(quint64(fadeTime) * AUDIOMIXER_SAMPLE_RATE / 1000);
+
+    if (postCommand(command) == false)
+        qWarning() << Q_FUNC_INFO << "Command queue full. Gain change lost";
+}
+
+void AudioMixer::setVoicePaused(quint32 voice, bool paused)
+{
+    Command command;
+    command.type = SetPaused;
+    command.voiceId = voice;
+    command.voice = NULL;
+    command.value = paused ? 1 : 0;
+    command.frames = 0;
+
+    if (postCommand(command) == false)
+        qWarning() << Q_FUNC_INFO << "Command queue full. Pause change lost";
+}
+
+quint32 AudioMixer::startFrame(quint32 tick)
+{
+    QMutexLocker locker(&m_scheduleMutex);
+
+    quint32 framesPerTick = AUDIOMIXER_SAMPLE_RATE / MasterTimer::frequency();
+    quint32 earliest = framesMixed() + AUDIOMIXER_START_LATENCY;
+    quint32 frame = m_scheduleFrame + (tick - m_scheduleTick) * framesPerTick;
+    qint32 ahead = qint32(frame - earliest);
+
+    /* Re-anchor the ticks on the mixer clock when the mixer has gone past
+     * the scheduled frame, or when it has been idle for a while */
+    if (m_scheduleValid == false || ahead < 0 || ahead > 4 * AUDIOMIXER_START_LATENCY)
+    {
+        m_scheduleValid = true;
+        m_scheduleTick = tick;
+        m_scheduleFrame = earliest;
+        frame = earliest;
+    }
+
+    return frame;
+}
+
+quint32 AudioMixer::framesMixed() const
+{
+    return m_framesMixed.loadAcquire();
+}
+
+void AudioMixer::slotVoiceReleased(quint32 voice, bool finished)
+{
+    if (finished)
+        emit voiceFinished(voice);
+
+    QMutexLocker locker(&m_mutex);
+    if (m_voices.isEmpty())
+        stopRendering();
+}
+
+void AudioMixer::prepare(Voice *voice)
+{
+    voice->decodeBuffer.resize(DECODE_FRAMES * voice->sourceChannels * voice->sourceSampleSize);
+    voice->frames.resize(AUDIOMIXER_VOICE_FRAMES * AUDIOMIXER_CHANNELS);
+}
+
+void AudioMixer::feed(Voice *voice, quint32 frames)
+{
+    QMutexLocker locker(&voice->decoderMutex);
+
+    double step = double(voice->sourceRate) / AUDIOMIXER_SAMPLE_RATE;
+    int frameSize = voice->sourceChannels * voice->sourceSampleSize;
+    bool rewound = false;
+
+    while (voice->removed.loadAcquire() == 0 && voice->ended.load() == 0)
+    {
+        quint32 buffered = voice->writePos.load() - voice->readPos.loadAcquire();
+        if (buffered >= frames)
+            break;
+
+        /* Read no more than what fits in the buffer once resampled */
+        quint32 space = AUDIOMIXER_VOICE_FRAMES - buffered;
+        quint32 inFrames = space > 4 ? quint32((space - 4) * step) : 0;
+        inFrames = qMin(inFrames, quint32(DECODE_FRAMES));
+        if (inFrames == 0)
+            break;
+
+        qint64 read = voice->decoder->read(voice->decodeBuffer.data(), inFrames * frameSize);
+        if (read < frameSize)
+        {
+            /* Rewind looped voices, unless the decoder is empty */
+            if (voice->looped && rewound == false)
+            {
+                voice->decoder->seek(0);
+                rewound = true;
+                continue;
+            }
+            voice->ended.storeRelease(1);
+            break;
+        }
+        rewound = false;
+
+        quint32 written = convert(voice, voice->decodeBuffer.constData(), quint32(read / frameSize));
+        voice->writePos.storeRelease(voice->writePos.load() + written);
+    }
+}
+
+quint32 AudioMixer::convert(Voice *voice, const char *data, quint32 inFrames)
+{
+    int channels = voice->sourceChannels;
+    qint16 *out = voice->frames.data();
+    quint32 pos = voice->writePos.load();
+    quint32 written = 0;
+
+    /* Widen the samples and map them to the mixer channels. Mono voices
+     * are played on both sides, extra channels are dropped */
+    QVarLengthArray<qint16, DECODE_FRAMES * AUDIOMIXER_CHANNELS> in(inFrames * AUDIOMIXER_CHANNELS);
+    if (voice->sourceSampleSize == 1)
+    {
+        const qint8 *src = (const qint8 *)data;
+        for (quint32 i = 0; i < inFrames; i++)
+        {
+            in[i * 2] = qint16(src[i * channels] << 8);
+            in[i * 2 + 1] = qint16(src[i * channels + (channels > 1 ? 1 : 0)] << 8);
+        }
+    }
+    else
+    {
+        const qint16 *src = (const qint16 *)data;
+        for (quint32 i = 0; i < inFrames; i++)
+        {
+            in[i * 2] = src[i * channels];
+            in[i * 2 + 1] = src[i * channels + (channels > 1 ? 1 : 0)];
+        }
+    }
+
+    if (voice->sourceRate == AUDIOMIXER_SAMPLE_RATE)
+    {
+        for (quint32 i = 0; i < inFrames; i++, written++)
+        {
+            quint32 idx = ((pos + written) & VOICE_MASK) * AUDIOMIXER_CHANNELS;
+            out[idx] = in[i * 2];
+            out[idx + 1] = in[i * 2 + 1];
+        }
+    }
+    else
+    {
+        /* Linear interpolation. Source frame -1 is the last frame of the
+         * previous chunk, so that the chunks join seamlessly */
+        double step = double(voice->sourceRate) / AUDIOMIXER_SAMPLE_RATE;
+        double position = voice->resamplePosition;
+
+        for (;;)
+        {
+            qint32 i = qint32(position);
+            if (position < 0)
+                i = -1;
+            if (i + 1 >= qint32(inFrames))
+                break;
+
+            float frac = float(position - i);
+            quint32 idx = ((pos + written) & VOICE_MASK) * AUDIOMIXER_CHANNELS;
+            for (int c = 0; c < AUDIOMIXER_CHANNELS; c++)
+            {
+                float a = i < 0 ? voice->lastFrame[c] : in[i * 2 + c];
+                float b = in[(i + 1) * 2 + c];
+                out[idx + c] = qint16(a + (b - a) * frac);
+            }
+            written++;
+            position += step;
+        }
+
+        voice->resamplePosition = position - inFrames;
+        if (inFrames > 0)
+        {
+            voice->lastFrame[0] = in[(inFrames - 1) * 2];
+            voice->lastFrame[1] = in[(inFrames - 1) * 2 + 1];
+        }
+    }
+
+    return written;
+}
+
+/*****************************************************************************
+ * Commands
+ *****************************************************************************/
+
+bool AudioMixer::postCommand(const Command &command)
+{
+    /* Bounded multi-producer, single-consumer queue: each cell sequence
+     * tells whether the cell is free for the producer claiming position
+     * pos (sequence == pos) or filled for the consumer (sequence == pos + 1) */
+    quint32 pos = m_queueHead.load();
+
+    for (;;)
+    {
+        CommandCell &cell = m_queue[pos & QUEUE_MASK];
+        qint32 diff = qint32(cell.sequence.loadAcquire() - pos);
+
+        if (diff == 0)
+        {
+            if (m_queueHead.testAndSetRelaxed(pos, pos + 1))
+            {
+                cell.command = command;
+                cell.sequence.storeRelease(pos + 1);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false;
+        }
+
+        pos = m_queueHead.load();
+    }
+}
+
+void AudioMixer::processCommands()
+{
+    for (;;)
+    {
+        CommandCell &cell = m_queue[m_queueTail & QUEUE_MASK];
+        if (qint32(cell.sequence.loadAcquire() - (m_queueTail + 1)) < 0)
+            break;
+
+        Command command = cell.command;
+        cell.sequence.storeRelease(m_queueTail + AUDIOMIXER_QUEUE_SIZE);
+        m_queueTail++;
+
+        if (command.type == AddVoice)
+        {
+            m_mixing.append(command.voice);
+            continue;
+        }
+
+        Voice *voice = NULL;
+        foreach (Voice *v, m_mixing)
+        {
+            if (v->id == command.voiceId)
+            {
+                voice = v;
+                break;
+            }
+        }
+
+        if (voice == NULL)
+            continue;
+
+        switch (command.type)
+        {
+            case SetGain:
+                /* Don't restart a ramp which is already heading there */
+                if (voice->targetGain == command.value &&
+                    (voice->rampFrames > 0 || voice->gain == command.value))
+                    break;
+
+                voice->targetGain = command.value;
+                voice->rampFrames = command.frames;
+                if (command.frames == 0)
+                    voice->gain = command.value;
+                else
+                    voice->gainStep = (command.value - voice->gain) / command.frames;
+            break;
+            case SetPaused:
+                voice->paused = command.value != 0;
+            break;
+            default:
+            break;
+        }
+    }
+}
+
+/*****************************************************************************
+ * Mixing
+ *****************************************************************************/
+
+void AudioMixer::mix(qint16 *data, int frames)
+{
+    processCommands();
+
+    int samples = frames * AUDIOMIXER_CHANNELS;
+    if (m_mixBuffer.size() < samples)
+        m_mixBuffer.resize(samples);
+
+    float *acc = m_mixBuffer.data();
+    std::memset(acc, 0, samples * sizeof(float));
+
+    for (int v = 0; v < m_mixing.count(); )
+    {
+        Voice *voice = m_mixing.at(v);
+        if (voice->removed.loadAcquire() || mixVoice(voice, frames) == false)
+        {
+            m_mixing.remove(v);
+            voice->released.storeRelease(1);
+            continue;
+        }
+        v++;
+    }
+
+    for (int i = 0; i < samples; i++)
+        data[i] = qint16(qBound(-32768.0f, acc[i], 32767.0f));
+
+    m_frame += frames;
+    m_framesMixed.storeRelease(m_frame);
+}
+
+bool AudioMixer::mixVoice(Voice *voice, int frames)
+{
+    qint32 delay = qint32(voice->startFrame - m_frame);
+
+    if (voice->paused)
+    {
+        /* A voice resumed after its start frame plays from where it is */
+        if (delay <= 0)
+            voice->started = true;
+        return true;
+    }
+
+    if (voice->started == false && delay >= frames)
+        return true;
+
+    /* Read the end flag before the write position: if the feeder
+     * has ended, all the frames it wrote are visible */
+    bool ended = voice->ended.loadAcquire();
+    quint32 readPos = voice->readPos.load();
+    quint32 available = voice->writePos.loadAcquire() - readPos;
+
+    /* Start exactly at the voice start frame. A voice prebuffered late
+     * drops the frames it should have played, to stay on time */
+    int offset = 0;
+    if (voice->started == false)
+    {
+        if (delay > 0)
+        {
+            offset = delay;
+        }
+        else if (delay < 0)
+        {
+            quint32 late = qMin(quint32(-delay), available);
+            readPos += late;
+            available -= late;
+        }
+        voice->started = true;
+    }
+
+    quint32 count = qMin(quint32(frames - offset), available);
+
+    const qint16 *in = voice->frames.constData();
+    float *out = m_mixBuffer.data() + offset * AUDIOMIXER_CHANNELS;
+    quint32 done = 0;
+
+    while (done < count)
+    {
+        /* Process contiguous chunks, split at the buffer wrap and at
+         * the end of the gain ramp, so that the inner loops are trivial */
+        quint32 idx = (readPos + done) & VOICE_MASK;
+        quint32 chunk = qMin(count - done, quint32(AUDIOMIXER_VOICE_FRAMES) - idx);
+        if (voice->rampFrames > 0)
+            chunk = qMin(chunk, voice->rampFrames);
+
+        const qint16 *src = in + idx * AUDIOMIXER_CHANNELS;
+        float *dst = out + done * AUDIOMIXER_CHANNELS;
+        int samples = chunk * AUDIOMIXER_CHANNELS;
+
+        if (voice->rampFrames > 0)
+        {
+            float gain = voice->gain;
+            float step = voice->gainStep;
+            for (quint32 i = 0; i < chunk; i++)
+            {
+                float g = gain + step * i;
+                dst[i * 2] += src[i * 2] * g;
+                dst[i * 2 + 1] += src[i * 2 + 1] * g;
+            }
+            voice->rampFrames -= chunk;
+            voice->gain = voice->rampFrames ? gain + step * chunk : voice->targetGain;
+        }
+        else
+        {
+            float gain = voice->gain;
+            for (int i = 0; i < samples; i++)
+                dst[i] += src[i] * gain;
+        }
+
+        done += chunk;
+    }
+
+    voice->readPos.storeRelease(readPos + count);
+
+    /* An underrun of a voice which is still being decoded just
+     * produces silence. Once ended, the voice is over when drained */
+    if (ended && count == available)
+        return false;
+
+    return true;
+}
+
+/*****************************************************************************
+ * Threads
+ *****************************************************************************/
+
+void AudioMixer::startRendering()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_renderer != NULL)
+        return;
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+ #if defined(__APPLE__) || defined(Q_OS_MAC)
+    m_renderer = new AudioRendererPortAudio(m_device);
+ #elif defined(WIN32) || defined(Q_OS_WIN)
+    m_renderer = new AudioRendererWaveOut(m_device);
+ #else
+    m_renderer = new AudioRendererAlsa(m_device);
+ #endif
+    m_renderer->moveToThread(QCoreApplication::instance()->thread());
+#else
+    m_renderer = new AudioRendererQt(m_device);
+#endif
+    m_renderer->setDecoder(m_source);
+    m_renderer->initialize(AUDIOMIXER_SAMPLE_RATE, AUDIOMIXER_CHANNELS, PCM_S16LE);
+    m_renderer->start();
+}
+
+void AudioMixer::stopRendering()
+{
+    if (m_renderer == NULL)
+        return;
+
+    m_renderer->stop();
+    delete m_renderer;
+    m_renderer = NULL;
+}
+
+void AudioMixer::stopFeeder()
+{
+    if (m_feeder->isRunning())
+        m_feeder->stop();
+}
+
+bool AudioMixer::feedVoices()
+{
+    QList<Voice *> voices;
+    QList<Voice *> released;
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        Voice *pending = m_pendingVoices.fetchAndStoreAcquire(NULL);
+        while (pending != NULL)
+        {
+            m_voices[pending->id] = pending;
+            pending = pending->next;
+        }
+
+        QMutableHashIterator<quint32, Voice *> it(m_voices);
+        while (it.hasNext())
+        {
+            it.next();
+            if (it.value()->released.loadAcquire())
+            {
+                released.append(it.value());
+                it.remove();
+            }
+            else
+            {
+                voices.append(it.value());
+            }
+        }
+    }
+
+    /* Only this thread deletes voices, so the ones still
+     * in the list can be fed without holding m_mutex */
+    foreach (Voice *voice, voices)
+    {
+        if (voice->queued)
+        {
+            feed(voice, AUDIOMIXER_FEED_FRAMES);
+            continue;
+        }
+
+        /* Have the beginning of a new voice ready before the mixer gets
+         * it, so that it starts at its start frame regardless of the
+         * decoder speed */
+        if (voice->frames.isEmpty())
+            prepare(voice);
+        feed(voice, AUDIOMIXER_PREBUFFER_FRAMES);
+
+        /* Removed before being played: drop it at the next run */
+        if (voice->removed.loadAcquire())
+        {
+            voice->released.storeRelease(1);
+            continue;
+        }
+
+        Command command;
+        command.type = AddVoice;
+        command.voiceId = voice->id;
+        command.voice = voice;
+        command.value = 0;
+        command.frames = 0;
+
+        if (postCommand(command))
+            voice->queued = true;
+        else
+            qWarning() << Q_FUNC_INFO << "Command queue full. Voice" << voice->id << "delayed";
+    }
+
+    foreach (Voice *voice, released)
+    {
+        emit voiceReleased(voice->id, voice->removed.load() == 0);
+        delete voice;
+    }
+
+    return voices.isEmpty() == false;
+}
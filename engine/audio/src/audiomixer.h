@@ -0,0 +1,272 @@
+/*
+  Q Light Controller Plus
+  audiomixer.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef AUDIOMIXER_H
+#define AUDIOMIXER_H
+
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+#include <QObject>
+#include <QVector>
+#include <QMutex>
+#include <QHash>
+
+class AudioRenderer;
+class AudioDecoder;
+
+/** @addtogroup engine_audio Audio
+ * @{
+ */
+
+/** Output format of the mixer. Voices are converted to it when decoded */
+#define AUDIOMIXER_SAMPLE_RATE      44100
+#define AUDIOMIXER_CHANNELS         2
+
+/** Number of frames held by the buffer of each voice. Must be a power of 2 */
+#define AUDIOMIXER_VOICE_FRAMES     65536
+
+/** Number of frames the feeder keeps decoded ahead of the mixer */
+#define AUDIOMIXER_FEED_FRAMES      32768
+
+/** Number of frames the feeder decodes before handing a new voice to the mixer */
+#define AUDIOMIXER_PREBUFFER_FRAMES 8192
+
+/** Minimum distance in frames between the mixing position and the start
+ *  of a new voice. This is one renderer read (8192 bytes) */
+#define AUDIOMIXER_START_LATENCY    2048
+
+/** Number of commands the queue can hold. Must be a power of 2 */
+#define AUDIOMIXER_QUEUE_SIZE       256
+
+/**
+ * AudioMixer plays any number of AudioDecoder sources ("voices") on a single
+ * audio device, so that concurrent Audio functions share one output stream.
+ *
+ * Three threads are involved:
+ * - the control threads (MasterTimer, UI) add/remove voices and change their
+ *   gain. Changes are posted on lock-free queues and never block the mixer
+ * - a feeder thread prebuffers the new voices, then decodes each voice
+ *   ahead of time into a ring buffer, converting it to the mixer format
+ * - the renderer thread pulls mixed frames through mix(), applying per-sample
+ *   gain ramps and starting each voice at its exact start frame
+ */
+class AudioMixer : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(AudioMixer)
+
+    /*********************************************************************
+     * Initialization
+     *********************************************************************/
+public:
+    AudioMixer(const QString& device, QObject *parent = 0);
+    ~AudioMixer();
+
+    /** Get the name of the audio device used by this mixer */
+    QString device() const;
+
+private:
+    QString m_device;
+
+    /*********************************************************************
+     * Voices
+     *********************************************************************/
+public:
+    /** An invalid voice ID */
+    static quint32 invalidVoice();
+
+    /**
+     * Start playing $decoder from its current position. The decoder is
+     * used by the mixer until removeVoice() returns or voiceFinished()
+     * is emitted, so it must not be accessed in the meantime.
+     *
+     * This doesn't decode nor lock anything: the voice is queued for the
+     * feeder thread, which prebuffers it and hands it to the mixer. The
+     * voice still plays from $startFrame, dropping the frames which
+     * should have been played already if it was ready late.
+     *
+     * @param decoder The decoder to play
+     * @param startFrame Mixer frame at which the voice starts (see startFrame())
+     * @param gain The voice gain in the range 0.0 - 1.0
+     * @param fadeIn Fade in time in milliseconds
+     * @param looped If true, the decoder is rewound when it reaches its end
+     * @return A new voice ID
+     */
+    quint32 addVoice(AudioDecoder *decoder, quint32 startFrame,
+                     qreal gain, uint fadeIn, bool looped);
+
+    /** Stop a voice immediately. When this returns, the voice decoder
+     *  is not used anymore by the mixer */
+    void removeVoice(quint32 voice);
+
+    /** Ramp the gain of a voice to $gain in $fadeTime milliseconds */
+    void setVoiceGain(quint32 voice, qreal gain, uint fadeTime);
+
+    /** Pause/resume a voice */
+    void setVoicePaused(quint32 voice, bool paused);
+
+    /**
+     * Get the mixer frame at which voices added during the MasterTimer tick
+     * number $tick should start. Voices added during the same tick share the
+     * same start frame, and consecutive ticks are exactly one tick apart,
+     * regardless of when the control thread got to add them.
+     */
+    quint32 startFrame(quint32 tick);
+
+    /** Get the number of frames mixed so far */
+    quint32 framesMixed() const;
+
+signals:
+    /** Emitted when a voice has reached the end of its decoder */
+    void voiceFinished(quint32 voice);
+
+    /** @internal Emitted by the feeder thread when a voice has been dropped */
+    void voiceReleased(quint32 voice, bool finished);
+
+private slots:
+    void slotVoiceReleased(quint32 voice, bool finished);
+
+private:
+    struct Voice;
+
+    /** Allocate the buffers of a new $voice. Called by the feeder thread */
+    void prepare(Voice *voice);
+
+    /** Decode up to $frames frames of $voice into its buffer */
+    void feed(Voice *voice, quint32 frames);
+
+    /** Convert $inFrames decoded frames of $voice to the mixer format */
+    quint32 convert(Voice *voice, const char *data, quint32 inFrames);
+
+private:
+    /** Protects m_voices, the removal of pending voices
+     *  and the renderer lifecycle */
+    QMutex m_mutex;
+
+    /** The voices taken in by the feeder, by ID */
+    QHash<quint32, Voice *> m_voices;
+
+    /** The voices added and not taken in by the feeder yet, chained by
+     *  Voice::next in reverse order. Pushed lock-free by addVoice() */
+    QAtomicPointer<Voice> m_pendingVoices;
+
+    /** The last voice ID assigned */
+    QAtomicInteger<quint32> m_lastVoiceId;
+
+    /** Start frame scheduling state */
+    QMutex m_scheduleMutex;
+    bool m_scheduleValid;
+    quint32 m_scheduleTick;
+    quint32 m_scheduleFrame;
+
+    /*********************************************************************
+     * Commands
+     *********************************************************************/
+private:
+    /** Voices are removed through their removed flag rather than with
+     *  a command, so that removal works even when the queue is full */
+    enum CommandType
+    {
+        AddVoice,
+        SetGain,
+        SetPaused
+    };
+
+    struct Command
+    {
+        CommandType type;
+        quint32 voiceId;
+        Voice *voice;
+        float value;
+        quint32 frames;
+    };
+
+    struct CommandCell
+    {
+        QAtomicInteger<quint32> sequence;
+        Command command;
+    };
+
+    /** Post a command to the mixing thread. This is lock-free and
+     *  safe to call from any number of threads */
+    bool postCommand(const Command& command);
+
+    /** Apply all the pending commands. Called by the mixing thread */
+    void processCommands();
+
+private:
+    CommandCell m_queue[AUDIOMIXER_QUEUE_SIZE];
+    QAtomicInteger<quint32> m_queueHead;
+    quint32 m_queueTail;
+
+    /*********************************************************************
+     * Mixing
+     *********************************************************************/
+public:
+    /** Mix $frames frames of all the playing voices into $data.
+     *  Called by the renderer thread */
+    void mix(qint16 *data, int frames);
+
+private:
+    /** Accumulate $voice into m_mixBuffer. Returns false when the voice
+     *  has played its last frame */
+    bool mixVoice(Voice *voice, int frames);
+
+private:
+    /** The voices being mixed. Accessed only by the mixing thread */
+    QVector<Voice *> m_mixing;
+
+    /** The mixing accumulator */
+    QVector<float> m_mixBuffer;
+
+    /** Number of frames mixed so far */
+    quint32 m_frame;
+    QAtomicInteger<quint32> m_framesMixed;
+
+    /*********************************************************************
+     * Threads
+     *********************************************************************/
+private:
+    class Source;
+    class Feeder;
+
+    /** Start the renderer, if not running yet. Called by the feeder
+     *  thread when it has voices to play */
+    void startRendering();
+
+    /** Stop the renderer. Called with m_mutex held */
+    void stopRendering();
+
+    /** Stop the feeder thread. Voices are not fed anymore */
+    void stopFeeder();
+
+    /** Take in the pending voices, feed all the voices and drop the
+     *  released ones. Returns true if some voices are left to play.
+     *  Called by the feeder thread */
+    bool feedVoices();
+
+private:
+    Source *m_source;
+    AudioRenderer *m_renderer;
+    Feeder *m_feeder;
+};
+
+/** @} */
+
+#endif
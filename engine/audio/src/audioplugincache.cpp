@@ -22,6 +22,7 @@
 
 #include "audioplugincache.h"
 #include "audiodecoder.h"
+#include "audiomixer.h"
 #include "qlcfile.h"
 
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
@@ -54,6 +55,8 @@ AudioPluginCache::AudioPluginCache(QObject *parent)
 
 AudioPluginCache::~AudioPluginCache()
 {
+    qDeleteAll(m_mixers);
+    m_mixers.clear();
 }
 
 void AudioPluginCache::load(const QDir &dir)
@@ -137,3 +140,20 @@ QList<AudioDeviceInfo> AudioPluginCache::audioDevicesList() const
 {
     return m_audioDevicesList;
 }
+
+AudioMixer *AudioPluginCache::mixer(const QString &device)
+{
+    QMutexLocker locker(&m_mixersMutex);
+
+    AudioMixer *mixer = m_mixers.value(device, NULL);
+    if (mixer == NULL)
+    {
+        mixer = new AudioMixer(device);
+        /* Functions start from the MasterTimer thread. Make sure the
+         * mixer signals are delivered by the main event loop */
+        mixer->moveToThread(thread());
+        m_mixers[device] = mixer;
+    }
+
+    return mixer;
+}
@@ -21,7 +21,9 @@
 #define AUDIOPLUGINCACHE_H
 
 #include <QObject>
+#include <QMutex>
 #include <QDir>
+#include <QMap>
 
 #include "audiorenderer.h"
 #include "audiocapture.h"
@@ -31,6 +33,7 @@
  */
 
 class AudioDecoder;
+class AudioMixer;
 
 class AudioPluginCache : public QObject
 {
@@ -54,10 +57,19 @@ public:
     /** Get the list of cached audio devices detected on creation */
     QList<AudioDeviceInfo> audioDevicesList() const;
 
+    /** Get the mixer playing audio on the given $device, creating it
+     *  if needed. An empty $device means the QLC+ global device.
+     *  This can be called from any thread. */
+    AudioMixer *mixer(const QString& device);
+
 private:
     /** a map of the vailable plugins ordered by priority */
     QMap<int, QString> m_pluginsMap;
     QList<AudioDeviceInfo> m_audioDevicesList;
+
+    /** The mixers created so far, by device name */
+    QMap<QString, AudioMixer *> m_mixers;
+    QMutex m_mixersMutex;
 };
 
 /** @} */
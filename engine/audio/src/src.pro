@@ -21,6 +21,7 @@ HEADERS += audio.h \
            audiorenderer.h \
            audioparameters.h \
            audiocapture.h \
+           audiomixer.h \
            audioplugincache.h
 
 lessThan(QT_MAJOR_VERSION, 5) {
@@ -36,6 +37,7 @@ SOURCES += audio.cpp \
            audiorenderer.cpp \
            audioparameters.cpp \
            audiocapture.cpp \
+           audiomixer.cpp \
            audioplugincache.cpp
 
 lessThan(QT_MAJOR_VERSION, 5) {
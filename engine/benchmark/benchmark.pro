@@ -0,0 +1,21 @@
+include(../../variables.pri)
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = engine_benchmark
+
+QT      += testlib
+qmlui {
+  QT += qml
+} else {
+  QT += script
+}
+CONFIG  -= app_bundle
+
+DEPENDPATH   += ../src
+INCLUDEPATH  += ../../plugins/interfaces
+INCLUDEPATH  += ../src
+QMAKE_LIBDIR += ../src
+LIBS         += -lqlcplusengine
+
+SOURCES += enginebenchmark.cpp
+HEADERS += enginebenchmark.h
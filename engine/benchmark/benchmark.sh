@@ -0,0 +1,5 @@
+#!/bin/sh
+# The I/O plugin stub is built together with the engine unit tests
+export LD_LIBRARY_PATH=../src
+export DYLD_FALLBACK_LIBRARY_PATH=../src
+./engine_benchmark "$@"
@@ -0,0 +1,400 @@
+/*
+  Q Light Controller Plus - Engine benchmark
+  enginebenchmark.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QtTest>
+#include <stdlib.h>
+
+#define private public
+#include "mastertimer.h"
+#undef private
+
+#include "enginebenchmark.h"
+#include "rgbscriptscache.h"
+#include "engineprofiler.h"
+#include "qlcfixturemode.h"
+#include "inputoutputmap.h"
+#include "ioplugincache.h"
+#include "qlcfixturedef.h"
+#include "fixturegroup.h"
+#include "efxfixture.h"
+#include "chaserstep.h"
+#include "rgbmatrix.h"
+#include "fixture.h"
+#include "qlcfile.h"
+#include "universe.h"
+#include "chaser.h"
+#include "scene.h"
+#include "efx.h"
+#include "doc.h"
+
+#define FIXTUREDIR "../../resources/fixtures/"
+#define SCRIPTDIR "../../resources/rgbscripts/"
+#define PLUGINDIR "../test/iopluginstub"
+
+/** The synthetic show layout. Every universe holds the same rig */
+#define BENCH_UNIVERSES       128
+#define BENCH_PARS            24  // RGB pars, arranged in a 6x4 matrix
+#define BENCH_MOVING_HEADS    8
+#define BENCH_DIMMER_PACKS    8
+#define BENCH_DIMMER_CHANNELS 24
+#define BENCH_CHASER_STEPS    4
+
+/** Ticks run before measuring, so fades settle and buffers are allocated */
+#define BENCH_WARMUP_TICKS    100
+/** Ticks run to produce the report */
+#define BENCH_REPORT_TICKS    500
+
+/*****************************************************************************
+ * Allocations counter
+ *****************************************************************************/
+
+static QAtomicInt s_allocations(0);
+
+#if defined(__GLIBC__)
+/* Interpose malloc, so Qt containers (that don't go through operator new)
+ * are counted too */
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t nmemb, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+extern "C" void *malloc(size_t size)
+{
+    s_allocations.ref();
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t nmemb, size_t size)
+{
+    s_allocations.ref();
+    return __libc_calloc(nmemb, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    s_allocations.ref();
+    return __libc_realloc(ptr, size);
+}
+#else
+void *operator new(size_t size)
+{
+    s_allocations.ref();
+    void *ptr = malloc(size);
+    if (ptr == NULL)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void *ptr) throw()
+{
+    free(ptr);
+}
+#endif
+
+/*****************************************************************************
+ * Show setup
+ *****************************************************************************/
+
+void EngineBenchmark::initTestCase()
+{
+    m_doc = new Doc(this, BENCH_UNIVERSES);
+
+    QDir fxiDir(FIXTUREDIR);
+    fxiDir.setFilter(QDir::Files);
+    fxiDir.setNameFilters(QStringList() << QString("*%1").arg(KExtFixture));
+    QVERIFY(m_doc->fixtureDefCache()->loadMap(fxiDir) == true);
+
+    QVERIFY(m_doc->rgbScriptsCache()->load(QDir(SCRIPTDIR)));
+
+    QDir pluginDir(PLUGINDIR);
+    pluginDir.setFilter(QDir::Files);
+    pluginDir.setNameFilters(QStringList() << QString("*%1").arg(KExtPlugin));
+    m_doc->ioPluginCache()->load(pluginDir);
+
+    QLCFixtureDef *parDef = m_doc->fixtureDefCache()->fixtureDef("Stairville", "LED PAR56");
+    QVERIFY(parDef != NULL);
+    QLCFixtureMode *parMode = parDef->modes().first();
+    QVERIFY(parMode != NULL);
+
+    QLCFixtureDef *headDef = m_doc->fixtureDefCache()->fixtureDef("Martin", "MAC250+");
+    QVERIFY(headDef != NULL);
+    QLCFixtureMode *headMode = headDef->mode("Mode 4");
+    QVERIFY(headMode != NULL);
+
+    for (quint32 u = 0; u < BENCH_UNIVERSES; u++)
+    {
+        if (m_doc->ioPluginCache()->plugins().isEmpty() == false)
+        {
+            QString stub = m_doc->ioPluginCache()->plugins().first()->name();
+            m_doc->inputOutputMap()->setOutputPatch(u, stub, u % 4);
+        }
+
+        quint32 address = 0;
+        QList<quint32> fixtures;
+
+        FixtureGroup *grp = new FixtureGroup(m_doc);
+        grp->setName(QString("Pars %1").arg(u + 1));
+        grp->setSize(QSize(6, BENCH_PARS / 6));
+        QVERIFY(m_doc->addFixtureGroup(grp) == true);
+
+        for (int i = 0; i < BENCH_PARS; i++)
+        {
+            Fixture *fxi = new Fixture(m_doc);
+            fxi->setFixtureDefinition(parDef, parMode);
+            fxi->setUniverse(u);
+            fxi->setAddress(address);
+            address += fxi->channels();
+            QVERIFY(m_doc->addFixture(fxi) == true);
+            grp->assignFixture(fxi->id());
+            fixtures << fxi->id();
+        }
+
+        for (int i = 0; i < BENCH_DIMMER_PACKS; i++)
+        {
+            Fixture *fxi = new Fixture(m_doc);
+            fxi->setChannels(BENCH_DIMMER_CHANNELS);
+            fxi->setUniverse(u);
+            fxi->setAddress(address);
+            address += fxi->channels();
+            QVERIFY(m_doc->addFixture(fxi) == true);
+            fixtures << fxi->id();
+        }
+
+        /* Static looks on pars and dimmers, chased in sequence */
+        Chaser *chaser = new Chaser(m_doc);
+        chaser->setName(QString("Chaser %1").arg(u + 1));
+        chaser->setFadeInMode(Chaser::PerStep);
+        chaser->setDurationMode(Chaser::PerStep);
+
+        for (int step = 0; step < BENCH_CHASER_STEPS; step++)
+        {
+            Scene *scene = new Scene(m_doc);
+            scene->setName(QString("Look %1.%2").arg(u + 1).arg(step + 1));
+            scene->setFadeInSpeed(1000);
+
+            foreach (quint32 fxiID, fixtures)
+            {
+                Fixture *fxi = m_doc->fixture(fxiID);
+                for (quint32 ch = 0; ch < fxi->channels(); ch++)
+                    scene->setValue(fxiID, ch, uchar((ch * 37 + fxiID * 11 + step * 64) % 256));
+            }
+            QVERIFY(m_doc->addFunction(scene) == true);
+
+            if (step == 0)
+                m_scenes << scene->id();
+
+            chaser->addStep(ChaserStep(scene->id(), 500, 500, 0));
+        }
+        QVERIFY(m_doc->addFunction(chaser) == true);
+        m_chasers << chaser->id();
+
+        /* Moving heads running a shape */
+        EFX *efx = new EFX(m_doc);
+        efx->setName(QString("EFX %1").arg(u + 1));
+        efx->setAlgorithm(EFX::Circle);
+
+        for (int i = 0; i < BENCH_MOVING_HEADS; i++)
+        {
+            Fixture *fxi = new Fixture(m_doc);
+            fxi->setFixtureDefinition(headDef, headMode);
+            fxi->setUniverse(u);
+            fxi->setAddress(address);
+            address += fxi->channels();
+            QVERIFY(m_doc->addFixture(fxi) == true);
+
+            EFXFixture *ef = new EFXFixture(efx);
+            ef->setHead(GroupHead(fxi->id(), 0));
+            efx->addFixture(ef);
+        }
+        QVERIFY(m_doc->addFunction(efx) == true);
+        m_efxs << efx->id();
+
+        QVERIFY(address <= UNIVERSE_SIZE);
+
+        /* Pixel effect on the pars */
+        RGBMatrix *mtx = new RGBMatrix(m_doc);
+        mtx->setName(QString("Matrix %1").arg(u + 1));
+        mtx->setFixtureGroup(grp->id());
+        QVERIFY(m_doc->addFunction(mtx) == true);
+        m_matrices << mtx->id();
+    }
+
+    qDebug() << "Benchmark show:" << m_doc->fixtures().count() << "fixtures,"
+             << m_doc->functions().count() << "functions on"
+             << BENCH_UNIVERSES << "universes";
+
+    m_doc->inputOutputMap()->startUniverses();
+}
+
+void EngineBenchmark::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void EngineBenchmark::cleanup()
+{
+    stopFunctions();
+}
+
+/*****************************************************************************
+ * Helpers
+ *****************************************************************************/
+
+void EngineBenchmark::tick()
+{
+    m_doc->masterTimer()->timerTick();
+}
+
+void EngineBenchmark::startFunctions(const QList<quint32> &ids)
+{
+    foreach (quint32 id, ids)
+    {
+        Function *function = m_doc->function(id);
+        QVERIFY(function != NULL);
+        function->start(m_doc->masterTimer(), FunctionParent::master());
+    }
+}
+
+void EngineBenchmark::stopFunctions()
+{
+    foreach (Function *function, m_doc->functions())
+    {
+        if (function->isRunning())
+            function->stop(FunctionParent::master());
+    }
+
+    for (int i = 0; i < BENCH_WARMUP_TICKS && m_doc->masterTimer()->runningFunctions() > 0; i++)
+        tick();
+
+    /* Let the faders left behind be destroyed */
+    for (int i = 0; i < BENCH_WARMUP_TICKS; i++)
+        tick();
+}
+
+void EngineBenchmark::benchmarkTicks()
+{
+    for (int i = 0; i < BENCH_WARMUP_TICKS; i++)
+        tick();
+
+    QBENCHMARK
+    {
+        tick();
+    }
+
+    /* QBENCHMARK only reports the time per tick. Run a fixed number of
+     * ticks with the profiler enabled to get the full picture */
+    EngineProfiler *profiler = EngineProfiler::instance();
+
+    /* Two stages per universe, one per function, plus the whole stages.
+     * Keep the table half empty, so that no entity is dropped */
+    int entities = 2 * int(m_doc->inputOutputMap()->universesCount()) +
+                   m_doc->functions().count() + 8;
+    profiler->setCapacity(2 * entities);
+    profiler->reset();
+    profiler->setEnabled(true);
+
+    int allocations = s_allocations.load();
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < BENCH_REPORT_TICKS; i++)
+        tick();
+
+    qint64 elapsed = timer.nsecsElapsed();
+    allocations = s_allocations.load() - allocations;
+    profiler->setEnabled(false);
+
+    qDebug("%s: %.1f ticks/sec, %.1f allocations/tick",
+           QTest::currentTestFunction(),
+           double(BENCH_REPORT_TICKS) * 1000000000.0 / double(qMax(elapsed, qint64(1))),
+           double(allocations) / double(BENCH_REPORT_TICKS));
+
+    if (profiler->droppedEntities() > 0)
+        qWarning("  %d entities not profiled: no slot available", profiler->droppedEntities());
+
+    /* Whole stages first, then the worst entity of the per-entity stages */
+    QList<EngineProfiler::Summary> worst;
+    foreach (EngineProfiler::Summary summary, profiler->summaries())
+    {
+        bool found = false;
+        for (int i = 0; i < worst.count(); i++)
+        {
+            if (worst.at(i).stage != summary.stage)
+                continue;
+
+            found = true;
+            if (summary.p99 > worst.at(i).p99)
+                worst[i] = summary;
+        }
+        if (found == false)
+            worst.append(summary);
+    }
+
+    foreach (EngineProfiler::Summary summary, worst)
+    {
+        qDebug("  %-10s id %-5u p50 %8.1f us, p99 %8.1f us, max %8.1f us",
+               qPrintable(EngineProfiler::stageToString(summary.stage)), summary.id,
+               double(summary.p50) / 1000.0, double(summary.p99) / 1000.0,
+               double(summary.max) / 1000.0);
+    }
+}
+
+/*****************************************************************************
+ * Benchmarks
+ *****************************************************************************/
+
+void EngineBenchmark::idle()
+{
+    benchmarkTicks();
+}
+
+void EngineBenchmark::scenes()
+{
+    startFunctions(m_scenes);
+    benchmarkTicks();
+}
+
+void EngineBenchmark::chasers()
+{
+    startFunctions(m_chasers);
+    benchmarkTicks();
+}
+
+void EngineBenchmark::efx()
+{
+    startFunctions(m_efxs);
+    benchmarkTicks();
+}
+
+void EngineBenchmark::rgbMatrices()
+{
+    startFunctions(m_matrices);
+    benchmarkTicks();
+}
+
+void EngineBenchmark::fullShow()
+{
+    startFunctions(m_chasers);
+    startFunctions(m_efxs);
+    startFunctions(m_matrices);
+    benchmarkTicks();
+}
+
+QTEST_MAIN(EngineBenchmark)
@@ -0,0 +1,71 @@
+/*
+  Q Light Controller Plus - Engine benchmark
+  enginebenchmark.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef ENGINEBENCHMARK_H
+#define ENGINEBENCHMARK_H
+
+#include <QObject>
+#include <QList>
+
+class Doc;
+
+/**
+ * Drive MasterTimer ticks by hand on a synthetic show made of thousands
+ * of fixtures spread over a hundred universes, to measure the cost of
+ * the engine hot path without any real timer or output device.
+ */
+class EngineBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+
+    void idle();
+    void scenes();
+    void chasers();
+    void efx();
+    void rgbMatrices();
+    void fullShow();
+
+private:
+    /** Run a single MasterTimer tick */
+    void tick();
+
+    /** Start the functions with the given IDs */
+    void startFunctions(const QList<quint32> &ids);
+
+    /** Stop all the running functions and wait for their faders to go */
+    void stopFunctions();
+
+    /** Benchmark the current show and report ticks/sec, allocations and stages cost */
+    void benchmarkTicks();
+
+private:
+    Doc *m_doc;
+
+    QList<quint32> m_scenes;
+    QList<quint32> m_chasers;
+    QList<quint32> m_efxs;
+    QList<quint32> m_matrices;
+};
+
+#endif
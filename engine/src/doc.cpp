@@ -34,6 +34,7 @@
 #include "monitorproperties.h"
 #include "audioplugincache.h"
 #include "rgbscriptscache.h"
+#include "engineprofiler.h"
 #include "channelsgroup.h"
 #include "scriptwrapper.h"
 #include "collection.h"
@@ -76,6 +77,7 @@ Doc::Doc(QObject* parent, int universes)
     , m_loadStatus(Cleared)
     , m_clipboard(new QLCClipboard(this))
     , m_fixturesListCacheUpToDate(false)
+    , m_blocksIndexUpToDate(false)
     , m_latestFixtureId(0)
     , m_latestFixtureGroupId(0)
     , m_latestChannelsGroupId(0)
@@ -131,6 +133,7 @@ void Doc::clearContents()
         if (func == NULL)
             continue;
         emit functionRemoved(func->id());
+        EngineProfiler::instance()->release(EngineProfiler::FunctionWriteStage, func->id());
         delete func;
     }
 
@@ -163,6 +166,7 @@ void Doc::clearContents()
         emit fixtureRemoved(fxID);
     }
     m_fixturesListCacheUpToDate = false;
+    m_blocksIndexUpToDate = false;
 
     m_orderedGroups.clear();
 
@@ -414,6 +418,7 @@ bool Doc::addFixture(Fixture* fixture, quint32 id)
     fixture->setID(id);
     m_fixtures.insert(id, fixture);
     m_fixturesListCacheUpToDate = false;
+    m_blocksIndexUpToDate = false;
 
     /* Patch fixture change signals thru Doc */
     connect(fixture, SIGNAL(changed(quint32)),
@@ -434,32 +439,8 @@ bool Doc::addFixture(Fixture* fixture, quint32 id)
     }
 
     // Add the fixture channels capabilities to the universe they belong
-    QList<Universe *> universes = inputOutputMap()->claimUniverses();
-
-    QList<int> forcedHTP = fixture->forcedHTPChannels();
-    QList<int> forcedLTP = fixture->forcedLTPChannels();
-    quint32 fxAddress = fixture->address();
-
-    for (i = 0 ; i < fixture->channels(); i++)
-    {
-        const QLCChannel *channel(fixture->channel(i));
-
-        // Inform Universe of any HTP/LTP forcing
-        if (forcedHTP.contains(i))
-            universes.at(uni)->setChannelCapability(fxAddress + i, channel->group(), Universe::HTP);
-        else if (forcedLTP.contains(i))
-            universes.at(uni)->setChannelCapability(fxAddress + i, channel->group(), Universe::LTP);
-        else
-            universes.at(uni)->setChannelCapability(fxAddress + i, channel->group());
-
-        // Apply the default value BEFORE modifiers
-        universes.at(uni)->setChannelDefaultValue(fxAddress + i, channel->defaultValue());
-
-        // Apply a channel modifier, if defined
-        ChannelModifier *mod = fixture->channelModifier(i);
-        universes.at(uni)->setChannelModifier(fxAddress + i, mod);
-    }
-    inputOutputMap()->releaseUniverses(true);
+    inputOutputMap()->setupUniverseChannels(uni,
+        fixtureChannelsSetup(fixture, fixture->forcedHTPChannels(), fixture->forcedLTPChannels()));
 
     emit fixtureAdded(id);
     setModified();
@@ -474,6 +455,7 @@ bool Doc::deleteFixture(quint32 id)
         Fixture* fxi = m_fixtures.take(id);
         Q_ASSERT(fxi != NULL);
         m_fixturesListCacheUpToDate = false;
+        m_blocksIndexUpToDate = false;
 
         /* Keep track of fixture addresses */
         QMutableHashIterator <uint,uint> it(m_addresses);
@@ -513,6 +495,7 @@ bool Doc::replaceFixtures(QList<Fixture*> newFixturesList)
                    this, SLOT(slotFixtureChanged(quint32)));
         delete fxi;
         m_fixturesListCacheUpToDate = false;
+        m_blocksIndexUpToDate = false;
     }
     m_latestFixtureId = 0;
     m_addresses.clear();
@@ -560,6 +543,7 @@ bool Doc::replaceFixtures(QList<Fixture*> newFixturesList)
         newFixture->setExcludeFadeChannels(fixture->excludeFadeChannels());
         m_fixtures.insert(id, newFixture);
         m_fixturesListCacheUpToDate = false;
+        m_blocksIndexUpToDate = false;
 
         /* Patch fixture change signals thru Doc */
         connect(newFixture, SIGNAL(changed(quint32)),
@@ -582,10 +566,6 @@ bool Doc::updateFixtureChannelCapabilities(quint32 id, QList<int> forcedHTP, QLi
         return false;
 
     Fixture* fixture = m_fixtures[id];
-    // get exclusive access to the universes list
-    QList<Universe *> universes = inputOutputMap()->claimUniverses();
-    Universe *universe = universes.at(fixture->universe());
-    quint32 fxAddress = fixture->address();
 
     // Set forced HTP channels
     fixture->setForcedHTPChannels(forcedHTP);
@@ -594,29 +574,42 @@ bool Doc::updateFixtureChannelCapabilities(quint32 id, QList<int> forcedHTP, QLi
     fixture->setForcedLTPChannels(forcedLTP);
 
     // Update the Fixture Universe with the current channel states
-    for (quint32 i = 0 ; i < fixture->channels(); i++)
+    inputOutputMap()->setupUniverseChannels(fixture->universe(),
+                                            fixtureChannelsSetup(fixture, forcedHTP, forcedLTP));
+
+    return true;
+}
+
+QVector<InputOutputMap::ChannelSetup> Doc::fixtureChannelsSetup(Fixture *fixture,
+                                                                QList<int> const& forcedHTP,
+                                                                QList<int> const& forcedLTP) const
+{
+    QVector<InputOutputMap::ChannelSetup> channels(fixture->channels());
+    quint32 fxAddress = fixture->address();
+
+    for (int i = 0; i < channels.count(); i++)
     {
         const QLCChannel *channel(fixture->channel(i));
+        InputOutputMap::ChannelSetup &setup = channels[i];
+
+        setup.address = ushort(fxAddress + i);
+        setup.group = channel->group();
 
         // Inform Universe of any HTP/LTP forcing
         if (forcedHTP.contains(i))
-            universe->setChannelCapability(fxAddress + i, channel->group(), Universe::HTP);
+            setup.forcedType = Universe::HTP;
         else if (forcedLTP.contains(i))
-            universe->setChannelCapability(fxAddress + i, channel->group(), Universe::LTP);
+            setup.forcedType = Universe::LTP;
         else
-            universe->setChannelCapability(fxAddress + i, channel->group());
+            setup.forcedType = Universe::Undefined;
 
-        // Apply the default value BEFORE modifiers
-        universe->setChannelDefaultValue(fxAddress + i, channel->defaultValue());
+        setup.defaultValue = channel->defaultValue();
 
         // Apply a channel modifier, if defined
-        ChannelModifier *mod = fixture->channelModifier(i);
-        universe->setChannelModifier(fxAddress + i, mod);
+        setup.modifier = fixture->channelModifier(i);
     }
 
-    inputOutputMap()->releaseUniverses(true);
-
-    return true;
+    return channels;
 }
 
 QList<Fixture*> const& Doc::fixtures() const
@@ -647,6 +640,35 @@ quint32 Doc::fixtureForAddress(quint32 universeAddress) const
     return m_addresses.value(universeAddress, Fixture::invalidId());
 }
 
+QList<Fixture*> Doc::fixturesInBlocks(quint32 universe, quint32 changedBlocks)
+{
+    if (m_blocksIndexUpToDate == false)
+    {
+        m_blocksIndex.clear();
+        foreach(Fixture *fxi, fixtures())
+        {
+            quint32 mask = Universe::blocksMask(fxi->address(), fxi->channels());
+            m_blocksIndex[fxi->universe()].append(qMakePair(fxi, mask));
+            m_blocksResync.insert(fxi->universe());
+        }
+        m_blocksIndexUpToDate = true;
+    }
+
+    if (m_blocksResync.remove(universe))
+        changedBlocks = UINT_MAX;
+
+    QList<Fixture*> list;
+    QListIterator <QPair<Fixture*, quint32> > it(m_blocksIndex.value(universe));
+    while (it.hasNext() == true)
+    {
+        const QPair<Fixture*, quint32> &entry(it.next());
+        if (entry.second & changedBlocks)
+            list.append(entry.first);
+    }
+
+    return list;
+}
+
 int Doc::totalPowerConsumption(int& fuzzy) const
 {
     int totalPowerConsumption = 0;
@@ -705,6 +727,8 @@ void Doc::slotFixtureChanged(quint32 id)
         m_addresses[i] = id;
     }
 
+    m_blocksIndexUpToDate = false;
+
     setModified();
     emit fixtureChanged(id);
 }
@@ -972,6 +996,7 @@ bool Doc::deleteFunction(quint32 id)
 
         emit functionRemoved(id);
         setModified();
+        EngineProfiler::instance()->release(EngineProfiler::FunctionWriteStage, id);
         delete func;
 
         return true;
@@ -25,6 +25,7 @@
 #include <QList>
 #include <QFile>
 #include <QMap>
+#include <QSet>
 
 #include "qlcfixturedefcache.h"
 #include "qlcmodifierscache.h"
@@ -304,6 +305,19 @@ public:
      */
     quint32 fixtureForAddress(quint32 universeAddress) const;
 
+    /**
+     * Get the fixtures patched on the given universe whose channels overlap
+     * the blocks set in @a changedBlocks, as published by
+     * UniverseMonitor::universeWritten. The first call for a universe after
+     * its fixtures layout changed returns all of them, so that listeners
+     * can resynchronize the fixtures that have been added or moved.
+     *
+     * @param universe The universe index
+     * @param changedBlocks A mask of channel blocks (see Universe::changedBlocks)
+     * @return A list of fixtures, ordered by ID
+     */
+    QList<Fixture*> fixturesInBlocks(quint32 universe, quint32 changedBlocks);
+
     /**
      * Get the total power consumption of all fixtures in the current
      * workspace.
@@ -319,6 +333,14 @@ protected:
      */
     quint32 createFixtureId();
 
+    /**
+     * Build the setup of the universe channels occupied by $fixture,
+     * with the given HTP/LTP forced channels
+     */
+    QVector<InputOutputMap::ChannelSetup> fixtureChannelsSetup(Fixture *fixture,
+                                                               QList<int> const& forcedHTP,
+                                                               QList<int> const& forcedLTP) const;
+
 signals:
     /** Signal that a fixture has been added */
     void fixtureAdded(quint32 fxi_id);
@@ -344,6 +366,12 @@ protected:
     /** Map of the addresses occupied by fixtures */
     QHash <quint32, quint32> m_addresses;
 
+    /** Per universe index of fixtures with the mask of the blocks they cover */
+    bool m_blocksIndexUpToDate;
+    QHash <quint32, QList<QPair<Fixture*, quint32> > > m_blocksIndex;
+    /** Universes to be fully returned by the next fixturesInBlocks() call */
+    QSet <quint32> m_blocksResync;
+
     /** Latest assigned fixture ID */
     quint32 m_latestFixtureId;
 
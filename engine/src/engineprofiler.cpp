@@ -0,0 +1,301 @@
+/*
+  Q Light Controller Plus
+  engineprofiler.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QVector>
+#include <QDebug>
+#include <climits>
+#include <algorithm>
+
+#include "engineprofiler.h"
+
+/** Number of samples kept for each entity. Must be a power of 2 */
+#define PROFILER_RING_SIZE  256
+#define PROFILER_RING_MASK  (PROFILER_RING_SIZE - 1)
+
+/** Maximum number of slots probed to find or claim the slot of an entity */
+#define PROFILER_MAX_PROBES 32
+
+#define PROFILER_MIN_SLOTS  64
+
+#define PROFILER_ID_MASK    0x0FFFFFFF
+
+/** Key of a slot which has never been used */
+#define PROFILER_KEY_FREE     0
+/** Key of a released slot. It can be claimed again, but unlike a free
+ *  slot it doesn't stop the search of the keys claimed after it */
+#define PROFILER_KEY_RELEASED (-1)
+
+struct EngineProfiler::Slot
+{
+    /** (stage + 1) << 28 | id, or one of the PROFILER_KEY_* values */
+    QAtomicInt key;
+    /** Total number of samples written into the ring */
+    QAtomicInt written;
+    QAtomicInt samples[PROFILER_RING_SIZE];
+};
+
+struct EngineProfiler::Table
+{
+    Table(int tableBits)
+        : bits(tableBits)
+        , size(1 << tableBits)
+        , slots(new Slot[1 << tableBits])
+    {
+    }
+
+    ~Table()
+    {
+        delete [] slots;
+    }
+
+    int bits;
+    int size;
+    Slot *slots;
+};
+
+/*****************************************************************************
+ * Initialization
+ *****************************************************************************/
+
+EngineProfiler::EngineProfiler()
+    : m_enabled(0)
+    , m_table(NULL)
+    , m_capacity(ENGINEPROFILER_DEFAULT_ENTITIES)
+{
+}
+
+EngineProfiler::~EngineProfiler()
+{
+    delete m_table.loadAcquire();
+    qDeleteAll(m_retiredTables);
+}
+
+EngineProfiler *EngineProfiler::instance()
+{
+    static EngineProfiler profiler;
+    return &profiler;
+}
+
+void EngineProfiler::setEnabled(bool enable)
+{
+    /* The slots are allocated the first time the profiler is enabled */
+    if (enable && m_table.loadAcquire() == NULL)
+        allocate();
+
+    qDebug() << "[EngineProfiler] profiling" << (enable ? "enabled" : "disabled");
+
+    m_enabled.storeRelease(enable ? 1 : 0);
+}
+
+void EngineProfiler::setCapacity(int entities)
+{
+    int capacity = PROFILER_MIN_SLOTS;
+    while (capacity < entities && capacity < (1 << 20))
+        capacity <<= 1;
+
+    if (capacity == m_capacity)
+        return;
+
+    m_capacity = capacity;
+
+    if (m_table.loadAcquire() != NULL)
+        allocate();
+}
+
+int EngineProfiler::capacity() const
+{
+    return m_capacity;
+}
+
+void EngineProfiler::allocate()
+{
+    int bits = 0;
+    while ((1 << bits) < m_capacity)
+        bits++;
+
+    /* Writers don't hold any lock, so a replaced table is kept
+     * around until the profiler goes away */
+    Table *previous = m_table.fetchAndStoreOrdered(new Table(bits));
+    if (previous != NULL)
+        m_retiredTables.append(previous);
+
+    QMutexLocker locker(&m_droppedMutex);
+    m_droppedKeys.clear();
+}
+
+/*****************************************************************************
+ * Samples
+ *****************************************************************************/
+
+EngineProfiler::Slot *EngineProfiler::slot(quint32 key, bool claim)
+{
+    Table *table = m_table.loadAcquire();
+    if (table == NULL)
+        return NULL;
+
+    quint32 index = (key * 2654435761U) >> (32 - table->bits);
+    int probes = qMin(PROFILER_MAX_PROBES, table->size);
+    Slot *released = NULL;
+
+    for (int i = 0; i < probes; i++)
+    {
+        Slot *s = &table->slots[(index + i) & (table->size - 1)];
+        int current = s->key.loadAcquire();
+
+        if (current == int(key))
+            return s;
+
+        if (current == PROFILER_KEY_RELEASED)
+        {
+            if (released == NULL)
+                released = s;
+            continue;
+        }
+
+        if (current == PROFILER_KEY_FREE)
+        {
+            /* The key is not in the table. Prefer a released slot */
+            if (claim == false)
+                return NULL;
+
+            if (released != NULL && released->key.testAndSetOrdered(PROFILER_KEY_RELEASED, int(key)))
+                return released;
+
+            if (s->key.testAndSetOrdered(PROFILER_KEY_FREE, int(key)))
+                return s;
+            /* Somebody else claimed it in the meantime. It might be us */
+            if (s->key.loadAcquire() == int(key))
+                return s;
+        }
+    }
+
+    if (claim && released != NULL && released->key.testAndSetOrdered(PROFILER_KEY_RELEASED, int(key)))
+        return released;
+
+    return NULL;
+}
+
+void EngineProfiler::record(EngineProfiler::Stage stage, quint32 id, qint64 nsecs)
+{
+    if (isEnabled() == false)
+        return;
+
+    quint32 key = ((quint32(stage) + 1) << 28) | (id & PROFILER_ID_MASK);
+    Slot *s = slot(key, true);
+    if (s == NULL)
+    {
+        QMutexLocker locker(&m_droppedMutex);
+        if (m_droppedKeys.isEmpty())
+            qWarning() << "[EngineProfiler] table full, some entities won't be profiled."
+                       << "Raise" << ENGINEPROFILER_ENTITIES << "above" << m_capacity;
+        m_droppedKeys.insert(key);
+        return;
+    }
+
+    int index = s->written.fetchAndAddOrdered(1);
+    s->samples[index & PROFILER_RING_MASK].store(int(qMin(nsecs, qint64(INT_MAX))));
+}
+
+void EngineProfiler::reset()
+{
+    {
+        QMutexLocker locker(&m_droppedMutex);
+        m_droppedKeys.clear();
+    }
+
+    Table *table = m_table.loadAcquire();
+    if (table == NULL)
+        return;
+
+    /* Slots are kept, so concurrent writers still find their entities */
+    for (int i = 0; i < table->size; i++)
+        table->slots[i].written.storeRelease(0);
+}
+
+void EngineProfiler::release(EngineProfiler::Stage stage, quint32 id)
+{
+    quint32 key = ((quint32(stage) + 1) << 28) | (id & PROFILER_ID_MASK);
+    Slot *s = slot(key, false);
+    if (s == NULL)
+        return;
+
+    s->written.storeRelease(0);
+    s->key.testAndSetOrdered(int(key), PROFILER_KEY_RELEASED);
+}
+
+int EngineProfiler::droppedEntities() const
+{
+    QMutexLocker locker(&m_droppedMutex);
+    return m_droppedKeys.count();
+}
+
+QList<EngineProfiler::Summary> EngineProfiler::summaries() const
+{
+    QList<Summary> list;
+    Table *table = m_table.loadAcquire();
+    if (table == NULL)
+        return list;
+
+    QVector<qint64> samples;
+    samples.reserve(PROFILER_RING_SIZE);
+
+    for (int i = 0; i < table->size; i++)
+    {
+        Slot *slot = &table->slots[i];
+        int key = slot->key.loadAcquire();
+        if (key == PROFILER_KEY_FREE || key == PROFILER_KEY_RELEASED)
+            continue;
+
+        int written = slot->written.loadAcquire();
+        int count = (written < 0 || written > PROFILER_RING_SIZE) ? PROFILER_RING_SIZE : written;
+        if (count == 0)
+            continue;
+
+        samples.resize(count);
+        for (int s = 0; s < count; s++)
+            samples[s] = slot->samples[s].load();
+        std::sort(samples.begin(), samples.end());
+
+        Summary summary;
+        summary.stage = Stage((key >> 28) - 1);
+        summary.id = key & PROFILER_ID_MASK;
+        summary.count = count;
+        summary.p50 = samples.at((count - 1) * 50 / 100);
+        summary.p99 = samples.at((count - 1) * 99 / 100);
+        summary.max = samples.last();
+        list.append(summary);
+    }
+
+    return list;
+}
+
+QString EngineProfiler::stageToString(EngineProfiler::Stage stage)
+{
+    switch (stage)
+    {
+        case TickStage: return QString("Tick");
+        case FunctionsStage: return QString("Functions");
+        case FunctionWriteStage: return QString("Function");
+        case DMXSourcesStage: return QString("DMXSources");
+        case FadersStage: return QString("Faders");
+        case OutputStage: return QString("Output");
+    }
+
+    return QString();
+}
@@ -0,0 +1,185 @@
+/*
+  Q Light Controller Plus
+  engineprofiler.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef ENGINEPROFILER_H
+#define ENGINEPROFILER_H
+
+#include <QElapsedTimer>
+#include <QAtomicPointer>
+#include <QAtomicInt>
+#include <QString>
+#include <QMutex>
+#include <QList>
+#include <QSet>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+#define ENGINEPROFILER_ENABLED "engine/profiler"
+#define ENGINEPROFILER_ENTITIES "engine/profilerentities"
+
+/** Default number of entities that can be profiled at the same time */
+#define ENGINEPROFILER_DEFAULT_ENTITIES 2048
+
+/**
+ * EngineProfiler records how long each stage of a MasterTimer tick takes.
+ *
+ * Every measured entity (a stage, a Function, a Universe...) owns a ring
+ * of the latest samples. Writers never block: an entity slot is claimed
+ * with a compare and swap and samples are stored with atomic operations,
+ * so the profiler can stay enabled during a live show.
+ * Readers build a summary (p50/p99/max) out of the samples currently
+ * held by the rings.
+ *
+ * The number of entities is fixed by setCapacity(). Looking up a slot
+ * probes a bounded number of places, so when the table is too crowded
+ * an entity is dropped instead of slowing down the measured code.
+ * The slots of removed Functions and Universes are given back with
+ * release().
+ */
+class EngineProfiler
+{
+public:
+    enum Stage
+    {
+        TickStage = 0,      //! A whole MasterTimer tick
+        FunctionsStage,     //! MasterTimer::timerTickFunctions
+        FunctionWriteStage, //! A single Function::write. ID is the Function ID
+        DMXSourcesStage,    //! MasterTimer::timerTickDMXSources
+        FadersStage,        //! Universe faders rendering. ID is the Universe ID
+        OutputStage         //! OutputPatch::dump. ID is the Universe ID
+    };
+
+    /** A summary of the samples recorded for an entity. Times are in nanoseconds */
+    struct Summary
+    {
+        Stage stage;
+        quint32 id;
+        int count;
+        qint64 p50;
+        qint64 p99;
+        qint64 max;
+    };
+
+    /** Get the profiler singleton */
+    static EngineProfiler *instance();
+
+    ~EngineProfiler();
+
+    /** Enable/disable the samples recording */
+    void setEnabled(bool enable);
+
+    /**
+     * Set the number of entities that can be profiled at the same time.
+     * The value is rounded up to a power of 2. Changing the capacity
+     * forgets every sample recorded so far.
+     */
+    void setCapacity(int entities);
+
+    /** Get the number of entities that can be profiled at the same time */
+    int capacity() const;
+
+    /** Return true if samples are being recorded */
+    bool isEnabled() const
+    {
+        return m_enabled.loadAcquire() != 0;
+    }
+
+    /** Record a sample of $nsecs nanoseconds for the entity $id of $stage */
+    void record(Stage stage, quint32 id, qint64 nsecs);
+
+    /** Forget every sample recorded so far */
+    void reset();
+
+    /** Give back the slot of the entity $id of $stage (e.g. a deleted Function) */
+    void release(Stage stage, quint32 id);
+
+    /** Return a summary of every entity with at least one sample */
+    QList<Summary> summaries() const;
+
+    /** Return the number of entities whose samples have been dropped
+     *  because no slot was available for them */
+    int droppedEntities() const;
+
+    /** Return a human readable name of $stage */
+    static QString stageToString(Stage stage);
+
+private:
+    EngineProfiler();
+    Q_DISABLE_COPY(EngineProfiler)
+
+    struct Slot;
+    struct Table;
+
+    /** Find the slot of the given key and claim one if $claim is true.
+     *  NULL if not found or if no slot is available */
+    Slot *slot(quint32 key, bool claim);
+
+    /** Allocate a table of m_capacity slots, replacing the current one */
+    void allocate();
+
+private:
+    QAtomicInt m_enabled;
+    QAtomicPointer<Table> m_table;
+    int m_capacity;
+
+    /** Replaced tables, that writers might still be using. They're
+     *  deleted along with the profiler */
+    QList<Table *> m_retiredTables;
+
+    /** The keys which could not get a slot */
+    mutable QMutex m_droppedMutex;
+    QSet<quint32> m_droppedKeys;
+};
+
+/**
+ * Measure the lifetime of the object as a sample of the given stage.
+ * Nothing is measured if the profiler is disabled when the object is created.
+ */
+class EngineProfilerScope
+{
+public:
+    EngineProfilerScope(EngineProfiler::Stage stage, quint32 id = 0)
+        : m_stage(stage)
+        , m_id(id)
+        , m_profiler(EngineProfiler::instance())
+        , m_running(m_profiler->isEnabled())
+    {
+        if (m_running)
+            m_timer.start();
+    }
+
+    ~EngineProfilerScope()
+    {
+        if (m_running)
+            m_profiler->record(m_stage, m_id, m_timer.nsecsElapsed());
+    }
+
+private:
+    EngineProfiler::Stage m_stage;
+    quint32 m_id;
+    EngineProfiler *m_profiler;
+    bool m_running;
+    QElapsedTimer m_timer;
+};
+
+/** @} */
+
+#endif
@@ -32,6 +32,7 @@ FadeChannel::FadeChannel()
     , m_universe(Universe::invalid())
     , m_channel(QLCChannel::invalid())
     , m_address(QLCChannel::invalid())
+    , m_pairedChannel(QLCChannel::invalid())
     , m_start(0)
     , m_target(0)
     , m_current(0)
@@ -47,6 +48,7 @@ FadeChannel::FadeChannel(const FadeChannel& ch)
     , m_universe(ch.m_universe)
     , m_channel(ch.m_channel)
     , m_address(ch.m_address)
+    , m_pairedChannel(ch.m_pairedChannel)
     , m_start(ch.m_start)
     , m_target(ch.m_target)
     , m_current(ch.m_current)
@@ -61,6 +63,7 @@ FadeChannel::FadeChannel(const Doc *doc, quint32 fxi, quint32 channel)
     : m_flags(0)
     , m_fixture(fxi)
     , m_channel(channel)
+    , m_pairedChannel(QLCChannel::invalid())
     , m_start(0)
     , m_target(0)
     , m_current(0)
@@ -84,6 +87,7 @@ FadeChannel &FadeChannel::operator=(const FadeChannel &fc)
         m_universe = fc.m_universe;
         m_channel = fc.m_channel;
         m_address = fc.m_address;
+        m_pairedChannel = fc.m_pairedChannel;
         m_start = fc.m_start;
         m_target = fc.m_target;
         m_current = fc.m_current;
@@ -125,6 +129,7 @@ void FadeChannel::autoDetect(const Doc *doc)
     bool fixtureWasInvalid = false;
     // reset before autodetecting
     setFlags(0);
+    m_pairedChannel = QLCChannel::invalid();
 
     /* on invalid fixture, channel number is most likely
      * absolute (SimpleDesk/CueStack do it this way), so attempt
@@ -180,6 +185,17 @@ void FadeChannel::autoDetect(const Doc *doc)
             removeFlag(FadeChannel::HTP);
             addFlag(FadeChannel::LTP);
         }
+
+        // 16-bit channels are faded as a pair
+        if (canFade())
+        {
+            quint32 paired = fixture->pairedChannel(m_channel);
+            if (paired != QLCChannel::invalid() && fixture->channelCanFade(paired))
+            {
+                m_pairedChannel = paired;
+                addFlag(channel->controlByte() == QLCChannel::MSB ? FadeChannel::Coarse : FadeChannel::Fine);
+            }
+        }
     }
 }
 
@@ -220,6 +236,11 @@ quint32 FadeChannel::address() const
     return (m_address + channel());
 }
 
+quint32 FadeChannel::pairedChannel() const
+{
+    return m_pairedChannel;
+}
+
 quint32 FadeChannel::addressInUniverse() const
 {
     return address() % UNIVERSE_SIZE;
@@ -317,11 +338,22 @@ uchar FadeChannel::calculateCurrent(uint fadeTime, uint elapsedTime)
     }
     else
     {
-        m_current  = m_target - m_start;
-        m_current  = m_current * (qreal(elapsedTime) / qreal(fadeTime));
-        m_current += m_start;
+        // integer math: (target - start) * elapsed fits in 64 bits
+        m_current = m_start + int(qint64(m_target - m_start) * elapsedTime / qint64(fadeTime));
     }
 
     return uchar(m_current);
 }
 
+quint16 FadeChannel::current16(uchar fineStart, uchar fineTarget) const
+{
+    int start = (m_start << 8) | fineStart;
+    int target = (m_target << 8) | fineTarget;
+
+    if (m_elapsed >= m_fadeTime || m_ready == true)
+        return quint16(target);
+    else if (m_elapsed == 0)
+        return quint16(start);
+
+    return quint16(start + int(qint64(target - start) * m_elapsed / qint64(m_fadeTime)));
+}
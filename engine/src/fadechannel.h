@@ -52,7 +52,9 @@ public:
         Relative    = (1 << 5),     /** Relative position */
         Override    = (1 << 6),     /** Override the current universe value */
         Autoremove  = (1 << 7),     /** Automatically remove the channel once value is written */
-        CrossFade   = (1 << 8)      /** Channel subject to crossfade */
+        CrossFade   = (1 << 8),     /** Channel subject to crossfade */
+        Coarse      = (1 << 9),     /** MSB of a 16-bit channel pair */
+        Fine        = (1 << 10)     /** LSB of a 16-bit channel pair */
     };
 
     /** Create a new FadeChannel with empty/invalid values */
@@ -110,6 +112,10 @@ public:
     /** Get the absolute address for this channel. */
     quint32 address() const;
 
+    /** Get the channel within the Fixture that forms a 16-bit value
+     *  with this one. Valid only when the Coarse or Fine flag is set */
+    quint32 pairedChannel() const;
+
     /** Get the absolute address in its universe for this channel. */
     quint32 addressInUniverse() const;
 
@@ -175,11 +181,20 @@ public:
      */
     uchar calculateCurrent(uint fadeTime, uint elapsedTime);
 
+    /**
+     * Calculate the current 16-bit value of a Coarse channel, using the
+     * start and target values of its Fine channel as the LSB.
+     * This uses the current elapsed time, so it is meant to be called
+     * after nextStep().
+     */
+    quint16 current16(uchar fineStart, uchar fineTarget) const;
+
 private:
     quint32 m_fixture;
     quint32 m_universe;
     quint32 m_channel;
     quint32 m_address;
+    quint32 m_pairedChannel;
 
     int m_start;
     int m_target;
@@ -305,6 +305,43 @@ quint32 Fixture::channelNumber(int type, int controlByte, int head) const
     return m_fixtureMode->heads().at(head).channelNumber(type, controlByte);
 }
 
+quint32 Fixture::pairedChannel(quint32 channel) const
+{
+    const QLCChannel *ch = this->channel(channel);
+    if (m_fixtureMode == NULL || ch == NULL)
+        return QLCChannel::invalid();
+
+    int type;
+    if (ch->group() == QLCChannel::Pan || ch->group() == QLCChannel::Tilt)
+        type = ch->group();
+    else if (ch->group() == QLCChannel::Intensity)
+        type = ch->colour() == QLCChannel::NoColour ? int(QLCChannel::Intensity) : int(ch->colour());
+    else
+        return QLCChannel::invalid();
+
+    int byte = ch->controlByte();
+    int otherByte = byte == QLCChannel::MSB ? QLCChannel::LSB : QLCChannel::MSB;
+    int head = m_fixtureMode->headForChannel(channel);
+
+    if (head < 0)
+    {
+        /* Pan/Tilt channels might be defined outside any head */
+        if (type != QLCChannel::Pan && type != QLCChannel::Tilt)
+            return QLCChannel::invalid();
+
+        QLCChannel::Group group = QLCChannel::Group(type);
+        if (m_fixtureMode->channelNumber(group, QLCChannel::ControlByte(byte)) != channel)
+            return QLCChannel::invalid();
+
+        return m_fixtureMode->channelNumber(group, QLCChannel::ControlByte(otherByte));
+    }
+
+    if (channelNumber(type, byte, head) != channel)
+        return QLCChannel::invalid();
+
+    return channelNumber(type, otherByte, head);
+}
+
 quint32 Fixture::masterIntensityChannel() const
 {
     if (m_fixtureMode == NULL)
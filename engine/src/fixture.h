@@ -266,6 +266,16 @@ public:
     /** @see QLCFixtureHead */
     quint32 channelNumber(int type, int controlByte, int head = 0) const;
 
+    /**
+     * Get the channel that forms a 16-bit value together with the given one.
+     * Pan, Tilt and intensity channels are paired by type and head.
+     *
+     * @param channel The MSB or LSB channel index within the fixture
+     * @return The index of the LSB channel if $channel is a MSB, the index
+     *         of the MSB channel if $channel is a LSB, or QLCChannel::invalid()
+     */
+    quint32 pairedChannel(quint32 channel) const;
+
     const QLCChannel* channel(QLCChannel::Preset preset) const;
 
     /** @see QLCFixtureMode */
@@ -18,6 +18,7 @@
 */
 
 #include <cmath>
+#include <QVarLengthArray>
 #include <QDebug>
 
 #include "genericfader.h"
@@ -28,6 +29,8 @@ GenericFader::GenericFader(QObject *parent)
     : QObject(parent)
     , m_fid(Function::invalidId())
     , m_priority(Universe::Auto)
+    , m_channelsGeneration(0)
+    , m_keepZeroChannels(false)
     , m_intensity(1.0)
     , m_parentIntensity(1.0)
     , m_paused(false)
@@ -110,11 +113,14 @@ void GenericFader::remove(FadeChannel *ch)
     quint32 hash = channelHash(ch->fixture(), ch->channel());
     if (m_channels.remove(hash) == 0)
         qDebug() << "No FadeChannel found with hash" << hash;
+    else
+        m_channelsGeneration++;
 }
 
 void GenericFader::removeAll()
 {
     m_channels.clear();
+    m_channelsGeneration++;
 }
 
 bool GenericFader::deleteRequested()
@@ -129,12 +135,14 @@ void GenericFader::requestDelete()
 
 FadeChannel *GenericFader::getChannelFader(const Doc *doc, Universe *universe, quint32 fixtureID, quint32 channel)
 {
-    FadeChannel fc(doc, fixtureID, channel);
-    quint32 hash = channelHash(fc.fixture(), fc.channel());
+    /* Look for an existing channel before building a new one, since
+     * FadeChannel construction has to look up the fixture in Doc */
+    quint32 hash = channelHash(fixtureID, channel);
     QHash<quint32,FadeChannel>::iterator channelIterator = m_channels.find(hash);
     if (channelIterator != m_channels.end())
         return &channelIterator.value();
 
+    FadeChannel fc(doc, fixtureID, channel);
     fc.setCurrent(universe->preGMValue(fc.address()));
 
     m_channels[hash] = fc;
@@ -147,6 +155,16 @@ const QHash<quint32, FadeChannel> &GenericFader::channels() const
     return m_channels;
 }
 
+uint GenericFader::channelsGeneration() const
+{
+    return m_channelsGeneration;
+}
+
+void GenericFader::setKeepZeroChannels(bool keep)
+{
+    m_keepZeroChannels = keep;
+}
+
 int GenericFader::channelsCount() const
 {
     return m_channels.count();
@@ -159,6 +177,18 @@ void GenericFader::write(Universe *universe)
 
     qreal compIntensity = intensity() * parentIntensity();
 
+    if (m_batchAddresses.size() < m_channels.count())
+    {
+        m_batchAddresses.resize(m_channels.count());
+        m_batchValues.resize(m_channels.count());
+    }
+    int *batchAddresses = m_batchAddresses.data();
+    uchar *batchValues = m_batchValues.data();
+    int batchCount = 0;
+
+    // Fine channels whose MSB might not have been processed yet
+    QVarLengthArray<quint32, 16> fineRemovals;
+
     QMutableHashIterator <quint32,FadeChannel> it(m_channels);
     while (it.hasNext() == true)
     {
@@ -167,6 +197,28 @@ void GenericFader::write(Universe *universe)
         int address = int(fc.addressInUniverse());
         uchar value;
 
+        if (isBatchable(flags))
+        {
+            // plain HTP intensity fade: no blending involved, so just
+            // queue the value to be merged with the others at once
+            value = m_paused ? fc.current() : fc.nextStep(MasterTimer::tick());
+            if (flags & FadeChannel::CanFade)
+                value = fc.current(compIntensity);
+
+            batchAddresses[batchCount] = address;
+            batchValues[batchCount] = value;
+            batchCount++;
+
+            if ((m_keepZeroChannels == false || m_fadeOut) &&
+                fc.current() == 0 && fc.target() == 0 && fc.isReady())
+            {
+                it.remove();
+                m_channelsGeneration++;
+            }
+
+            continue;
+        }
+
         // Calculate the next step
         if (m_paused)
             value = fc.current();
@@ -187,10 +239,37 @@ void GenericFader::write(Universe *universe)
             }
         }
 
+        // A 16-bit pair is faded by its MSB channel, which writes both values
+        int fineAddress = -1;
+        uchar fineValue = 0;
+
+        if (flags & FadeChannel::Coarse)
+        {
+            const FadeChannel *fine = pairedChannel(fc);
+            if (fine != NULL)
+            {
+                quint16 value16 = fc.current16(fine->start(), fine->target());
+                if (flags & FadeChannel::Intensity)
+                    value16 = quint16(floor((qreal(value16) * compIntensity) + 0.5));
+
+                value = uchar(value16 >> 8);
+                fineAddress = int(fine->addressInUniverse());
+                fineValue = uchar(value16 & 0x00FF);
+            }
+        }
+
+        bool pairedFine = (flags & FadeChannel::Fine) && pairedChannel(fc) != NULL;
+
         //qDebug() << "[GenericFader] >>> uni:" << universe->id() << ", address:" << address << ", value:" << value << "int:" << compIntensity;
-        if (flags & FadeChannel::Override)
+        if (pairedFine)
+        {
+            // written by the MSB channel
+        }
+        else if (flags & FadeChannel::Override)
         {
             universe->write(address, value, true);
+            if (fineAddress >= 0)
+                universe->write(fineAddress, fineValue, true);
             continue;
         }
         else if (flags & FadeChannel::Relative)
@@ -200,22 +279,41 @@ void GenericFader::write(Universe *universe)
         else
         {
             universe->writeBlended(address, value, m_blendMode);
+            if (fineAddress >= 0)
+                universe->writeBlended(fineAddress, fineValue, m_blendMode);
         }
 
+        bool remove = false;
+
         if (((flags & FadeChannel::Intensity) &&
             (flags & FadeChannel::HTP) &&
-            m_blendMode == Universe::NormalBlend) || m_fadeOut)
+            m_blendMode == Universe::NormalBlend && m_keepZeroChannels == false) || m_fadeOut)
         {
             // Remove all channels that reach their target _zero_ value.
             // They have no effect either way so removing them saves a bit of CPU.
             if (fc.current() == 0 && fc.target() == 0 && fc.isReady())
-                it.remove();
+                remove = true;
         }
 
         if (flags & FadeChannel::Autoremove)
+            remove = true;
+
+        // The MSB channel still needs the LSB one to write the pair
+        if (remove && pairedFine)
+            fineRemovals.append(it.key());
+        else if (remove)
             it.remove();
+
+        if (remove)
+            m_channelsGeneration++;
     }
 
+    for (int i = 0; i < fineRemovals.count(); i++)
+        m_channels.remove(fineRemovals.at(i));
+
+    if (batchCount)
+        universe->writeHTPBatch(batchAddresses, batchValues, batchCount);
+
     // self-request deletion when fadeout is complete
     if (m_fadeOut && channelsCount() == 0)
     {
@@ -224,6 +322,39 @@ void GenericFader::write(Universe *universe)
     }
 }
 
+const FadeChannel *GenericFader::pairedChannel(const FadeChannel &fc) const
+{
+    // relative and crossfaded channels are not faded in pairs
+    if (fc.flags() & (FadeChannel::Relative | FadeChannel::CrossFade))
+        return NULL;
+
+    QHash<quint32,FadeChannel>::const_iterator it =
+            m_channels.constFind(channelHash(fc.fixture(), fc.pairedChannel()));
+    if (it == m_channels.constEnd())
+        return NULL;
+
+    if (it.value().flags() & (FadeChannel::Relative | FadeChannel::CrossFade))
+        return NULL;
+
+    return &it.value();
+}
+
+bool GenericFader::isBatchable(int flags) const
+{
+    if (m_blendMode != Universe::NormalBlend)
+        return false;
+
+    if ((flags & (FadeChannel::HTP | FadeChannel::Intensity)) != (FadeChannel::HTP | FadeChannel::Intensity))
+        return false;
+
+    if (flags & (FadeChannel::Override | FadeChannel::Relative |
+                 FadeChannel::CrossFade | FadeChannel::Autoremove |
+                 FadeChannel::Coarse | FadeChannel::Fine))
+        return false;
+
+    return true;
+}
+
 qreal GenericFader::intensity() const
 {
     return m_intensity;
@@ -21,6 +21,7 @@
 #define GENERICFADER
 
 #include <QObject>
+#include <QVector>
 #include <QList>
 #include <QHash>
 
@@ -93,6 +94,20 @@ public:
     /** Get all channels in a non-modifiable hashmap */
     const QHash <quint32,FadeChannel>& channels() const;
 
+    /**
+     * Get the generation of the channels. It changes every time channels
+     * are removed, which is when the pointers returned by getChannelFader()
+     * might become invalid. Adding channels doesn't change it.
+     */
+    uint channelsGeneration() const;
+
+    /**
+     * Keep the HTP intensity channels which have faded to zero, instead of
+     * removing them (except when fading out). Useful for the Functions that
+     * write the same channels on every step through cached pointers.
+     */
+    void setKeepZeroChannels(bool keep);
+
     /** Return the number of channel added to this fader */
     int channelsCount() const;
 
@@ -144,11 +159,22 @@ signals:
      *  Data is preGM and includes the whole universe */
     void preWriteData(quint32 index, const QByteArray& universeData);
 
+private:
+    /** Returns true if $flags describe a plain HTP intensity channel that
+     *  can be written along with the others in a single batch */
+    bool isBatchable(int flags) const;
+
+    /** Returns the other channel of the 16-bit pair $fc belongs to,
+     *  if it is faded by this fader too, otherwise NULL */
+    const FadeChannel *pairedChannel(const FadeChannel &fc) const;
+
 private:
     QString m_name;
     quint32 m_fid;
     int m_priority;
     QHash <quint32,FadeChannel> m_channels;
+    uint m_channelsGeneration;
+    bool m_keepZeroChannels;
     qreal m_intensity;
     qreal m_parentIntensity;
     bool m_paused;
@@ -157,6 +183,12 @@ private:
     bool m_deleteRequest;
     Universe::BlendMode m_blendMode;
     bool m_monitoring;
+
+    /** Contiguous address/value arrays of the HTP intensity channels
+     *  written in the current tick. They are reused across ticks,
+     *  so they only grow when channels are added */
+    QVector<int> m_batchAddresses;
+    QVector<uchar> m_batchValues;
 };
 
 /** @} */
@@ -27,13 +27,17 @@
 #include <QXmlStreamWriter>
 #include <QElapsedTimer>
 #include <QSettings>
+#include <QThread>
 #include <QDebug>
 #include <qmath.h>
 
+#include "universeworkerpool.h"
 #include "inputoutputmap.h"
+#include "engineprofiler.h"
 #include "qlcinputchannel.h"
 #include "qlcinputsource.h"
 #include "qlcioplugin.h"
+#include "mastertimer.h"
 #include "outputpatch.h"
 #include "inputpatch.h"
 #include "qlcconfig.h"
@@ -46,7 +50,9 @@
 InputOutputMap::InputOutputMap(Doc *doc, quint32 universes)
   : QObject(doc)
   , m_blackout(false)
-  , m_universeChanged(false)
+  , m_universeChanged(0)
+  , m_universeSnapshot(new UniverseSnapshot())
+  , m_workerPool(new UniverseWorkerPool())
   , m_beatTime(new QElapsedTimer())
 {
     m_grandMaster = new GrandMaster(this);
@@ -60,7 +66,9 @@ InputOutputMap::InputOutputMap(Doc *doc, quint32 universes)
 
 InputOutputMap::~InputOutputMap()
 {
+    delete m_workerPool;
     removeAllUniverses();
+    m_universeSnapshot.clear();
     delete m_grandMaster;
     delete m_beatTime;
 }
@@ -124,6 +132,18 @@ bool InputOutputMap::blackout() const
  * Universes
  *****************************************************************************/
 
+UniverseSnapshot::~UniverseSnapshot()
+{
+    foreach (Universe *uni, m_retired)
+    {
+        /* The last reader might be another thread, like the MasterTimer */
+        if (uni->thread() == QThread::currentThread())
+            delete uni;
+        else
+            uni->deleteLater();
+    }
+}
+
 quint32 InputOutputMap::invalidUniverse()
 {
     return UINT_MAX;
@@ -154,16 +174,18 @@ bool InputOutputMap::addUniverse(quint32 id)
             while (id > universesCount())
             {
                 uni = new Universe(universesCount(), m_grandMaster);
-                connect(doc()->masterTimer(), SIGNAL(tickReady()), uni, SLOT(tick()), Qt::QueuedConnection);
-                connect(uni, SIGNAL(universeWritten(quint32,QByteArray)), this, SIGNAL(universeWritten(quint32,QByteArray)));
+                connect(uni, SIGNAL(universeWritten(quint32,QByteArray,quint32)),
+                        this, SIGNAL(universeWritten(quint32,QByteArray,quint32)));
                 m_universeArray.append(uni);
             }
         }
 
         uni = new Universe(id, m_grandMaster);
-        connect(doc()->masterTimer(), SIGNAL(tickReady()), uni, SLOT(tick()), Qt::QueuedConnection);
-        connect(uni, SIGNAL(universeWritten(quint32,QByteArray)), this, SIGNAL(universeWritten(quint32,QByteArray)));
+        connect(uni, SIGNAL(universeWritten(quint32,QByteArray,quint32)),
+                this, SIGNAL(universeWritten(quint32,QByteArray,quint32)));
         m_universeArray.append(uni);
+
+        publishUniverses();
     }
 
     emit universeAdded(id);
@@ -185,7 +207,10 @@ bool InputOutputMap::removeUniverse(int index)
             return false;
         }
 
-        delete  m_universeArray.takeAt(index);
+        Universe *uni = m_universeArray.takeAt(index);
+        EngineProfiler::instance()->release(EngineProfiler::FadersStage, uni->id());
+        EngineProfiler::instance()->release(EngineProfiler::OutputStage, uni->id());
+        publishUniverses(QList<Universe *>() << uni);
     }
 
     emit universeRemoved(index);
@@ -195,15 +220,32 @@ bool InputOutputMap::removeUniverse(int index)
 bool InputOutputMap::removeAllUniverses()
 {
     QMutexLocker locker(&m_universeMutex);
-    qDeleteAll(m_universeArray);
+    QList<Universe *> removed = m_universeArray;
     m_universeArray.clear();
+    foreach (Universe *uni, removed)
+    {
+        EngineProfiler::instance()->release(EngineProfiler::FadersStage, uni->id());
+        EngineProfiler::instance()->release(EngineProfiler::OutputStage, uni->id());
+    }
+    publishUniverses(removed);
     return true;
 }
 
 void InputOutputMap::startUniverses()
 {
-    foreach (Universe *uni, m_universeArray)
-        uni->start();
+    m_workerPool->start();
+}
+
+void InputOutputMap::processUniverses(const QList<Universe *> &universes)
+{
+    if (m_workerPool->isRunning() == false)
+        return;
+
+    m_workerPool->process(universes);
+
+    /* All the universes of this tick have been written */
+    foreach (QLCIOPlugin *plugin, doc()->ioPluginCache()->plugins())
+        plugin->flushUniverses();
 }
 
 quint32 InputOutputMap::getUniverseID(int index)
@@ -282,14 +324,108 @@ QList<Universe *> InputOutputMap::universes() const
 
 QList<Universe*> InputOutputMap::claimUniverses()
 {
-    m_universeMutex.lock();
-    return m_universeArray;
+    m_claimedSnapshot = universesSnapshot();
+    applyChannelsChanges(m_claimedSnapshot->universes());
+    return m_claimedSnapshot->universes();
 }
 
 void InputOutputMap::releaseUniverses(bool changed)
 {
-    m_universeChanged = changed;
-    m_universeMutex.unlock();
+    m_universeChanged.storeRelease(changed);
+    m_claimedSnapshot.clear();
+}
+
+UniverseSnapshotPtr InputOutputMap::universesSnapshot() const
+{
+    QMutexLocker locker(&m_snapshotMutex);
+    return m_universeSnapshot;
+}
+
+void InputOutputMap::publishUniverses(QList<Universe *> const& retired)
+{
+    UniverseSnapshotPtr snapshot(new UniverseSnapshot());
+    snapshot->m_universes = m_universeArray;
+
+    UniverseSnapshotPtr previous;
+    {
+        QMutexLocker locker(&m_snapshotMutex);
+        previous = m_universeSnapshot;
+        m_universeSnapshot = snapshot;
+    }
+
+    /* The readers still holding the previous snapshot keep the retired
+     * universes alive. The last of them deletes them */
+    previous->m_retired = retired;
+    previous->m_next = snapshot;
+}
+
+void InputOutputMap::setupUniverseChannels(quint32 universe, QVector<ChannelSetup> const& channels)
+{
+    if (channels.isEmpty())
+        return;
+
+    ChannelsChange change;
+    change.universe = universe;
+    change.channels = channels;
+    change.address = 0;
+    change.range = 0;
+    postChannelsChange(change);
+}
+
+void InputOutputMap::resetUniverseChannels(quint32 universe, int address, int range)
+{
+    ChannelsChange change;
+    change.universe = universe;
+    change.address = address;
+    change.range = range;
+    postChannelsChange(change);
+}
+
+void InputOutputMap::postChannelsChange(ChannelsChange const& change)
+{
+    {
+        QMutexLocker locker(&m_channelsChangesMutex);
+        m_channelsChanges.append(change);
+    }
+
+    /* Nobody else is ticking: apply the change right away */
+    if (doc()->masterTimer()->isRunning() == false)
+        applyChannelsChanges(universesSnapshot()->universes());
+
+    m_universeChanged.storeRelease(true);
+}
+
+void InputOutputMap::applyChannelsChanges(QList<Universe *> const& universes)
+{
+    QList<ChannelsChange> changes;
+    {
+        QMutexLocker locker(&m_channelsChangesMutex);
+        if (m_channelsChanges.isEmpty())
+            return;
+        changes.swap(m_channelsChanges);
+    }
+
+    foreach (ChannelsChange const& change, changes)
+    {
+        if (change.universe >= quint32(universes.count()))
+            continue;
+
+        Universe *universe = universes.at(change.universe);
+
+        if (change.channels.isEmpty())
+        {
+            universe->reset(change.address, change.range);
+            continue;
+        }
+
+        foreach (ChannelSetup const& setup, change.channels)
+        {
+            universe->setChannelCapability(setup.address, setup.group, setup.forcedType);
+            // Apply the default value BEFORE modifiers
+            universe->setChannelDefaultValue(setup.address, setup.defaultValue);
+            universe->setChannelModifier(setup.address, setup.modifier);
+        }
+    }
 }
 
 void InputOutputMap::resetUniverses()
@@ -317,7 +453,7 @@ void InputOutputMap::setGrandMasterChannelMode(GrandMaster::ChannelMode mode)
     if(m_grandMaster->channelMode() != mode)
     {
         m_grandMaster->setChannelMode(mode);
-        m_universeChanged = true;
+        m_universeChanged.storeRelease(true);
     }
 }
 
@@ -335,7 +471,7 @@ void InputOutputMap::setGrandMasterValueMode(GrandMaster::ValueMode mode)
     if(m_grandMaster->valueMode() != mode)
     {
         m_grandMaster->setValueMode(mode);
-        m_universeChanged = true;
+        m_universeChanged.storeRelease(true);
     }
 
     emit grandMasterValueModeChanged(mode);
@@ -355,10 +491,10 @@ void InputOutputMap::setGrandMasterValue(uchar value)
     if (m_grandMaster->value() != value)
     {
         m_grandMaster->setValue(value);
-        m_universeChanged = true;
+        m_universeChanged.storeRelease(true);
     }
 
-    if (m_universeChanged == true)
+    if (m_universeChanged.loadAcquire())
         emit grandMasterValueChanged(value);
 }
 
@@ -21,21 +21,25 @@
 #define INPUTOUTPUTMAP_H
 
 #include <QSharedPointer>
+#include <QAtomicInt>
+#include <QVector>
 #include <QObject>
 #include <QMutex>
 #include <QDir>
 
 #include "qlcinputprofile.h"
 #include "grandmaster.h"
+#include "universe.h"
 
 class QXmlStreamReader;
 class QXmlStreamWriter;
 class QLCInputSource;
 class QElapsedTimer;
 class QLCIOPlugin;
+class UniverseWorkerPool;
+class ChannelModifier;
 class OutputPatch;
 class InputPatch;
-class Universe;
 class Doc;
 
 /** @addtogroup engine Engine
@@ -44,6 +48,34 @@ class Doc;
 
 #define KXMLIOMap "InputOutputMap"
 
+/**
+ * An immutable list of universes published by InputOutputMap.
+ * The Universe objects in it live at least as long as the snapshot.
+ */
+class UniverseSnapshot
+{
+public:
+    ~UniverseSnapshot();
+
+    QList<Universe *> const& universes() const { return m_universes; }
+
+private:
+    friend class InputOutputMap;
+
+    QList<Universe *> m_universes;
+
+    /** The universes removed from the list published after this one.
+     *  They're deleted along with this snapshot */
+    QList<Universe *> m_retired;
+
+    /** The snapshot published after this one. Holding it makes sure
+     *  the newer snapshots, and their retired universes, outlive
+     *  the older ones */
+    QSharedPointer<UniverseSnapshot> m_next;
+};
+
+typedef QSharedPointer<UniverseSnapshot> UniverseSnapshotPtr;
+
 class InputOutputMap : public QObject
 {
     Q_OBJECT
@@ -163,10 +195,18 @@ public:
     bool removeAllUniverses();
 
     /**
-     * Start all the Universe threads
+     * Start the worker threads processing the Universes
      */
     void startUniverses();
 
+    /**
+     * Process one tick of the given universes and return when they
+     * have all been rendered and sent to their output patches.
+     * The I/O plugins are then asked to flush their output.
+     * This is called by MasterTimer with the universes claimed.
+     */
+    void processUniverses(const QList<Universe *> &universes);
+
     /**
      * Get the unique ID of the universe at the given index
      * @param index The universe index
@@ -242,19 +282,59 @@ public:
     QList<Universe*> universes() const;
 
     /**
-     * Claim access to a universe. This is declared virtual to make
-     * unit testing a bit easier.
+     * Claim access to the universes, to change their values or channels
+     * state. This is meant for the MasterTimer thread (or for a thread
+     * running ticks by itself while the MasterTimer is stopped) and never
+     * blocks: the returned list is the latest published snapshot, and the
+     * Universe objects in it are guaranteed to live until
+     * releaseUniverses() is called. The channel changes queued with
+     * setupUniverseChannels() and resetUniverseChannels() are applied
+     * before returning.
+     * This is declared virtual to make unit testing a bit easier.
      */
     virtual QList<Universe*> claimUniverses();
 
     /**
-     * Release access to a universe. This is declared virtual to make
-     * unit testing a bit easier.
+     * Release access to the universes claimed with claimUniverses().
+     * This is declared virtual to make unit testing a bit easier.
      *
      * @param changed Set to true if DMX values were changed
      */
     virtual void releaseUniverses(bool changed = true);
 
+    /**
+     * Get the latest published universe list, for read-only access from
+     * any thread. This never blocks, even during a MasterTimer tick, so it
+     * must be used only to read values which are safe to access
+     * concurrently (e.g. a single channel value or a universe snapshot).
+     * The Universe objects in it live as long as the returned reference.
+     */
+    UniverseSnapshotPtr universesSnapshot() const;
+
+    /** The setup of a single universe channel, as done by a fixture */
+    struct ChannelSetup
+    {
+        ushort address;
+        QLCChannel::Group group;
+        Universe::ChannelType forcedType;
+        uchar defaultValue;
+        ChannelModifier *modifier;
+    };
+
+    /**
+     * Set the capabilities, default value and modifier of some channels
+     * of $universe. The MasterTimer thread applies them at the beginning
+     * of its next tick, so the caller never waits for it. When the
+     * MasterTimer is not running, they're applied right away.
+     */
+    void setupUniverseChannels(quint32 universe, QVector<ChannelSetup> const& channels);
+
+    /**
+     * Reset $range channels of $universe starting from $address,
+     * the same way as setupUniverseChannels()
+     */
+    void resetUniverseChannels(quint32 universe, int address, int range);
+
     /**
      * Reset all universes (useful when starting from scratch)
      */
@@ -263,18 +343,63 @@ public:
 signals:
     void universeAdded(quint32 id);
     void universeRemoved(quint32 id);
-    void universeWritten(quint32 index, const QByteArray& universesData);
+    void universeWritten(quint32 index, const QByteArray& universesData,
+                         quint32 changedBlocks = UINT_MAX);
+
+private:
+    /**
+     * Publish a new snapshot of m_universeArray. The $retired universes,
+     * just removed from m_universeArray, are deleted as soon as no reader
+     * holds a snapshot containing them anymore. This never waits for
+     * the readers. Must be called with m_universeMutex locked.
+     */
+    void publishUniverses(QList<Universe *> const& retired = QList<Universe *>());
+
+    /** A queued change of the channels of a universe */
+    struct ChannelsChange
+    {
+        quint32 universe;
+        /** Channels to setup. When empty, $range channels
+         *  from $address are reset instead */
+        QVector<ChannelSetup> channels;
+        int address;
+        int range;
+    };
+
+    /** Queue $change for the next tick, or apply it right away if
+     *  the MasterTimer is not running */
+    void postChannelsChange(ChannelsChange const& change);
+
+    /** Apply the queued channel changes to $universes */
+    void applyChannelsChanges(QList<Universe *> const& universes);
 
 private:
     /** The values of all universes */
     QList<Universe *> m_universeArray;
 
     /** When true, universes are dumped. Otherwise not. */
-    bool m_universeChanged;
+    QAtomicInt m_universeChanged;
 
-    /** Mutex guarding m_universeArray */
+    /** Mutex serializing the writers of m_universeArray */
     QMutex m_universeMutex;
 
+    /** The latest published copy of m_universeArray */
+    UniverseSnapshotPtr m_universeSnapshot;
+
+    /** Guards m_universeSnapshot. It is held only to copy or swap
+     *  the reference, never while the universes are used */
+    mutable QMutex m_snapshotMutex;
+
+    /** The snapshot held between claimUniverses() and releaseUniverses() */
+    UniverseSnapshotPtr m_claimedSnapshot;
+
+    /** The channel changes waiting for the next tick */
+    QList<ChannelsChange> m_channelsChanges;
+    QMutex m_channelsChangesMutex;
+
+    /** The pool of threads processing the universes on each tick */
+    UniverseWorkerPool *m_workerPool;
+
     /*********************************************************************
      * Grand Master
      *********************************************************************/
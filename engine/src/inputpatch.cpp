@@ -24,6 +24,7 @@
 #endif
 
 #include <QDebug>
+#include <QtAlgorithms>
 
 #include "qlcinputchannel.h"
 #include "qlcioplugin.h"
@@ -31,6 +32,9 @@
 
 #define GRACE_MS 1
 
+/** Slot flag telling that the channel has a key stored in m_keys */
+#define SLOT_HAS_KEY    (1 << 8)
+
 /*****************************************************************************
  * Initialization
  *****************************************************************************/
@@ -65,6 +69,9 @@ InputPatch::~InputPatch()
 {
     if (m_plugin != NULL)
         m_plugin->closeInput(m_pluginLine, m_universe);
+
+    for (int i = 0; i < INPUTPATCH_BLOCK_COUNT; i++)
+        delete m_blocks[i].loadAcquire();
 }
 
 /*****************************************************************************
@@ -83,12 +90,15 @@ bool InputPatch::set(QLCIOPlugin* plugin, quint32 input, QLCInputProfile* profil
     {
         disconnect(m_plugin, SIGNAL(valueChanged(quint32,quint32,quint32,uchar,QString)),
                    this, SLOT(slotValueChanged(quint32,quint32,quint32,uchar,QString)));
+        disconnect(m_plugin, SIGNAL(frameReceived(quint32,quint32,QByteArray)),
+                   this, SLOT(slotFrameReceived(quint32,quint32,QByteArray)));
         m_plugin->closeInput(m_pluginLine, m_universe);
     }
 
     m_plugin = plugin;
     m_pluginLine = input;
     m_profile = profile;
+    m_lastFrame.clear();
 
     if (m_plugin != NULL)
     {
@@ -104,6 +114,8 @@ bool InputPatch::set(QLCIOPlugin* plugin, quint32 input, QLCInputProfile* profil
     {
         connect(m_plugin, SIGNAL(valueChanged(quint32,quint32,quint32,uchar,QString)),
                 this, SLOT(slotValueChanged(quint32,quint32,quint32,uchar,QString)));
+        connect(m_plugin, SIGNAL(frameReceived(quint32,quint32,QByteArray)),
+                this, SLOT(slotFrameReceived(quint32,quint32,QByteArray)));
         result = m_plugin->openInput(m_pluginLine, m_universe);
 
         if (m_profile != NULL)
@@ -221,25 +233,18 @@ void InputPatch::slotValueChanged(quint32 universe, quint32 input, quint32 chann
     {
         if (universe == UINT_MAX || universe == m_universe)
         {
-            QMutexLocker inputBufferLocker(&m_inputBufferMutex);
-            InputValue val(value, key);
-            if (m_inputBuffer.contains(channel))
-            {
-                InputValue const& curVal = m_inputBuffer.value(channel);
-                if (curVal.value != val.value)
-                {
-                    // Every ON/OFF changes must pass through
-                    if (curVal.value == 0 || val.value == 0)
-                    {
-                        emit inputValueChanged(m_universe, channel, curVal.value, curVal.key);
-                    }
-                    m_inputBuffer.insert(channel, val);
-                }
-            }
-            else
-            {
-                m_inputBuffer.insert(channel, val);
-            }
+            bufferValue(channel, value, key);
+        }
+    }
+}
+
+void InputPatch::slotFrameReceived(quint32 universe, quint32 input, const QByteArray &data)
+{
+    if (input == m_pluginLine)
+    {
+        if (universe == UINT_MAX || universe == m_universe)
+        {
+            bufferFrame(data);
         }
     }
 }
@@ -279,15 +284,186 @@ void InputPatch::setProfilePageControls()
     }
 }
 
+/*****************************************************************************
+ * Input buffer
+ *****************************************************************************/
+
+void InputPatch::bufferValue(quint32 channel, uchar value, const QString& key)
+{
+    quint32 blockIndex = channel / INPUTPATCH_BLOCK_SIZE;
+
+    if (blockIndex >= INPUTPATCH_BLOCK_COUNT)
+    {
+        QMutexLocker overflowLocker(&m_overflowMutex);
+        InputValue val(value, key);
+        if (m_overflowBuffer.contains(channel))
+        {
+            InputValue const& curVal = m_overflowBuffer.value(channel);
+            if (curVal.value != val.value)
+            {
+                // Every ON/OFF changes must pass through
+                if (curVal.value == 0 || val.value == 0)
+                    emit inputValueChanged(m_universe, channel, curVal.value, curVal.key);
+                m_overflowBuffer.insert(channel, val);
+            }
+        }
+        else
+        {
+            m_overflowBuffer.insert(channel, val);
+        }
+        return;
+    }
+
+    InputBlock *block = m_blocks[blockIndex].loadAcquire();
+    if (block == NULL)
+    {
+        InputBlock *newBlock = new InputBlock;
+        if (m_blocks[blockIndex].testAndSetOrdered(NULL, newBlock))
+        {
+            block = newBlock;
+        }
+        else
+        {
+            delete newBlock;
+            block = m_blocks[blockIndex].loadAcquire();
+        }
+    }
+
+    int index = channel % INPUTPATCH_BLOCK_SIZE;
+    QAtomicInt &slot = block->values[index];
+    int newSlot = value;
+
+    if (key.isEmpty() == false)
+    {
+        if ((slot.loadAcquire() & SLOT_HAS_KEY) == 0)
+        {
+            QMutexLocker keysLocker(&m_keysMutex);
+            m_keys.insert(channel, key);
+        }
+        newSlot |= SLOT_HAS_KEY;
+    }
+
+    int bit = int(1u << (index % 32));
+    uchar oldValue = uchar(slot.loadAcquire() & 0xFF);
+
+    // Every ON/OFF changes must pass through
+    if (oldValue != value && (oldValue == 0 || value == 0))
+    {
+        /* flush() holds the lock while it reads the slots, so the
+         * previous value is either already taken or still dirty.
+         * In the latter case it is queued, to be emitted first */
+        QMutexLocker transitionsLocker(&m_transitionsMutex);
+
+        int oldSlot = slot.fetchAndStoreOrdered(newSlot);
+        bool wasDirty = block->dirty[index / 32].fetchAndOrOrdered(bit) & bit;
+        m_dirtyBlocks[blockIndex / 32].fetchAndOrOrdered(int(1u << (blockIndex % 32)));
+
+        if (wasDirty)
+            m_transitions.append(ChannelValue(channel, InputValue(uchar(oldSlot & 0xFF),
+                                                                  slotKey(channel, oldSlot))));
+        return;
+    }
+
+    /* The value is stored before the dirty bit is raised, so that a
+     * concurrent flush can at worst emit the same value twice, but it
+     * never misses the latest one */
+    slot.fetchAndStoreOrdered(newSlot);
+    block->dirty[index / 32].fetchAndOrOrdered(bit);
+    m_dirtyBlocks[blockIndex / 32].fetchAndOrOrdered(int(1u << (blockIndex % 32)));
+}
+
+void InputPatch::bufferFrame(const QByteArray &data)
+{
+    int length = data.length();
+
+    /* Channels never received before are considered at zero */
+    if (m_lastFrame.length() < length)
+        m_lastFrame.append(QByteArray(length - m_lastFrame.length(), 0));
+
+    const char *values = data.constData();
+    char *lastValues = m_lastFrame.data();
+
+    for (int address = 0; address < length; address += 32)
+    {
+        int count = qMin(32, length - address);
+        if (memcmp(lastValues + address, values + address, count) == 0)
+            continue;
+
+        for (int i = address; i < address + count; i++)
+        {
+            if (lastValues[i] != values[i])
+            {
+                lastValues[i] = values[i];
+                bufferValue(i, uchar(values[i]), QString());
+            }
+        }
+    }
+}
+
+QString InputPatch::slotKey(quint32 channel, int slot)
+{
+    if ((slot & SLOT_HAS_KEY) == 0)
+        return QString();
+
+    QMutexLocker keysLocker(&m_keysMutex);
+    return m_keys.value(channel);
+}
+
 void InputPatch::flush(quint32 universe)
 {
-    if (universe == UINT_MAX || universe == m_universe)
+    if (universe != UINT_MAX && universe != m_universe)
+        return;
+
+    /* The values are collected under the lock, so that no ON/OFF
+     * transition can slip in between, and emitted afterwards */
     {
-        QMutexLocker inputBufferLocker(&m_inputBufferMutex);
-        for (QHash<quint32, InputValue>::const_iterator it = m_inputBuffer.begin(); it != m_inputBuffer.end(); ++it)
+        QMutexLocker transitionsLocker(&m_transitionsMutex);
+        m_flushValues.swap(m_transitions);
+
+        for (int w = 0; w < INPUTPATCH_BLOCK_COUNT / 32; w++)
         {
-            emit inputValueChanged(m_universe, it.key(), it.value().value, it.value().key);
+            quint32 dirtyBlocks = quint32(m_dirtyBlocks[w].fetchAndStoreOrdered(0));
+
+            while (dirtyBlocks != 0)
+            {
+                int blockIndex = w * 32 + qCountTrailingZeroBits(dirtyBlocks);
+                dirtyBlocks &= dirtyBlocks - 1;
+
+                InputBlock *block = m_blocks[blockIndex].loadAcquire();
+                if (block == NULL)
+                    continue;
+
+                for (int d = 0; d < INPUTPATCH_BLOCK_SIZE / 32; d++)
+                {
+                    quint32 dirtyChannels = quint32(block->dirty[d].fetchAndStoreOrdered(0));
+
+                    while (dirtyChannels != 0)
+                    {
+                        int index = d * 32 + qCountTrailingZeroBits(dirtyChannels);
+                        dirtyChannels &= dirtyChannels - 1;
+
+                        quint32 channel = blockIndex * INPUTPATCH_BLOCK_SIZE + index;
+                        int slot = block->values[index].loadAcquire();
+                        m_flushValues.append(ChannelValue(channel, InputValue(uchar(slot & 0xFF),
+                                                                              slotKey(channel, slot))));
+                    }
+                }
+            }
         }
-        m_inputBuffer.clear();
     }
+
+    foreach (ChannelValue const& val, m_flushValues)
+        emit inputValueChanged(m_universe, val.first, val.second.value, val.second.key);
+    m_flushValues.resize(0);
+
+    QHash<quint32, InputValue> overflow;
+    {
+        QMutexLocker overflowLocker(&m_overflowMutex);
+        if (m_overflowBuffer.isEmpty())
+            return;
+        overflow.swap(m_overflowBuffer);
+    }
+
+    for (QHash<quint32, InputValue>::const_iterator it = overflow.begin(); it != overflow.end(); ++it)
+        emit inputValueChanged(m_universe, it.key(), it.value().value, it.value().key);
 }
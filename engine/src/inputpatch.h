@@ -21,8 +21,12 @@
 #define INPUTPATCH_H
 
 #include <QObject>
-#include <QMap>
+#include <QVector>
 #include <QMutex>
+#include <QPair>
+#include <QMap>
+#include <QAtomicInt>
+#include <QAtomicPointer>
 
 #include "qlcinputprofile.h"
 
@@ -41,6 +45,11 @@ class QLCIOPlugin;
 #define KXMLQLCInputPatchInput "Input"
 #define KXMLQLCInputPatch "Patch"
 
+/** Number of channels held by a single block of input slots */
+#define INPUTPATCH_BLOCK_SIZE   512
+/** Number of blocks, covering the channels 0-65535 without locking */
+#define INPUTPATCH_BLOCK_COUNT  128
+
 /**
  * An InputPatch represents one input universe. One input universe can have
  * exactly one input line from exactly one input plugin (or none at all)
@@ -134,6 +143,7 @@ signals:
 private slots:
     void slotValueChanged(quint32 universe, quint32 input,
                           quint32 channel, uchar value, const QString& key = 0);
+    void slotFrameReceived(quint32 universe, quint32 input, const QByteArray& data);
 
 private:
     /** The reference of the plugin associated by this Input patch */
@@ -154,9 +164,51 @@ private:
 private:
     ushort m_nextPageCh, m_prevPageCh, m_pageSetCh;
 
+    /************************************************************************
+     * Input buffer
+     ************************************************************************/
 public:
+    /**
+     * Emit all the values received since the last flush, then forget them.
+     * This is called by the universe thread on every MasterTimer tick.
+     */
     void flush(quint32 universe);
 
+private:
+    /** Store the latest value of a channel until the next flush */
+    void bufferValue(quint32 channel, uchar value, const QString& key);
+
+    /** Store the channels of a frame which differ from the previous one */
+    void bufferFrame(const QByteArray& data);
+
+    /** Return the key associated to a buffered slot, if any */
+    QString slotKey(quint32 channel, int slot);
+
+private:
+    /**
+     * A block of preallocated channel slots. Each slot holds the latest
+     * value of a channel and each channel has a dirty bit, set by the
+     * plugin thread and consumed by flush(), so that the hot path is
+     * made of a few atomic operations only.
+     */
+    struct InputBlock
+    {
+        QAtomicInt values[INPUTPATCH_BLOCK_SIZE];
+        QAtomicInt dirty[INPUTPATCH_BLOCK_SIZE / 32];
+    };
+
+    /** Channel blocks, allocated the first time one of their channels changes */
+    QAtomicPointer<InputBlock> m_blocks[INPUTPATCH_BLOCK_COUNT];
+    /** One bit per block holding at least one dirty channel */
+    QAtomicInt m_dirtyBlocks[INPUTPATCH_BLOCK_COUNT / 32];
+
+    /**
+     * Keys are sent only by a few plugins (e.g. OSC paths) and never change
+     * for a given channel, so they are stored once, away from the slots.
+     */
+    QMutex m_keysMutex;
+    QHash<quint32, QString> m_keys;
+
     struct InputValue
     {
         InputValue() {}
@@ -168,8 +220,27 @@ public:
         QString key;
     };
 
-    QMutex m_inputBufferMutex;
-    QHash<quint32, InputValue> m_inputBuffer;
+    /** Fallback buffer for the channels beyond the preallocated blocks */
+    QMutex m_overflowMutex;
+    QHash<quint32, InputValue> m_overflowBuffer;
+
+    typedef QPair<quint32, InputValue> ChannelValue;
+
+    /**
+     * ON/OFF transitions (a value from or to zero) must all be emitted,
+     * in order, even when they happen between two flushes. The values
+     * they replace in the slots are queued here and emitted first, and
+     * m_transitionsMutex keeps flush() from reading the slots while a
+     * transition is in progress.
+     */
+    QMutex m_transitionsMutex;
+    QVector<ChannelValue> m_transitions;
+
+    /** The values emitted by flush(), reused on every tick */
+    QVector<ChannelValue> m_flushValues;
+
+    /** The last frame received through slotFrameReceived */
+    QByteArray m_lastFrame;
 };
 
 /** @} */
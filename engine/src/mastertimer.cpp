@@ -31,6 +31,7 @@
 #endif
 
 #include "inputoutputmap.h"
+#include "engineprofiler.h"
 #include "genericfader.h"
 #include "fadechannel.h"
 #include "mastertimer.h"
@@ -60,7 +61,9 @@ quint64 ticksCount = 0;
 MasterTimer::MasterTimer(Doc* doc)
     : QObject(doc)
     , d_ptr(new MasterTimerPrivate(this))
+    , m_tickCount(0)
     , m_stopAllFunctions(false)
+    , m_fadeOutRequest(0)
     , m_dmxSourceListMutex(QMutex::Recursive)
     , m_beatSourceType(None)
     , m_currentBPM(120)
@@ -78,6 +81,14 @@ MasterTimer::MasterTimer(Doc* doc)
         s_frequency = var.toUInt();
 
     s_tick = uint(double(1000) / double(s_frequency));
+
+    var = settings.value(ENGINEPROFILER_ENTITIES);
+    if (var.isValid() == true)
+        EngineProfiler::instance()->setCapacity(var.toInt());
+
+    var = settings.value(ENGINEPROFILER_ENABLED);
+    if (var.isValid() == true && var.toBool() == true)
+        EngineProfiler::instance()->setEnabled(true);
 }
 
 MasterTimer::~MasterTimer()
@@ -104,11 +115,21 @@ void MasterTimer::stop()
     d_ptr->stop();
 }
 
+bool MasterTimer::isRunning() const
+{
+    Q_ASSERT(d_ptr != NULL);
+    return d_ptr->isRunning();
+}
+
 void MasterTimer::timerTick()
 {
     Doc *doc = qobject_cast<Doc*> (parent());
     Q_ASSERT(doc != NULL);
 
+    EngineProfilerScope tickScope(EngineProfiler::TickStage);
+
+    m_tickCount.ref();
+
 #ifdef DEBUG_MASTERTIMER
     qDebug() << "[MasterTimer] *********** tick:" << ticksCount++ << "**********";
 #endif
@@ -146,8 +167,22 @@ void MasterTimer::timerTick()
 
     QList<Universe *> universes = doc->inputOutputMap()->claimUniverses();
 
-    timerTickFunctions(universes);
-    timerTickDMXSources(universes);
+    int fadeOut = m_fadeOutRequest.fetchAndStoreOrdered(0);
+    if (fadeOut)
+        fadeOutFunctionFaders(universes, uint(fadeOut));
+
+    {
+        EngineProfilerScope scope(EngineProfiler::FunctionsStage);
+        timerTickFunctions(universes);
+    }
+    {
+        EngineProfilerScope scope(EngineProfiler::DMXSourcesStage);
+        timerTickDMXSources(universes);
+    }
+
+    /* Render and output the universes straight from this thread. Going through
+     * a queued signal would make every DMX frame wait for the main event loop */
+    doc->inputOutputMap()->processUniverses(universes);
 
     doc->inputOutputMap()->releaseUniverses();
 
@@ -167,6 +202,11 @@ uint MasterTimer::tick()
     return s_tick;
 }
 
+quint32 MasterTimer::tickCount() const
+{
+    return quint32(m_tickCount.load());
+}
+
 /*****************************************************************************
  * Functions
  *****************************************************************************/
@@ -200,20 +240,26 @@ void MasterTimer::stopAllFunctions()
 
 void MasterTimer::fadeAndStopAll(int timeout)
 {
-    if (timeout)
+    if (timeout > 0 && isRunning())
+    {
+        /* The faders belong to the MasterTimer thread: let the next tick
+         * fade them out, before the functions are stopped */
+        m_fadeOutRequest.storeRelease(timeout);
+        while (m_fadeOutRequest.loadAcquire() != 0)
+        {
+#if defined(WIN32) || defined(Q_OS_WIN)
+            Sleep(1);
+#else
+            usleep(1000);
+#endif
+        }
+    }
+    else if (timeout > 0)
     {
         Doc *doc = qobject_cast<Doc*> (parent());
         Q_ASSERT(doc != NULL);
 
-        QList<Universe *> universes = doc->inputOutputMap()->claimUniverses();
-        foreach (Universe *universe, universes)
-        {
-            foreach (QSharedPointer<GenericFader> fader, universe->faders())
-            {
-                if (!fader.isNull() && fader->parentFunctionID() != Function::invalidId())
-                    fader->setFadeOut(true, uint(timeout));
-            }
-        }
+        fadeOutFunctionFaders(doc->inputOutputMap()->claimUniverses(), uint(timeout));
         doc->inputOutputMap()->releaseUniverses();
     }
 
@@ -221,6 +267,18 @@ void MasterTimer::fadeAndStopAll(int timeout)
     stopAllFunctions();
 }
 
+void MasterTimer::fadeOutFunctionFaders(QList<Universe *> const& universes, uint timeout)
+{
+    foreach (Universe *universe, universes)
+    {
+        foreach (QSharedPointer<GenericFader> fader, universe->faders())
+        {
+            if (!fader.isNull() && fader->parentFunctionID() != Function::invalidId())
+                fader->setFadeOut(true, timeout);
+        }
+    }
+}
+
 int MasterTimer::runningFunctions() const
 {
     return m_functionList.size();
@@ -251,7 +309,10 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
                 if (function->stopped() == false && m_stopAllFunctions == false)
                 {
                     if (firstIteration)
+                    {
+                        EngineProfilerScope scope(EngineProfiler::FunctionWriteStage, function->id());
                         function->write(this, universes);
+                    }
                 }
                 else
                 {
@@ -303,7 +364,10 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
                     functionListHasChanged = true;
                 }
                 f->preRun(this);
-                f->write(this, universes);
+                {
+                    EngineProfilerScope scope(EngineProfiler::FunctionWriteStage, f->id());
+                    f->write(this, universes);
+                }
                 emit functionStarted(f->id());
             }
 
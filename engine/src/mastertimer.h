@@ -21,6 +21,7 @@
 #ifndef MASTERTIMER_H
 #define MASTERTIMER_H
 
+#include <QAtomicInt>
 #include <QHash>
 #include <QObject>
 #include <QMutex>
@@ -67,13 +68,22 @@ public:
     /** Stop the MasterTimer */
     void stop();
 
+    /** Return true if the MasterTimer is running its ticks */
+    bool isRunning() const;
+
     /** Get the timer tick frequency in Hertz */
     static uint frequency();
 
     /** Get the length of one timer tick in milliseconds */
     static uint tick();
 
+    /** Get the number of ticks executed since the MasterTimer was created.
+     *  During a tick, this is the index of the tick being executed */
+    quint32 tickCount() const;
+
 signals:
+    /** Emitted at the end of each tick, after the Universes
+     *  have been processed */
     void tickReady();
 
 private:
@@ -90,6 +100,9 @@ private:
     /** The private reference to a MasterTimer platform dependent implementation */
     MasterTimerPrivate* d_ptr;
 
+    /** Number of ticks executed so far */
+    QAtomicInt m_tickCount;
+
     /*********************************************************************
      * Functions
      *********************************************************************/
@@ -118,6 +131,9 @@ private:
     /** Execute one timer tick for each registered Function */
     void timerTickFunctions(QList<Universe *> universes);
 
+    /** Fade out the faders of all Functions in $timeout milliseconds */
+    void fadeOutFunctionFaders(QList<Universe *> const& universes, uint timeout);
+
 private:
     /** List of currently running functions */
     QList <Function*> m_functionList;
@@ -129,6 +145,9 @@ private:
     /** Flag for stopping all functions */
     bool m_stopAllFunctions;
 
+    /** Fade out time requested by fadeAndStopAll(), consumed by the next tick */
+    QAtomicInt m_fadeOutRequest;
+
     /*************************************************************************
      * DMX Sources
      *************************************************************************/
@@ -24,6 +24,7 @@
 #   include <unistd.h>
 #endif
 
+#include "engineprofiler.h"
 #include "qlcioplugin.h"
 #include "outputpatch.h"
 
@@ -40,6 +41,11 @@ OutputPatch::OutputPatch(QObject* parent)
     , m_universe(UINT_MAX)
     , m_paused(false)
     , m_blackout(false)
+    , m_keepAliveInterval(-1)
+    , m_effectiveKeepAlive(0)
+    , m_minimumInterval(0)
+    , m_refreshRequest(0)
+    , m_changeRepeats(0)
 {
 }
 
@@ -50,6 +56,11 @@ OutputPatch::OutputPatch(quint32 universe, QObject* parent)
     , m_universe(universe)
     , m_paused(false)
     , m_blackout(false)
+    , m_keepAliveInterval(-1)
+    , m_effectiveKeepAlive(0)
+    , m_minimumInterval(0)
+    , m_refreshRequest(0)
+    , m_changeRepeats(0)
 {
 }
 
@@ -71,6 +82,9 @@ bool OutputPatch::set(QLCIOPlugin* plugin, quint32 output)
     m_plugin = plugin;
     m_pluginLine = output;
 
+    updateEffectiveKeepAlive();
+    refresh();
+
     if (m_plugin != NULL)
     {
         emit pluginNameChanged();
@@ -89,6 +103,7 @@ bool OutputPatch::reconnect()
     if (m_plugin != NULL && m_pluginLine != QLCIOPlugin::invalidLine())
     {
         m_plugin->closeOutput(m_pluginLine, m_universe);
+        refresh();
 #if defined(WIN32) || defined(Q_OS_WIN)
         Sleep(GRACE_MS);
 #else
@@ -146,6 +161,9 @@ void OutputPatch::setPluginParameter(QString prop, QVariant value)
     m_parametersCache[prop] = value;
     if (m_plugin != NULL)
         m_plugin->setParameter(m_universe, m_pluginLine, QLCIOPlugin::Output, prop, value);
+
+    /* The destination might have changed */
+    refresh();
 }
 
 QMap<QString, QVariant> OutputPatch::getPluginParameters()
@@ -196,16 +214,120 @@ void OutputPatch::dump(quint32 universe, const QByteArray& data)
     /* Don't do anything if there is no plugin and/or output line. */
     if (m_plugin != NULL && m_pluginLine != QLCIOPlugin::invalidLine())
     {
+        EngineProfilerScope scope(EngineProfiler::OutputStage, universe);
+
         if (m_paused)
         {
             if (m_pauseBuffer.isNull())
                 m_pauseBuffer.append(data);
 
-            m_plugin->writeUniverse(universe, m_pluginLine, m_pauseBuffer);
+            if (needsWrite(m_pauseBuffer))
+                m_plugin->writeUniverse(universe, m_pluginLine, m_pauseBuffer);
         }
         else
         {
-            m_plugin->writeUniverse(universe, m_pluginLine, data);
+            if (needsWrite(data))
+                m_plugin->writeUniverse(universe, m_pluginLine, data);
         }
     }
 }
+
+/*****************************************************************************
+ * Transmit policy
+ *****************************************************************************/
+
+int OutputPatch::keepAliveInterval() const
+{
+    return m_keepAliveInterval;
+}
+
+void OutputPatch::setKeepAliveInterval(int msec)
+{
+    if (msec < -1)
+        msec = -1;
+
+    if (m_keepAliveInterval == msec)
+        return;
+
+    m_keepAliveInterval = msec;
+    updateEffectiveKeepAlive();
+    refresh();
+
+    emit keepAliveIntervalChanged(m_keepAliveInterval);
+}
+
+int OutputPatch::minimumInterval() const
+{
+    return m_minimumInterval.loadAcquire();
+}
+
+void OutputPatch::setMinimumInterval(int msec)
+{
+    if (msec < 0)
+        msec = 0;
+
+    if (m_minimumInterval.loadAcquire() == msec)
+        return;
+
+    m_minimumInterval.storeRelease(msec);
+    refresh();
+
+    emit minimumIntervalChanged(msec);
+}
+
+void OutputPatch::refresh()
+{
+    m_refreshRequest.storeRelease(1);
+}
+
+void OutputPatch::updateEffectiveKeepAlive()
+{
+    if (m_keepAliveInterval >= 0)
+        m_effectiveKeepAlive.storeRelease(m_keepAliveInterval);
+    else if (m_plugin != NULL && (m_plugin->capabilities() & QLCIOPlugin::Network))
+        m_effectiveKeepAlive.storeRelease(KOutputPatchDefaultKeepAlive);
+    else
+        m_effectiveKeepAlive.storeRelease(0);
+}
+
+bool OutputPatch::needsWrite(const QByteArray &data)
+{
+    int keepAlive = m_effectiveKeepAlive.loadAcquire();
+    int minimumInterval = m_minimumInterval.loadAcquire();
+    bool refresh = m_refreshRequest.fetchAndStoreOrdered(0) != 0;
+
+    /* Write at every tick */
+    if (keepAlive == 0 && minimumInterval == 0)
+        return true;
+
+    bool changed = data.size() != m_lastWritten.size() ||
+                   memcmp(data.constData(), m_lastWritten.constData(), data.size()) != 0;
+
+    if (refresh == false && m_lastWriteTimer.isValid())
+    {
+        qint64 elapsed = m_lastWriteTimer.elapsed();
+        if (elapsed < minimumInterval)
+            return false;
+
+        if (keepAlive > 0 && elapsed < keepAlive &&
+            changed == false && m_changeRepeats == 0)
+            return false;
+    }
+
+    if (changed)
+    {
+        /* Copy the data instead of sharing it, otherwise the
+         * universe would have to reallocate its output frame */
+        m_lastWritten.resize(data.size());
+        memcpy(m_lastWritten.data(), data.constData(), data.size());
+        m_changeRepeats = KOutputPatchChangeRepeats;
+    }
+    else if (m_changeRepeats > 0)
+    {
+        m_changeRepeats--;
+    }
+
+    m_lastWriteTimer.start();
+
+    return true;
+}
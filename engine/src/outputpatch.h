@@ -20,6 +20,8 @@
 #ifndef OUTPUTPATCH_H
 #define OUTPUTPATCH_H
 
+#include <QElapsedTimer>
+#include <QAtomicInt>
 #include <QObject>
 #include <QMap>
 
@@ -36,6 +38,15 @@ class QLCIOPlugin;
 #define KXMLQLCOutputPatchPlugin "Plugin"
 #define KXMLQLCOutputPatchOutput "Output"
 
+/** Default keep-alive interval, in milliseconds, of the outputs
+ *  of plugins with the Network capability */
+#define KOutputPatchDefaultKeepAlive 1000
+
+/** Number of ticks a changed frame is written again, so a single
+ *  lost datagram doesn't leave the receivers on stale values
+ *  until the next keep-alive */
+#define KOutputPatchChangeRepeats 3
+
 class OutputPatch : public QObject
 {
     Q_OBJECT
@@ -45,6 +56,8 @@ class OutputPatch : public QObject
     Q_PROPERTY(QString pluginName READ pluginName NOTIFY pluginNameChanged)
     Q_PROPERTY(bool paused READ paused WRITE setPaused NOTIFY pausedChanged)
     Q_PROPERTY(bool blackout READ blackout WRITE setBlackout NOTIFY blackoutChanged)
+    Q_PROPERTY(int keepAliveInterval READ keepAliveInterval WRITE setKeepAliveInterval NOTIFY keepAliveIntervalChanged)
+    Q_PROPERTY(int minimumInterval READ minimumInterval WRITE setMinimumInterval NOTIFY minimumIntervalChanged)
 
     /********************************************************************
      * Initialization
@@ -129,6 +142,64 @@ private:
     QByteArray m_pauseBuffer;
     bool m_paused;
     bool m_blackout;
+
+    /********************************************************************
+     * Transmit policy
+     ********************************************************************/
+public:
+    /**
+     * Get/Set the keep-alive interval in milliseconds.
+     * When greater than zero, data is written to the plugin only when it
+     * changes (and on the KOutputPatchChangeRepeats following ticks),
+     * or when no data has been written for this amount of time.
+     * Zero writes data at every tick, while -1 (the default) selects
+     * KOutputPatchDefaultKeepAlive for plugins with the Network
+     * capability and zero for the others.
+     */
+    int keepAliveInterval() const;
+    void setKeepAliveInterval(int msec);
+
+    /**
+     * Get/Set the minimum interval in milliseconds between two writes
+     * to the plugin. Changes happening sooner are delayed. Zero (the
+     * default) doesn't limit the output rate.
+     */
+    int minimumInterval() const;
+    void setMinimumInterval(int msec);
+
+    /** Force the next dump to be written to the plugin.
+     *  This can be called from any thread */
+    void refresh();
+
+signals:
+    void keepAliveIntervalChanged(int msec);
+    void minimumIntervalChanged(int msec);
+
+private:
+    /** Update m_effectiveKeepAlive from the keep-alive
+     *  interval and the plugin capabilities */
+    void updateEffectiveKeepAlive();
+
+    /** Return true if $data must be written to the plugin now.
+     *  Called by the thread dumping the universe only */
+    bool needsWrite(const QByteArray& data);
+
+private:
+    int m_keepAliveInterval;
+
+    /** The intervals in use, set by the UI and read by dump() */
+    QAtomicInt m_effectiveKeepAlive;
+    QAtomicInt m_minimumInterval;
+
+    /** Set by refresh(), consumed by the next dump() */
+    QAtomicInt m_refreshRequest;
+
+    /** The last data written to the plugin, when, and how many more
+     *  times it has to be written since it changed. These belong to
+     *  the thread dumping the universe */
+    QByteArray m_lastWritten;
+    QElapsedTimer m_lastWriteTimer;
+    int m_changeRepeats;
 };
 
 /** @} */
@@ -39,6 +39,7 @@
 
 RGBAlgorithm::RGBAlgorithm(Doc * doc)
     : m_doc(doc)
+    , m_revision(0)
     , m_startColor(QColor())
     , m_endColor(QColor())
 {
@@ -48,6 +49,7 @@ void RGBAlgorithm::setColors(QColor start, QColor end)
 {
     m_startColor = start;
     m_endColor = end;
+    bumpRevision();
 }
 
 /****************************************************************************
@@ -26,6 +26,8 @@
 #include <QColor>
 #include <QSize>
 
+#include "rgbmap.h"
+
 class QXmlStreamReader;
 class QXmlStreamWriter;
 
@@ -35,8 +37,6 @@ class Doc;
  * @{
  */
 
-typedef QVector<QVector<uint> > RGBMap;
-
 #define KXMLQLCRGBAlgorithm "Algorithm"
 #define KXMLQLCRGBAlgorithmType "Type"
 
@@ -64,6 +64,7 @@ public:
 private:
 
     Doc * m_doc;
+    uint m_revision;
 
     /************************************************************************
      * RGB API
@@ -72,8 +73,9 @@ public:
     /** Maximum step count for rgbMap() function. */
     virtual int rgbMapStepCount(const QSize& size) = 0;
 
-    /** Get the RGBMap for the given step. */
-    virtual RGBMap rgbMap(const QSize& size, uint rgb, int step) = 0;
+    /** Render the RGBMap of the given step into $map. $map is resized to
+     *  $size, reusing its buffer when possible */
+    virtual void rgbMap(const QSize& size, uint rgb, int step, RGBMap &map) = 0;
 
     /** Release resources that may have been acquired in rgbMap() */
     virtual void postRun() {}
@@ -90,6 +92,23 @@ public:
     /** Get the algorithm's type */
     virtual Type type() const = 0;
 
+    /** Return true if rgbMap() is a pure function of its arguments and of
+     *  the algorithm properties, so its frames can be cached */
+    virtual bool isCacheable() const { return false; }
+
+    /** Return true if the frames of a clone of the algorithm can be
+     *  rendered ahead of time in a worker thread */
+    virtual bool isPrefillable() const { return isCacheable(); }
+
+    /** Return the revision of the algorithm properties. It changes every
+     *  time a property that affects rgbMap() is changed */
+    uint revision() const { return m_revision; }
+
+protected:
+    /** Signal that a property affecting rgbMap() has been changed */
+    void bumpRevision() { m_revision++; }
+
+public:
     /** Return if the algorithm accepts/needs colors:
      *  0 = colors not accepted (e.g. the algorithm will generate them on its own)
      *  1 = only start color is accepted
@@ -121,7 +121,7 @@ int RGBAudio::rgbMapStepCount(const QSize& size)
     return 1;
 }
 
-RGBMap RGBAudio::rgbMap(const QSize& size, uint rgb, int step)
+void RGBAudio::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
 {
     Q_UNUSED(step);
 
@@ -131,12 +131,8 @@ RGBMap RGBAudio::rgbMap(const QSize& size, uint rgb, int step)
     if (capture.data() != m_audioInput)
         setAudioCapture(capture.data());
 
-    RGBMap map(size.height());
-    for (int y = 0; y < size.height(); y++)
-    {
-        map[y].resize(size.width());
-        map[y].fill(0);
-    }
+    map.resize(size);
+    map.fill(0);
 
     // on the first round, just set the proper number of
     // spectrum bands to receive
@@ -145,13 +141,13 @@ RGBMap RGBAudio::rgbMap(const QSize& size, uint rgb, int step)
         m_bandsNumber = size.width();
         qDebug() << "[RGBAudio] set" << m_bandsNumber << "bars";
         m_audioInput->registerBandsNumber(m_bandsNumber);
-        return map;
+        return;
     }
     if (m_barColors.count() == 0)
         calculateColors(size.height());
 
     double volHeight = (m_volumePower * size.height()) / 0x7FFF;
-    for (int x = 0; x < m_spectrumValues.count(); x++)
+    for (int x = 0; x < m_spectrumValues.count() && x < size.width(); x++)
     {
         int barHeight;
         if (m_maxMagnitude == 0)
@@ -170,8 +166,6 @@ RGBMap RGBAudio::rgbMap(const QSize& size, uint rgb, int step)
                 map[y][x] = m_barColors.at(y);
         }
     }
-
-    return map;
 }
 
 void RGBAudio::postRun()
@@ -73,6 +73,7 @@ void RGBImage::setFilename(const QString& filename)
 {
     m_filename = filename;
     reloadImage();
+    bumpRevision();
 }
 
 QString RGBImage::filename() const
@@ -101,6 +102,7 @@ void RGBImage::setImageData(int width, int height, const QByteArray &pixelData)
         }
     }
     m_image = newImg;
+    bumpRevision();
 }
 
 bool RGBImage::animatedSource() const
@@ -147,6 +149,7 @@ void RGBImage::setAnimationStyle(RGBImage::AnimationStyle ani)
         m_animationStyle = ani;
     else
         m_animationStyle = Static;
+    bumpRevision();
 }
 
 RGBImage::AnimationStyle RGBImage::animationStyle() const
@@ -195,6 +198,7 @@ QStringList RGBImage::animationStyles()
 void RGBImage::setXOffset(int offset)
 {
     m_xOffset = offset;
+    bumpRevision();
 }
 
 int RGBImage::xOffset() const
@@ -205,6 +209,7 @@ int RGBImage::xOffset() const
 void RGBImage::setYOffset(int offset)
 {
     m_yOffset = offset;
+    bumpRevision();
 }
 
 int RGBImage::yOffset() const
@@ -235,14 +240,17 @@ int RGBImage::rgbMapStepCount(const QSize& size)
     }
 }
 
-RGBMap RGBImage::rgbMap(const QSize& size, uint rgb, int step)
+void RGBImage::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
 {
     Q_UNUSED(rgb);
 
     QMutexLocker locker(&m_mutex);
 
     if (m_animatedSource == false && (m_image.width() == 0 || m_image.height() == 0))
-        return RGBMap();
+    {
+        map.resize(QSize());
+        return;
+    }
 
     int xOffs = xOffset();
     int yOffs = yOffset();
@@ -269,22 +277,20 @@ RGBMap RGBImage::rgbMap(const QSize& size, uint rgb, int step)
         m_image = m_animatedPlayer.currentImage().scaled(size);
     }
 
-    RGBMap map(size.height());
+    map.resize(size);
     for (int y = 0; y < size.height(); y++)
     {
-        map[y].resize(size.width());
+        uint *line = map.scanLine(y);
+        int y1 = (y + yOffs) % m_image.height();
         for (int x = 0; x < size.width(); x++)
         {
             int x1 = (x + xOffs) % m_image.width();
-            int y1 = (y + yOffs) % m_image.height();
 
-            map[y][x] = m_image.pixel(x1,y1);
-            if (qAlpha(map[y][x]) == 0)
-                map[y][x] = 0;
+            line[x] = m_image.pixel(x1,y1);
+            if (qAlpha(line[x]) == 0)
+                line[x] = 0;
         }
     }
-
-    return map;
 }
 
 QString RGBImage::name() const
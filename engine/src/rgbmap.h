@@ -0,0 +1,109 @@
+/*
+  Q Light Controller Plus
+  rgbmap.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef RGBMAP_H
+#define RGBMAP_H
+
+#include <QVector>
+#include <QSize>
+
+/** @addtogroup engine_functions Functions
+ * @{
+ */
+
+/**
+ * RGBMap is a frame of an RGB algorithm: width * height pixels stored
+ * row after row in a single buffer.
+ *
+ * The buffer is implicitly shared, so maps can be copied around (for
+ * example into a frame cache) without copying the pixels. A map owned by
+ * a single user keeps its buffer when it is resized to the same or a
+ * smaller size, so it can be rendered into again and again without
+ * allocating.
+ */
+class RGBMap
+{
+public:
+    RGBMap()
+        : m_width(0)
+        , m_height(0)
+    {
+    }
+
+    explicit RGBMap(const QSize& size, uint rgb = 0)
+        : m_width(qMax(0, size.width()))
+        , m_height(qMax(0, size.height()))
+        , m_pixels(m_width * m_height, rgb)
+    {
+    }
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    QSize size() const { return QSize(m_width, m_height); }
+
+    /** Return true if the map has no pixels */
+    bool isEmpty() const { return m_pixels.isEmpty(); }
+
+    /** Resize the map to $size. The pixels content is undefined after
+     *  a resize. The buffer is reused when it's big enough */
+    void resize(const QSize& size)
+    {
+        m_width = qMax(0, size.width());
+        m_height = qMax(0, size.height());
+        m_pixels.resize(m_width * m_height);
+    }
+
+    /** Set every pixel to $rgb */
+    void fill(uint rgb) { m_pixels.fill(rgb); }
+
+    uint pixel(int x, int y) const { return m_pixels.at(y * m_width + x); }
+    void setPixel(int x, int y, uint rgb) { m_pixels[y * m_width + x] = rgb; }
+
+    /** Return a pointer to the first pixel of row $y */
+    uint *scanLine(int y) { return m_pixels.data() + y * m_width; }
+    const uint *constScanLine(int y) const { return m_pixels.constData() + y * m_width; }
+
+    /** Row access, so pixels can be addressed as map[y][x] */
+    uint *operator[](int y) { return scanLine(y); }
+    const uint *operator[](int y) const { return constScanLine(y); }
+
+    /** Return the whole pixel buffer */
+    uint *data() { return m_pixels.data(); }
+    const uint *constData() const { return m_pixels.constData(); }
+
+    bool operator==(const RGBMap& other) const
+    {
+        return m_width == other.m_width && m_height == other.m_height &&
+               m_pixels == other.m_pixels;
+    }
+
+    bool operator!=(const RGBMap& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    int m_width;
+    int m_height;
+    QVector<uint> m_pixels;
+};
+
+/** @} */
+
+#endif
@@ -0,0 +1,197 @@
+/*
+  Q Light Controller Plus
+  rgbmapcache.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QThreadPool>
+#include <QRunnable>
+#include <QDebug>
+
+#include "rgbmapcache.h"
+
+uint qHash(const RGBMapCache::Key& key, uint seed)
+{
+    return qHash(key.step, seed) ^ qHash(key.rgb, seed) ^
+           qHash((key.size.width() << 16) | key.size.height(), seed);
+}
+
+/****************************************************************************
+ * Prefill task
+ ****************************************************************************/
+
+class RGBMapCache::PrefillTask : public QRunnable
+{
+public:
+    PrefillTask(QSharedPointer<RGBMapCache> cache, RGBAlgorithm *algorithm,
+                const QSize& size, uint rgb, int steps)
+        : m_cache(cache)
+        , m_algorithm(algorithm)
+        , m_size(size)
+        , m_rgb(rgb)
+        , m_steps(steps)
+        , m_generation(cache->m_generation.loadAcquire())
+    {
+    }
+
+    ~PrefillTask()
+    {
+        delete m_algorithm;
+    }
+
+    void run()
+    {
+        for (int step = 0; step < m_steps; step++)
+        {
+            RGBMap map;
+            if (m_cache->lookup(m_size, m_rgb, step, map))
+                continue;
+
+            m_algorithm->rgbMap(m_size, m_rgb, step, map);
+
+            /* Stop when the cache has been cleared or it is full */
+            if (m_cache->insert(m_size, m_rgb, step, map, m_generation) == false)
+                break;
+        }
+
+        m_algorithm->postRun();
+    }
+
+private:
+    QSharedPointer<RGBMapCache> m_cache;
+    RGBAlgorithm *m_algorithm;
+    QSize m_size;
+    uint m_rgb;
+    int m_steps;
+    int m_generation;
+};
+
+/****************************************************************************
+ * Initialization
+ ****************************************************************************/
+
+RGBMapCache::RGBMapCache(qint64 budget)
+    : m_budget(budget)
+    , m_usage(0)
+    , m_revision(0)
+    , m_generation(0)
+{
+}
+
+RGBMapCache::~RGBMapCache()
+{
+}
+
+qint64 RGBMapCache::budget() const
+{
+    return m_budget;
+}
+
+qint64 RGBMapCache::usage() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_usage;
+}
+
+int RGBMapCache::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_frames.count();
+}
+
+/****************************************************************************
+ * Frames
+ ****************************************************************************/
+
+bool RGBMapCache::lookup(const QSize& size, uint rgb, int step, RGBMap& map) const
+{
+    Key key = { size, rgb, step };
+
+    QMutexLocker locker(&m_mutex);
+    QHash<Key, RGBMap>::const_iterator it = m_frames.constFind(key);
+    if (it == m_frames.constEnd())
+        return false;
+
+    map = it.value();
+    return true;
+}
+
+void RGBMapCache::insert(const QSize& size, uint rgb, int step, const RGBMap& map)
+{
+    insert(size, rgb, step, map, m_generation.loadAcquire());
+}
+
+bool RGBMapCache::insert(const QSize& size, uint rgb, int step, const RGBMap& map, int generation)
+{
+    Key key = { size, rgb, step };
+    qint64 bytes = mapBytes(map);
+
+    QMutexLocker locker(&m_mutex);
+
+    if (generation != m_generation.loadAcquire())
+        return false;
+
+    if (m_frames.contains(key))
+        return true;
+
+    if (m_usage + bytes > m_budget)
+        return false;
+
+    m_frames.insert(key, map);
+    m_usage += bytes;
+
+    return true;
+}
+
+void RGBMapCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_generation.fetchAndAddOrdered(1);
+    m_frames.clear();
+    m_usage = 0;
+}
+
+void RGBMapCache::setRevision(uint revision)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (revision == m_revision)
+            return;
+        m_revision = revision;
+    }
+    clear();
+}
+
+qint64 RGBMapCache::mapBytes(const RGBMap& map)
+{
+    return sizeof(RGBMap) + qint64(map.width()) * map.height() * sizeof(uint);
+}
+
+/****************************************************************************
+ * Prefill
+ ****************************************************************************/
+
+void RGBMapCache::prefill(QSharedPointer<RGBMapCache> cache, RGBAlgorithm *algorithm,
+                          const QSize& size, uint rgb, int steps)
+{
+    if (cache.isNull() || algorithm == NULL)
+    {
+        delete algorithm;
+        return;
+    }
+
+    QThreadPool::globalInstance()->start(new PrefillTask(cache, algorithm, size, rgb, steps));
+}
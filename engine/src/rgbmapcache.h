@@ -0,0 +1,124 @@
+/*
+  Q Light Controller Plus
+  rgbmapcache.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef RGBMAPCACHE_H
+#define RGBMAPCACHE_H
+
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QHash>
+#include <QSize>
+
+#include "rgbalgorithm.h"
+
+/** @addtogroup engine_functions Functions
+ * @{
+ */
+
+/** Default memory budget of a cache, in bytes */
+#define RGBMAPCACHE_DEFAULT_BUDGET (4 * 1024 * 1024)
+
+/**
+ * RGBMapCache holds the frames rendered by a cacheable RGBAlgorithm,
+ * keyed on (size, color, step). The algorithm properties are not part of
+ * the key: the owner must clear the cache when they change.
+ *
+ * The cache is bounded by a memory budget. When the budget is exhausted,
+ * new frames are simply not stored: with the cyclic access pattern of a
+ * looping matrix, keeping the first frames is better than evicting the
+ * ones that are about to be needed again.
+ *
+ * Frames can be rendered ahead of time by prefill(), which runs a clone
+ * of the algorithm in the global thread pool.
+ */
+class RGBMapCache
+{
+public:
+    RGBMapCache(qint64 budget = RGBMAPCACHE_DEFAULT_BUDGET);
+    ~RGBMapCache();
+
+    /** Get the memory budget, in bytes */
+    qint64 budget() const;
+
+    /** Get the memory currently used by the cached frames, in bytes */
+    qint64 usage() const;
+
+    /** Get the number of cached frames */
+    int count() const;
+
+    /** Look up the frame for ($size, $rgb, $step). Return true and set
+     *  $map if the frame is cached */
+    bool lookup(const QSize& size, uint rgb, int step, RGBMap& map) const;
+
+    /** Store $map as the frame for ($size, $rgb, $step). Frames exceeding
+     *  the budget are dropped */
+    void insert(const QSize& size, uint rgb, int step, const RGBMap& map);
+
+    /** Forget every frame and cancel a running prefill */
+    void clear();
+
+    /** Tie the cache to the revision of the algorithm it holds frames of.
+     *  The cache is cleared if $revision is different from the last one */
+    void setRevision(uint revision);
+
+    /**
+     * Render $steps frames of $size and $rgb in a background thread.
+     * The cache takes ownership of $algorithm, that must be a clone not
+     * used anywhere else.
+     */
+    static void prefill(QSharedPointer<RGBMapCache> cache, RGBAlgorithm *algorithm,
+                        const QSize& size, uint rgb, int steps);
+
+private:
+    /** Store a frame only if the cache has not been cleared since $generation */
+    bool insert(const QSize& size, uint rgb, int step, const RGBMap& map, int generation);
+
+    /** Return the memory taken by $map */
+    static qint64 mapBytes(const RGBMap& map);
+
+private:
+    struct Key
+    {
+        QSize size;
+        uint rgb;
+        int step;
+
+        bool operator==(const Key& other) const
+        {
+            return step == other.step && rgb == other.rgb && size == other.size;
+        }
+    };
+
+    friend uint qHash(const Key& key, uint seed);
+
+    class PrefillTask;
+
+    mutable QMutex m_mutex;
+    QHash<Key, RGBMap> m_frames;
+    qint64 m_budget;
+    qint64 m_usage;
+    uint m_revision;
+    /** Incremented on every clear, to discard the frames of stale prefills */
+    QAtomicInt m_generation;
+};
+
+/** @} */
+
+#endif
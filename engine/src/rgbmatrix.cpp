@@ -34,6 +34,7 @@
 #include "qlcmacros.h"
 #include "rgbaudio.h"
 #include "rgbscriptscache.h"
+#include "rgbmapcache.h"
 #include "doc.h"
 
 #define KXMLQLCRGBMatrixStartColor "MonoColor"
@@ -56,22 +57,30 @@ RGBMatrix::RGBMatrix(Doc* doc)
     , m_group(NULL)
     , m_algorithm(NULL)
     , m_algorithmMutex(QMutex::Recursive)
+    , m_mapCache(new RGBMapCache())
     , m_startColor(Qt::red)
     , m_endColor(QColor())
     , m_stepHandler(new RGBMatrixStep())
     , m_roundTime(new QElapsedTimer())
     , m_stepsCount(0)
     , m_stepBeatDuration(0)
+    , m_compiledHeadsDirty(true)
 {
     setName(tr("New RGB Matrix"));
     setDuration(500);
 
+    connect(doc, SIGNAL(fixtureGroupChanged(quint32)), this, SLOT(slotFixtureGroupChanged(quint32)));
+    connect(doc, SIGNAL(fixtureChanged(quint32)), this, SLOT(slotFixtureChanged(quint32)));
+    connect(doc, SIGNAL(fixtureRemoved(quint32)), this, SLOT(slotFixtureChanged(quint32)));
+
     RGBScript scr = doc->rgbScriptsCache()->script("Stripes");
     setAlgorithm(scr.clone());
 }
 
 RGBMatrix::~RGBMatrix()
 {
+    // Stop a running prefill as soon as possible
+    m_mapCache->clear();
     delete m_algorithm;
     delete m_roundTime;
     delete m_stepHandler;
@@ -178,6 +187,7 @@ void RGBMatrix::setFixtureGroup(quint32 id)
     {
         QMutexLocker algoLocker(&m_algorithmMutex);
         m_group = doc()->fixtureGroup(m_fixtureGroupID);
+        m_compiledHeadsDirty = true;
     }
     m_stepsCount = stepsCount();
 }
@@ -200,6 +210,7 @@ void RGBMatrix::setAlgorithm(RGBAlgorithm* algo)
         QMutexLocker algorithmLocker(&m_algorithmMutex);
         delete m_algorithm;
         m_algorithm = algo;
+        m_mapCache->clear();
 
         /** If there's been a change of Script algorithm "on the fly",
          *  then re-apply the properties currently set in this RGBMatrix */
@@ -249,20 +260,40 @@ int RGBMatrix::stepsCount()
     return 0;
 }
 
-RGBMap RGBMatrix::previewMap(int step, RGBMatrixStep *handler)
+void RGBMatrix::previewMap(int step, RGBMatrixStep *handler, RGBMap &map)
 {
-    RGBMap map;
     QMutexLocker algorithmLocker(&m_algorithmMutex);
     if (m_algorithm == NULL || handler == NULL)
-        return map;
+    {
+        map.resize(QSize());
+        return;
+    }
 
     if (m_group == NULL)
         m_group = doc()->fixtureGroup(fixtureGroup());
 
     if (m_group != NULL)
-        map = m_algorithm->rgbMap(m_group->size(), handler->stepColor().rgb(), step);
+        algorithmMap(m_group->size(), handler->stepColor().rgb(), step, map);
+    else
+        map.resize(QSize());
+}
+
+void RGBMatrix::algorithmMap(const QSize& size, uint rgb, int step, RGBMap &map)
+{
+    if (m_algorithm->isCacheable() == false)
+    {
+        m_algorithm->rgbMap(size, rgb, step, map);
+        return;
+    }
+
+    // Changed properties make the cached frames stale
+    m_mapCache->setRevision(m_algorithm->revision());
 
-    return map;
+    if (m_mapCache->lookup(size, rgb, step, map))
+        return;
+
+    m_algorithm->rgbMap(size, rgb, step, map);
+    m_mapCache->insert(size, rgb, step, map);
 }
 
 /****************************************************************************
@@ -502,6 +533,8 @@ void RGBMatrix::preRun(MasterTimer *timer)
             return;
         }
 
+        compileHeads(m_group);
+
         if (m_algorithm != NULL)
         {
             //Q_ASSERT(m_fader == NULL);
@@ -522,6 +555,17 @@ void RGBMatrix::preRun(MasterTimer *timer)
                     script->setProperty(it.key(), it.value());
                 }
             }
+
+            /* Render the frames of the first round in the background, so
+             * a looping matrix doesn't have to run the algorithm anymore.
+             * Frames with a different color are rendered when needed */
+            if (m_algorithm->isPrefillable())
+            {
+                m_mapCache->setRevision(m_algorithm->revision());
+                if (m_mapCache->count() < m_stepsCount)
+                    RGBMapCache::prefill(m_mapCache, m_algorithm->clone(), m_group->size(),
+                                         m_stepHandler->stepColor().rgb(), m_stepsCount);
+            }
         }
     }
 
@@ -560,8 +604,9 @@ void RGBMatrix::write(MasterTimer *timer, QList<Universe *> universes)
                     m_stepBeatDuration = beatsToTime(duration(), timer->beatTimeDuration());
 
                 //qDebug() << "RGBMatrix step" << m_stepHandler->currentStepIndex() << ", color:" << QString::number(m_stepHandler->stepColor().rgb(), 16);
-                RGBMap map = m_algorithm->rgbMap(m_group->size(), m_stepHandler->stepColor().rgb(), m_stepHandler->currentStepIndex());
-                updateMapChannels(map, m_group, universes);
+                algorithmMap(m_group->size(), m_stepHandler->stepColor().rgb(),
+                             m_stepHandler->currentStepIndex(), m_stepMap);
+                updateMapChannels(m_stepMap, m_group, universes);
             }
         }
     }
@@ -637,6 +682,11 @@ void RGBMatrix::postRun(MasterTimer *timer, QList<Universe *> universes)
 
     {
         QMutexLocker algorithmLocker(&m_algorithmMutex);
+
+        // the cached fade channels belong to the faders just dismissed
+        for (int i = 0; i < m_compiledHeads.count(); i++)
+            m_compiledHeads[i].fader = NULL;
+
         if (m_algorithm != NULL)
             m_algorithm->postRun();
     }
@@ -661,7 +711,7 @@ void RGBMatrix::roundCheck()
         roundElapsed(duration());
 }
 
-FadeChannel *RGBMatrix::getFader(QList<Universe *> universes, quint32 universeID, quint32 fixtureID, quint32 channel)
+QSharedPointer<GenericFader> RGBMatrix::getUniverseFader(QList<Universe *> universes, quint32 universeID)
 {
     // get the universe Fader first. If doesn't exist, create it
     QSharedPointer<GenericFader> fader = m_fadersMap.value(universeID, QSharedPointer<GenericFader>());
@@ -672,10 +722,13 @@ FadeChannel *RGBMatrix::getFader(QList<Universe *> universes, quint32 universeID
         fader->setBlendMode(blendMode());
         fader->setName(name());
         fader->setParentFunctionID(id());
+        // channels are written through the pointers cached in m_compiledHeads,
+        // so don't let the fader drop them when they go dark
+        fader->setKeepZeroChannels(true);
         m_fadersMap[universeID] = fader;
     }
 
-    return fader->getChannelFader(doc(), universes[universeID], fixtureID, channel);
+    return fader;
 }
 
 void RGBMatrix::updateFaderValues(FadeChannel *fc, uchar value, uint fadeTime)
@@ -691,11 +744,16 @@ void RGBMatrix::updateFaderValues(FadeChannel *fc, uchar value, uint fadeTime)
         fc->setFadeTime(fadeTime);
 }
 
-void RGBMatrix::updateMapChannels(const RGBMap& map, const FixtureGroup *grp, QList<Universe *> universes)
+void RGBMatrix::compileHeads(const FixtureGroup *grp)
 {
-    uint fadeTime = (overrideFadeInSpeed() == defaultSpeed()) ? fadeInSpeed() : overrideFadeInSpeed();
+    m_compiledHeads.clear();
+    m_compiledHeadsDirty = false;
+
+    if (grp == NULL)
+        return;
+
+    m_compiledHeads.reserve(grp->headsMap().count());
 
-    // Create/modify fade channels for ALL heads in the group
     QMapIterator<QLCPoint, GroupHead> it(grp->headsMap());
     while (it.hasNext())
     {
@@ -730,66 +788,161 @@ void RGBMatrix::updateMapChannels(const RGBMap& map, const FixtureGroup *grp, QL
         //
         // *least important - per head dimmer if present,
         // otherwise per fixture dimmer if present
-        QVector <quint32> dim;
+        CompiledHead compiled;
+        compiled.x = pt.x();
+        compiled.y = pt.y();
+        compiled.universe = fxi->universe();
+        compiled.fixture = grpHead.fxi;
+        compiled.dimmersCount = 0;
+        compiled.fader = NULL;
+        compiled.generation = 0;
+        compiled.dimmersResolved = false;
+
         if (masterDim != QLCChannel::invalid())
-            dim << masterDim;
+            compiled.dimmers[compiled.dimmersCount++] = masterDim;
 
         if (headDim != QLCChannel::invalid())
-            dim << headDim;
-
-        if (pt.y() >= map.count() || pt.x() >= map[pt.y()].count())
-            continue;
-
-        uint col = map[pt.y()][pt.x()];
+            compiled.dimmers[compiled.dimmersCount++] = headDim;
 
         if (rgb.size() == 3)
         {
-            // RGB color mixing
-            FadeChannel *fc = getFader(universes, fxi->universe(), grpHead.fxi, rgb.at(0));
-            updateFaderValues(fc, qRed(col), fadeTime);
-
-            fc = getFader(universes, fxi->universe(), grpHead.fxi, rgb.at(1));
-            updateFaderValues(fc, qGreen(col), fadeTime);
-
-            fc = getFader(universes, fxi->universe(), grpHead.fxi, rgb.at(2));
-            updateFaderValues(fc, qBlue(col), fadeTime);
+            compiled.mixing = CompiledHead::RGBMixing;
+            for (int i = 0; i < 3; i++)
+                compiled.color[i] = rgb.at(i);
         }
         else if (cmy.size() == 3)
         {
-            // CMY color mixing
-            QColor cmyCol(col);
+            compiled.mixing = CompiledHead::CMYMixing;
+            for (int i = 0; i < 3; i++)
+                compiled.color[i] = cmy.at(i);
+        }
+        else if (compiled.dimmersCount > 0)
+        {
+            compiled.mixing = CompiledHead::GrayMixing;
+            compiled.color[0] = compiled.dimmers[--compiled.dimmersCount];
+        }
+        else
+        {
+            compiled.mixing = CompiledHead::NoMixing;
+        }
 
-            FadeChannel *fc = getFader(universes, fxi->universe(), grpHead.fxi, cmy.at(0));
-            updateFaderValues(fc, cmyCol.cyan(), fadeTime);
+        m_compiledHeads.append(compiled);
+    }
+}
 
-            fc = getFader(universes, fxi->universe(), grpHead.fxi, cmy.at(1));
-            updateFaderValues(fc, cmyCol.magenta(), fadeTime);
+void RGBMatrix::updateMapChannels(const RGBMap& map, const FixtureGroup *grp, QList<Universe *> universes)
+{
+    uint fadeTime = (overrideFadeInSpeed() == defaultSpeed()) ? fadeInSpeed() : overrideFadeInSpeed();
+
+    if (m_compiledHeadsDirty)
+        compileHeads(grp);
+
+    // Create/modify fade channels for ALL heads in the group.
+    // The universe fader is looked up again only when the universe
+    // changes from one head to the next
+    QSharedPointer<GenericFader> fader;
+    Universe *universe = NULL;
+    quint32 faderUniverse = Universe::invalid();
 
-            fc = getFader(universes, fxi->universe(), grpHead.fxi, cmy.at(2));
-            updateFaderValues(fc, cmyCol.yellow(), fadeTime);
+    for (int i = 0; i < m_compiledHeads.count(); i++)
+    {
+        CompiledHead &head = m_compiledHeads[i];
+
+        if (head.y >= map.height() || head.x >= map.width())
+            continue;
+
+        if (head.universe != faderUniverse)
+        {
+            fader = getUniverseFader(universes, head.universe);
+            universe = universes[head.universe];
+            faderUniverse = head.universe;
         }
-        else if (!dim.empty())
+
+        // Resolve the fade channels of the head only when the fader
+        // has been replaced or has dropped some of its channels
+        if (head.fader != fader.data() ||
+            head.generation != fader->channelsGeneration() ||
+            (m_dimmerControl && head.dimmersResolved == false))
         {
-            // Set dimmer to value of the color (e.g. for PARs)
-            FadeChannel *fc = getFader(universes, fxi->universe(), grpHead.fxi, dim.last());
-            // the weights are taken from
-            // https://en.wikipedia.org/wiki/YUV#SDTV_with_BT.601
-            updateFaderValues(fc, 0.299 * qRed(col) + 0.587 * qGreen(col) + 0.114 * qBlue(col), fadeTime);
-            dim.pop_back();
+            int colors = head.mixing == CompiledHead::GrayMixing ? 1 :
+                         head.mixing == CompiledHead::NoMixing ? 0 : 3;
+            for (int c = 0; c < colors; c++)
+                head.colorFaders[c] = fader->getChannelFader(doc(), universe, head.fixture, head.color[c]);
+
+            head.dimmersResolved = m_dimmerControl;
+            if (m_dimmerControl)
+            {
+                for (int d = 0; d < head.dimmersCount; d++)
+                    head.dimmerFaders[d] = fader->getChannelFader(doc(), universe, head.fixture, head.dimmers[d]);
+            }
+
+            head.fader = fader.data();
+            head.generation = fader->channelsGeneration();
         }
 
-        if (m_dimmerControl)
+        uint col = map.pixel(head.x, head.y);
+
+        switch (head.mixing)
         {
-            // Set the rest of the dimmer channels to full on
-            foreach(quint32 ch, dim)
+            case CompiledHead::RGBMixing:
             {
-                FadeChannel *fc = getFader(universes, fxi->universe(), grpHead.fxi, ch);
-                updateFaderValues(fc, col == 0 ? 0 : 255, fadeTime);
+                // RGB color mixing
+                updateFaderValues(head.colorFaders[0], qRed(col), fadeTime);
+                updateFaderValues(head.colorFaders[1], qGreen(col), fadeTime);
+                updateFaderValues(head.colorFaders[2], qBlue(col), fadeTime);
             }
+            break;
+            case CompiledHead::CMYMixing:
+            {
+                // CMY color mixing
+                QColor cmyCol(col);
+
+                updateFaderValues(head.colorFaders[0], cmyCol.cyan(), fadeTime);
+                updateFaderValues(head.colorFaders[1], cmyCol.magenta(), fadeTime);
+                updateFaderValues(head.colorFaders[2], cmyCol.yellow(), fadeTime);
+            }
+            break;
+            case CompiledHead::GrayMixing:
+            {
+                // Set dimmer to value of the color (e.g. for PARs)
+                // the weights are taken from
+                // https://en.wikipedia.org/wiki/YUV#SDTV_with_BT.601
+                updateFaderValues(head.colorFaders[0],
+                                  0.299 * qRed(col) + 0.587 * qGreen(col) + 0.114 * qBlue(col), fadeTime);
+            }
+            break;
+            case CompiledHead::NoMixing:
+            break;
+        }
+
+        if (m_dimmerControl)
+        {
+            // Set the rest of the dimmer channels to full on
+            for (int d = 0; d < head.dimmersCount; d++)
+                updateFaderValues(head.dimmerFaders[d], col == 0 ? 0 : 255, fadeTime);
         }
     }
 }
 
+void RGBMatrix::slotFixtureGroupChanged(quint32 id)
+{
+    if (id != m_fixtureGroupID)
+        return;
+
+    QMutexLocker algorithmLocker(&m_algorithmMutex);
+    m_compiledHeadsDirty = true;
+}
+
+void RGBMatrix::slotFixtureChanged(quint32 id)
+{
+    Q_UNUSED(id)
+
+    /* Addresses or heads might have changed. This is rare enough
+     * to simply compile the heads again */
+    QMutexLocker algorithmLocker(&m_algorithmMutex);
+    m_compiledHeadsDirty = true;
+}
+
 /*********************************************************************
  * Attributes
  *********************************************************************/
@@ -41,6 +41,7 @@ class QElapsedTimer;
 class FixtureGroup;
 class GenericFader;
 class FadeChannel;
+class RGBMapCache;
 class QDir;
 
 /** @addtogroup engine_functions Functions
@@ -164,12 +165,20 @@ public:
     /** Get the number of steps of the current algorithm */
     int stepsCount();
 
-    /** Get the preview of the current algorithm at the given step */
-    RGBMap previewMap(int step, RGBMatrixStep *handler);
+    /** Render the preview of the current algorithm at the given step into $map */
+    void previewMap(int step, RGBMatrixStep *handler, RGBMap &map);
+
+private:
+    /** Get the map of the current algorithm for ($size, $rgb, $step), out of
+     *  the frame cache if the algorithm is cacheable. Call with m_algorithmMutex locked */
+    void algorithmMap(const QSize& size, uint rgb, int step, RGBMap &map);
 
 private:
     RGBAlgorithm *m_algorithm;
     QMutex m_algorithmMutex;
+    /** The frames rendered by a cacheable algorithm. Shared with the
+     *  background prefill tasks */
+    QSharedPointer<RGBMapCache> m_mapCache;
 
     /************************************************************************
      * Color
@@ -232,13 +241,58 @@ private:
     /** Check what should be done when elapsed() >= duration() */
     void roundCheck();
 
-    FadeChannel *getFader(QList<Universe *> universes, quint32 universeID, quint32 fixtureID, quint32 channel);
+    /** Get the fader of this matrix on the given universe. Create it if needed */
+    QSharedPointer<GenericFader> getUniverseFader(QList<Universe *> universes, quint32 universeID);
+
     void updateFaderValues(FadeChannel *fc, uchar value, uint fadeTime);
 
     /** Update FadeChannels when $map has changed since last time */
     void updateMapChannels(const RGBMap& map, const FixtureGroup* grp, QList<Universe *> universes);
 
+    /** A group head, resolved into the channels the matrix controls */
+    struct CompiledHead
+    {
+        enum ColorMixing { RGBMixing, CMYMixing, GrayMixing, NoMixing };
+
+        /** Position of the head in the RGBMap */
+        int x, y;
+        quint32 universe;
+        quint32 fixture;
+        ColorMixing mixing;
+        /** The RGB/CMY channels, or the dimmer used for grayscale in [0] */
+        quint32 color[3];
+        /** Dimmers set to full when dimmer control is enabled */
+        quint32 dimmers[2];
+        int dimmersCount;
+
+        /** The fade channels of color[] and dimmers[], valid as long as
+         *  $fader is the universe fader and its channels generation
+         *  is still $generation */
+        GenericFader *fader;
+        uint generation;
+        bool dimmersResolved;
+        FadeChannel *colorFaders[3];
+        FadeChannel *dimmerFaders[2];
+    };
+
+    /** Resolve the heads of $grp into m_compiledHeads, so every step
+     *  doesn't need to look up fixtures and heads again */
+    void compileHeads(const FixtureGroup *grp);
+
+private slots:
+    /** Invalidate the compiled heads when the group or its fixtures change */
+    void slotFixtureGroupChanged(quint32 id);
+    void slotFixtureChanged(quint32 id);
+
 private:
+    /** The group heads, compiled when the matrix starts or the group changes */
+    QVector<CompiledHead> m_compiledHeads;
+    /** Flag raised when m_compiledHeads must be built again */
+    bool m_compiledHeadsDirty;
+
+    /** The map of the current step, reused across steps */
+    RGBMap m_stepMap;
+
     /** Reference to a timer counting the time in ms between steps */
     QElapsedTimer *m_roundTime;
 
@@ -56,17 +56,11 @@ int RGBPlain::rgbMapStepCount(const QSize& size)
     return 1;
 }
 
-RGBMap RGBPlain::rgbMap(const QSize& size, uint rgb, int step)
+void RGBPlain::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
 {
     Q_UNUSED(step)
-    RGBMap map(size.height());
-    for (int y = 0; y < size.height(); y++)
-    {
-        map[y].resize(size.width());
-        map[y].fill(rgb);
-    }
-
-    return map;
+    map.resize(size);
+    map.fill(rgb);
 }
 
 QString RGBPlain::name() const
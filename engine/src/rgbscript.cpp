@@ -23,6 +23,7 @@
 #include <QScriptEngine>
 #include <QScriptValue>
 #include <QStringList>
+#include <QThread>
 #include <QMutex>
 #include <QDebug>
 #include <QFile>
@@ -40,8 +41,13 @@
 #include "qlcconfig.h"
 #include "qlcfile.h"
 
-QScriptEngine* RGBScript::s_engine = NULL;
-QMutex* RGBScript::s_engineMutex = NULL;
+/** Maximum number of engines running the scripts in parallel */
+#define RGBSCRIPT_MAX_ENGINES 8
+
+QList<QScriptEngine *> RGBScript::s_engines;
+QList<QMutex *> RGBScript::s_engineMutexes;
+int RGBScript::s_nextEngine = 0;
+static QMutex s_poolMutex;
 
 /****************************************************************************
  * Initialization
@@ -49,14 +55,20 @@ QMutex* RGBScript::s_engineMutex = NULL;
 
 RGBScript::RGBScript(Doc * doc)
     : RGBAlgorithm(doc)
+    , m_engine(NULL)
+    , m_engineMutex(NULL)
+    , m_cacheable(false)
     , m_apiVersion(0)
 {
 }
 
 RGBScript::RGBScript(const RGBScript& s)
     : RGBAlgorithm(s.doc())
+    , m_engine(NULL)
+    , m_engineMutex(NULL)
     , m_fileName(s.m_fileName)
     , m_contents(s.m_contents)
+    , m_cacheable(false)
     , m_apiVersion(0)
 {
     evaluate();
@@ -77,6 +89,7 @@ RGBScript &RGBScript::operator=(const RGBScript &s)
         m_fileName = s.m_fileName;
         m_contents = s.m_contents;
         m_apiVersion = s.m_apiVersion;
+        m_cacheable = s.m_cacheable;
         evaluate();
         foreach(RGBScriptProperty cap, s.m_properties)
         {
@@ -110,13 +123,14 @@ bool RGBScript::load(const QDir& dir, const QString& fileName)
     // Create the script engine when it's first needed
     initEngine();
 
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     m_contents.clear();
     m_script = QScriptValue();
     m_rgbMap = QScriptValue();
     m_rgbMapStepCount = QScriptValue();
     m_apiVersion = 0;
+    m_cacheable = false;
 
     m_fileName = fileName;
     QFile file(dir.absoluteFilePath(m_fileName));
@@ -149,18 +163,21 @@ QString RGBScript::fileName() const
 
 bool RGBScript::evaluate()
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    initEngine();
+
+    QMutexLocker engineLocker(m_engineMutex);
 
     m_rgbMap = QScriptValue();
     m_rgbMapStepCount = QScriptValue();
     m_apiVersion = 0;
+    m_cacheable = false;
 
-    m_script = s_engine->evaluate(m_contents, m_fileName);
-    if (s_engine->hasUncaughtException() == true)
+    m_script = m_engine->evaluate(m_contents, m_fileName);
+    if (m_engine->hasUncaughtException() == true)
     {
         QString msg("%1: %2");
-        qWarning() << msg.arg(m_fileName).arg(s_engine->uncaughtException().toString());
-        foreach (QString s, s_engine->uncaughtExceptionBacktrace())
+        qWarning() << msg.arg(m_fileName).arg(m_engine->uncaughtException().toString());
+        foreach (QString s, m_engine->uncaughtExceptionBacktrace())
             qDebug() << s;
         return false;
     }
@@ -180,10 +197,11 @@ bool RGBScript::evaluate()
             return false;
         }
 
+        m_cacheable = m_script.property("cacheable").toBool();
         m_apiVersion = m_script.property("apiVersion").toInteger();
         if (m_apiVersion > 0)
         {
-            if (m_apiVersion == 2)
+            if (m_apiVersion >= 2)
                 return loadProperties();
             return true;
         }
@@ -197,13 +215,29 @@ bool RGBScript::evaluate()
 
 void RGBScript::initEngine()
 {
-    if (s_engineMutex == NULL)
+    if (m_engine != NULL)
+        return;
+
+    QMutexLocker poolLocker(&s_poolMutex);
+
+    if (s_engines.isEmpty())
     {
-        s_engineMutex = new QMutex(QMutex::Recursive);
-        s_engine = new QScriptEngine(QCoreApplication::instance());
+        int count = qBound(1, QThread::idealThreadCount(), RGBSCRIPT_MAX_ENGINES);
+        for (int i = 0; i < count; i++)
+        {
+            s_engineMutexes.append(new QMutex(QMutex::Recursive));
+            s_engines.append(new QScriptEngine(QCoreApplication::instance()));
+        }
     }
-    Q_ASSERT(s_engineMutex != NULL);
-    Q_ASSERT(s_engine != NULL);
+
+    /* Spread the scripts over the pool, so scripts running at the same
+     * time don't have to wait for each other */
+    m_engine = s_engines.at(s_nextEngine);
+    m_engineMutex = s_engineMutexes.at(s_nextEngine);
+    s_nextEngine = (s_nextEngine + 1) % s_engines.count();
+
+    Q_ASSERT(m_engineMutex != NULL);
+    Q_ASSERT(m_engine != NULL);
 }
 
 /****************************************************************************
@@ -212,7 +246,7 @@ void RGBScript::initEngine()
 
 int RGBScript::rgbMapStepCount(const QSize& size)
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     if (m_rgbMapStepCount.isValid() == false)
         return -1;
@@ -224,45 +258,70 @@ int RGBScript::rgbMapStepCount(const QSize& size)
     return ret;
 }
 
-RGBMap RGBScript::rgbMap(const QSize& size, uint rgb, int step)
+void RGBScript::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
 {
-    RGBMap map;
-
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     if (m_rgbMap.isValid() == false)
-        return map;
+    {
+        map.resize(QSize());
+        return;
+    }
 
     QScriptValueList args;
     args << size.width() << size.height() << rgb << step;
+
+    if (m_apiVersion >= 3)
+    {
+        /* API v3: the script fills a flat array of width * height pixels.
+         * QtScript has no typed arrays, so a plain Array is used and
+         * read back by index. Pixels left undefined are black */
+        int count = size.width() * size.height();
+        QScriptValue pixels = m_engine->newArray(count);
+        args << pixels;
+        m_rgbMap.call(QScriptValue(), args);
+        if (m_engine->hasUncaughtException() == true)
+        {
+            qWarning() << m_fileName << "rgbMap() error:" << m_engine->uncaughtException().toString();
+            m_engine->clearExceptions();
+            map.resize(QSize());
+            return;
+        }
+
+        map.resize(size);
+        uint *data = map.data();
+        for (int i = 0; i < count; i++)
+            data[i] = pixels.property(quint32(i)).toUInt32();
+
+        return;
+    }
+
     QScriptValue yarray = m_rgbMap.call(QScriptValue(), args);
     if (yarray.isArray() == true)
     {
+        map.resize(size);
+        map.fill(0);
+
         int ylen = yarray.property("length").toInteger();
-        map = RGBMap(ylen);
         for (int y = 0; y < ylen && y < size.height(); y++)
         {
-            QScriptValue xarray = yarray.property(QString::number(y));
+            QScriptValue xarray = yarray.property(quint32(y));
             int xlen = xarray.property("length").toInteger();
-            map[y].resize(xlen);
+            uint *line = map.scanLine(y);
             for (int x = 0; x < xlen && x < size.width(); x++)
-            {
-                QScriptValue yx = xarray.property(QString::number(x));
-                map[y][x] = yx.toInteger();
-            }
+                line[x] = xarray.property(quint32(x)).toUInt32();
         }
     }
     else
     {
         qWarning() << "Returned value is not an array within an array!";
+        map.resize(QSize());
     }
-
-    return map;
 }
 
 QString RGBScript::name() const
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     QScriptValue name = m_script.property("name");
     QString ret = name.isValid() ? name.toString() : QString();
@@ -271,7 +330,7 @@ QString RGBScript::name() const
 
 QString RGBScript::author() const
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     QScriptValue author = m_script.property("author");
     QString ret = author.isValid() ? author.toString() : QString();
@@ -283,6 +342,11 @@ int RGBScript::apiVersion() const
     return m_apiVersion;
 }
 
+bool RGBScript::isCacheable() const
+{
+    return m_cacheable;
+}
+
 RGBAlgorithm::Type RGBScript::type() const
 {
     return RGBAlgorithm::Script;
@@ -290,7 +354,7 @@ RGBAlgorithm::Type RGBScript::type() const
 
 int RGBScript::acceptColors() const
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     QScriptValue accColors = m_script.property("acceptColors");
     if (accColors.isValid())
@@ -336,7 +400,7 @@ QList<RGBScriptProperty> RGBScript::properties()
 
 QHash<QString, QString> RGBScript::propertiesAsStrings()
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     QHash<QString, QString> properties;
     foreach(RGBScriptProperty cap, m_properties)
@@ -355,7 +419,7 @@ QHash<QString, QString> RGBScript::propertiesAsStrings()
 
 bool RGBScript::setProperty(QString propertyName, QString value)
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     foreach(RGBScriptProperty cap, m_properties)
     {
@@ -369,7 +433,10 @@ bool RGBScript::setProperty(QString propertyName, QString value)
             }
             QScriptValueList args;
             args << value;
+            bool changed = property(propertyName) != value;
             writeMethod.call(QScriptValue(), args);
+            if (changed)
+                bumpRevision();
             return true;
         }
     }
@@ -378,7 +445,7 @@ bool RGBScript::setProperty(QString propertyName, QString value)
 
 QString RGBScript::property(QString propertyName) const
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     foreach(RGBScriptProperty cap, m_properties)
     {
@@ -403,7 +470,7 @@ QString RGBScript::property(QString propertyName) const
 
 bool RGBScript::loadProperties()
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     QScriptValue svCaps = m_script.property("properties");
     if (svCaps.isArray() == false)
@@ -67,14 +67,18 @@ public:
     bool evaluate();
 
 private:
-    static QScriptEngine *s_engine; //! The engine that runs all scripts
-    static QMutex *s_engineMutex;   //! Protection
+    static QList<QScriptEngine *> s_engines; //! The pool of engines running the scripts
+    static QList<QMutex *> s_engineMutexes;  //! Protection, one for each engine
+    static int s_nextEngine;                 //! The pool engine the next script goes into
+    QScriptEngine *m_engine;                 //! The engine this script is evaluated into
+    QMutex *m_engineMutex;                   //! Protection of m_engine
     QString m_fileName;             //! The file name that contains this script
     QString m_contents;             //! The file's contents
 
 private:
-    /** Init engine, engine mutex, and scripts map */
-    static void initEngine();
+    /** Assign this script to one of the pool engines. The pool is
+     *  created when it's first needed */
+    void initEngine();
 
     /************************************************************************
      * RGBAlgorithm API
@@ -84,7 +88,7 @@ public:
     int rgbMapStepCount(const QSize& size);
 
     /** @reimp */
-    RGBMap rgbMap(const QSize& size, uint rgb, int step);
+    void rgbMap(const QSize& size, uint rgb, int step, RGBMap &map);
 
     /** @reimp */
     QString name() const;
@@ -101,6 +105,12 @@ public:
     /** @reimp */
     int acceptColors() const;
 
+    /** @reimp */
+    bool isCacheable() const;
+
+    /** @reimp */
+    bool isPrefillable() const { return false; }
+
     /** @reimp */
     bool loadXML(QXmlStreamReader &root);
 
@@ -108,6 +118,7 @@ public:
     bool saveXML(QXmlStreamWriter *doc) const;
 
 private:
+    bool m_cacheable;               //! The script declares algo.cacheable = true
     int m_apiVersion;               //! The API version that the script uses
     QScriptValue m_script;          //! The script itself
     QScriptValue m_rgbMap;          //! rgbMap() function
@@ -20,6 +20,7 @@
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 #include <QJSEngine>
+#include <QThread>
 #include <QMutex>
 #include <QDebug>
 #include <QFile>
@@ -30,8 +31,13 @@
 #include "qlcconfig.h"
 #include "qlcfile.h"
 
-QJSEngine* RGBScript::s_engine = NULL;
-QMutex* RGBScript::s_engineMutex = NULL;
+/** Maximum number of engines running the scripts in parallel */
+#define RGBSCRIPT_MAX_ENGINES 8
+
+QList<QJSEngine *> RGBScript::s_engines;
+QList<QMutex *> RGBScript::s_engineMutexes;
+int RGBScript::s_nextEngine = 0;
+static QMutex s_poolMutex;
 
 /****************************************************************************
  * Initialization
@@ -39,14 +45,20 @@ QMutex* RGBScript::s_engineMutex = NULL;
 
 RGBScript::RGBScript(Doc * doc)
     : RGBAlgorithm(doc)
+    , m_engine(NULL)
+    , m_engineMutex(NULL)
+    , m_cacheable(false)
     , m_apiVersion(0)
 {
 }
 
 RGBScript::RGBScript(const RGBScript& s)
     : RGBAlgorithm(s.doc())
+    , m_engine(NULL)
+    , m_engineMutex(NULL)
     , m_fileName(s.m_fileName)
     , m_contents(s.m_contents)
+    , m_cacheable(false)
     , m_apiVersion(0)
 {
     evaluate();
@@ -79,13 +91,17 @@ bool RGBScript::load(const QDir& dir, const QString& fileName)
     // Create the script engine when it's first needed
     initEngine();
 
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     m_contents.clear();
     m_script = QJSValue();
     m_rgbMap = QJSValue();
     m_rgbMapStepCount = QJSValue();
+    m_mapBuffer = QJSValue();
+    m_mapArray = QJSValue();
+    m_mapSize = QSize();
     m_apiVersion = 0;
+    m_cacheable = false;
 
     m_fileName = fileName;
     QFile file(dir.absoluteFilePath(m_fileName));
@@ -109,11 +125,14 @@ QString RGBScript::fileName() const
 
 bool RGBScript::evaluate()
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    initEngine();
+
+    QMutexLocker engineLocker(m_engineMutex);
 
     m_rgbMap = QJSValue();
     m_rgbMapStepCount = QJSValue();
     m_apiVersion = 0;
+    m_cacheable = false;
 
     if (m_fileName.isEmpty() || m_contents.isEmpty())
     {
@@ -121,7 +140,7 @@ bool RGBScript::evaluate()
         return false;
     }
 
-    m_script = s_engine->evaluate(m_contents, m_fileName);
+    m_script = m_engine->evaluate(m_contents, m_fileName);
     if (m_script.isError())
     {
         QString msg("%1: Uncaught exception at line %2. Error: %3");
@@ -146,10 +165,11 @@ bool RGBScript::evaluate()
         return false;
     }
 
+    m_cacheable = m_script.property("cacheable").toBool();
     m_apiVersion = m_script.property("apiVersion").toInt();
     if (m_apiVersion > 0)
     {
-        if (m_apiVersion == 2)
+        if (m_apiVersion >= 2)
             return loadProperties();
         return true;
     }
@@ -162,13 +182,29 @@ bool RGBScript::evaluate()
 
 void RGBScript::initEngine()
 {
-    if (s_engineMutex == NULL)
+    if (m_engine != NULL)
+        return;
+
+    QMutexLocker poolLocker(&s_poolMutex);
+
+    if (s_engines.isEmpty())
     {
-        s_engineMutex = new QMutex(QMutex::Recursive);
-        s_engine = new QJSEngine();
+        int count = qBound(1, QThread::idealThreadCount(), RGBSCRIPT_MAX_ENGINES);
+        for (int i = 0; i < count; i++)
+        {
+            s_engineMutexes.append(new QMutex(QMutex::Recursive));
+            s_engines.append(new QJSEngine());
+        }
     }
-    Q_ASSERT(s_engineMutex != NULL);
-    Q_ASSERT(s_engine != NULL);
+
+    /* Spread the scripts over the pool, so scripts running at the same
+     * time don't have to wait for each other */
+    m_engine = s_engines.at(s_nextEngine);
+    m_engineMutex = s_engineMutexes.at(s_nextEngine);
+    s_nextEngine = (s_nextEngine + 1) % s_engines.count();
+
+    Q_ASSERT(m_engineMutex != NULL);
+    Q_ASSERT(m_engine != NULL);
 }
 
 /****************************************************************************
@@ -177,7 +213,7 @@ void RGBScript::initEngine()
 
 int RGBScript::rgbMapStepCount(const QSize& size)
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     if (m_rgbMapStepCount.isCallable() == false)
         return -1;
@@ -189,45 +225,92 @@ int RGBScript::rgbMapStepCount(const QSize& size)
     return ret;
 }
 
-RGBMap RGBScript::rgbMap(const QSize& size, uint rgb, int step)
+void RGBScript::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
 {
-    RGBMap map;
-
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     if (m_rgbMap.isUndefined() == true)
-        return map;
+    {
+        map.resize(QSize());
+        return;
+    }
 
     QJSValueList args;
     args << size.width() << size.height() << rgb << step;
+
+    if (m_apiVersion >= 3)
+    {
+        /* API v3: the script fills a flat Uint32Array of width * height
+         * pixels, which is read back in one go */
+        QJSValue buffer = mapBuffer(size);
+        args << m_mapArray;
+        QJSValue ret = m_rgbMap.call(args);
+        if (ret.isError())
+        {
+            qWarning() << m_fileName << "rgbMap() error:" << ret.toString();
+            map.resize(QSize());
+            return;
+        }
+
+        QByteArray data = buffer.toVariant().toByteArray();
+        if (data.size() < int(size.width() * size.height() * sizeof(quint32)))
+        {
+            qWarning() << m_fileName << "rgbMap() buffer has been resized!";
+            map.resize(QSize());
+            return;
+        }
+
+        map.resize(size);
+        memcpy(map.data(), data.constData(), size.width() * size.height() * sizeof(quint32));
+        return;
+    }
+
     QJSValue yarray = m_rgbMap.call(args);
     if (yarray.isArray() == true)
     {
+        map.resize(size);
+        map.fill(0);
+
         int ylen = yarray.property("length").toInt();
-        map = RGBMap(ylen);
         for (int y = 0; y < ylen && y < size.height(); y++)
         {
-            QJSValue xarray = yarray.property(QString::number(y));
+            QJSValue xarray = yarray.property(quint32(y));
             int xlen = xarray.property("length").toInt();
-            map[y].resize(xlen);
+            uint *line = map.scanLine(y);
             for (int x = 0; x < xlen && x < size.width(); x++)
-            {
-                QJSValue yx = xarray.property(QString::number(x));
-                map[y][x] = yx.toInt();
-            }
+                line[x] = xarray.property(quint32(x)).toUInt();
         }
     }
     else
     {
         qWarning() << "Returned value is not an array within an array!";
+        map.resize(QSize());
+    }
+}
+
+QJSValue RGBScript::mapBuffer(const QSize& size)
+{
+    if (m_mapSize != size || m_mapBuffer.isUndefined())
+    {
+        /* A QByteArray is converted into an ArrayBuffer sharing its data */
+        QByteArray data(size.width() * size.height() * sizeof(quint32), 0);
+        m_mapBuffer = m_engine->toScriptValue(data);
+        m_mapArray = m_engine->globalObject().property("Uint32Array")
+                        .callAsConstructor(QJSValueList() << m_mapBuffer);
+        m_mapSize = size;
+    }
+    else
+    {
+        /* Pixels that are not written by the script are black */
+        m_mapArray.property("fill").callWithInstance(m_mapArray, QJSValueList() << 0);
     }
 
-    return map;
+    return m_mapBuffer;
 }
 
 QString RGBScript::name() const
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     QJSValue name = m_script.property("name");
     QString ret = name.isUndefined() ? QString() : name.toString();
@@ -236,7 +319,7 @@ QString RGBScript::name() const
 
 QString RGBScript::author() const
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     QJSValue author = m_script.property("author");
     QString ret = author.isUndefined() ? QString() : author.toString();
@@ -248,6 +331,11 @@ int RGBScript::apiVersion() const
     return m_apiVersion;
 }
 
+bool RGBScript::isCacheable() const
+{
+    return m_cacheable;
+}
+
 RGBAlgorithm::Type RGBScript::type() const
 {
     return RGBAlgorithm::Script;
@@ -255,7 +343,7 @@ RGBAlgorithm::Type RGBScript::type() const
 
 int RGBScript::acceptColors() const
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     QJSValue accColors = m_script.property("acceptColors");
     if (!accColors.isUndefined())
@@ -301,7 +389,7 @@ QList<RGBScriptProperty> RGBScript::properties()
 
 QHash<QString, QString> RGBScript::propertiesAsStrings()
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     QHash<QString, QString> properties;
     foreach(RGBScriptProperty cap, m_properties)
@@ -320,7 +408,7 @@ QHash<QString, QString> RGBScript::propertiesAsStrings()
 
 bool RGBScript::setProperty(QString propertyName, QString value)
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     foreach(RGBScriptProperty cap, m_properties)
     {
@@ -334,7 +422,10 @@ bool RGBScript::setProperty(QString propertyName, QString value)
             }
             QJSValueList args;
             args << value;
+            bool changed = property(propertyName) != value;
             writeMethod.call(args);
+            if (changed)
+                bumpRevision();
             return true;
         }
     }
@@ -343,7 +434,7 @@ bool RGBScript::setProperty(QString propertyName, QString value)
 
 QString RGBScript::property(QString propertyName)
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     foreach(RGBScriptProperty cap, m_properties)
     {
@@ -368,7 +459,7 @@ QString RGBScript::property(QString propertyName)
 
 bool RGBScript::loadProperties()
 {
-    QMutexLocker engineLocker(s_engineMutex);
+    QMutexLocker engineLocker(m_engineMutex);
 
     QJSValue svCaps = m_script.property("properties");
     if (svCaps.isArray() == false)
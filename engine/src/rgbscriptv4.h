@@ -66,12 +66,16 @@ public:
     bool evaluate();
 
 private:
-    /** Init engine, engine mutex, and scripts map */
-    static void initEngine();
+    /** Assign this script to one of the pool engines. The pool is
+     *  created when it's first needed */
+    void initEngine();
 
 private:
-    static QJSEngine* s_engine;      //! The engine that runs all scripts
-    static QMutex* s_engineMutex;   //! Protection
+    static QList<QJSEngine *> s_engines;    //! The pool of engines running the scripts
+    static QList<QMutex *> s_engineMutexes; //! Protection, one for each engine
+    static int s_nextEngine;                //! The pool engine the next script goes into
+    QJSEngine *m_engine;                    //! The engine this script is evaluated into
+    QMutex *m_engineMutex;                  //! Protection of m_engine
     QString m_fileName;             //! The file name that contains this script
     QString m_contents;             //! The file's contents
 
@@ -83,7 +87,7 @@ public:
     int rgbMapStepCount(const QSize& size);
 
     /** @reimp */
-    RGBMap rgbMap(const QSize& size, uint rgb, int step);
+    void rgbMap(const QSize& size, uint rgb, int step, RGBMap &map);
 
     /** @reimp */
     QString name() const;
@@ -100,6 +104,12 @@ public:
     /** @reimp */
     int acceptColors() const;
 
+    /** @reimp */
+    bool isCacheable() const;
+
+    /** @reimp */
+    bool isPrefillable() const { return false; }
+
     /** @reimp */
     bool loadXML(QXmlStreamReader &root);
 
@@ -107,10 +117,19 @@ public:
     bool saveXML(QXmlStreamWriter *doc) const;
 
 private:
+    /** Return the ArrayBuffer filled by API v3 scripts, (re)allocated
+     *  to $size and cleared. m_mapArray is a Uint32Array view on it */
+    QJSValue mapBuffer(const QSize& size);
+
+private:
+    bool m_cacheable;           //! The script declares algo.cacheable = true
     int m_apiVersion;           //! The API version that the script uses
     QJSValue m_script;          //! The script itself
     QJSValue m_rgbMap;          //! rgbMap() function
     QJSValue m_rgbMapStepCount; //! rgbMapStepCount() function
+    QJSValue m_mapBuffer;       //! The ArrayBuffer filled by API v3 rgbMap()
+    QJSValue m_mapArray;        //! Uint32Array view on m_mapBuffer
+    QSize m_mapSize;            //! The size m_mapBuffer has been allocated for
 
     /************************************************************************
      * Properties
@@ -69,6 +69,7 @@ RGBAlgorithm* RGBText::clone() const
 void RGBText::setText(const QString& str)
 {
     m_text = str;
+    bumpRevision();
 }
 
 QString RGBText::text() const
@@ -79,6 +80,7 @@ QString RGBText::text() const
 void RGBText::setFont(const QFont& font)
 {
     m_font = font;
+    bumpRevision();
 }
 
 QFont RGBText::font() const
@@ -96,6 +98,7 @@ void RGBText::setAnimationStyle(RGBText::AnimationStyle ani)
         m_animationStyle = ani;
     else
         m_animationStyle = StaticLetters;
+    bumpRevision();
 }
 
 RGBText::AnimationStyle RGBText::animationStyle() const
@@ -139,6 +142,7 @@ QStringList RGBText::animationStyles()
 void RGBText::setXOffset(int offset)
 {
     m_xOffset = offset;
+    bumpRevision();
 }
 
 int RGBText::xOffset() const
@@ -149,6 +153,7 @@ int RGBText::xOffset() const
 void RGBText::setYOffset(int offset)
 {
     m_yOffset = offset;
+    bumpRevision();
 }
 
 int RGBText::yOffset() const
@@ -170,7 +175,7 @@ int RGBText::scrollingTextStepCount() const
     }
 }
 
-RGBMap RGBText::renderScrollingText(const QSize& size, uint rgb, int step) const
+void RGBText::renderScrollingText(const QSize& size, uint rgb, int step, RGBMap &map) const
 {
     QImage image;
     if (animationStyle() == Horizontal)
@@ -208,29 +213,28 @@ RGBMap RGBText::renderScrollingText(const QSize& size, uint rgb, int step) const
 
     // Treat the RGBMap as a "window" on top of the fully-drawn text and pick the
     // correct pixels according to $step.
-    RGBMap map(size.height());
+    map.resize(size);
+    map.fill(0);
     for (int y = 0; y < size.height(); y++)
     {
-        map[y].resize(size.width());
+        uint *line = map.scanLine(y);
         for (int x = 0; x < size.width(); x++)
         {
             if (animationStyle() == Horizontal)
             {
                 if (step + x < image.width())
-                    map[y][x] = image.pixel(step + x, y);
+                    line[x] = image.pixel(step + x, y);
             }
             else
             {
                 if (step + y < image.height())
-                    map[y][x] = image.pixel(x, step + y);
+                    line[x] = image.pixel(x, step + y);
             }
         }
     }
-
-    return map;
 }
 
-RGBMap RGBText::renderStaticLetters(const QSize& size, uint rgb, int step) const
+void RGBText::renderStaticLetters(const QSize& size, uint rgb, int step, RGBMap &map) const
 {
     QImage image(size, QImage::Format_RGB32);
     image.fill(QRgb(0));
@@ -246,15 +250,13 @@ RGBMap RGBText::renderStaticLetters(const QSize& size, uint rgb, int step) const
     p.drawText(rect, Qt::AlignCenter, m_text.mid(step, 1));
     p.end();
 
-    RGBMap map(size.height());
+    map.resize(size);
     for (int y = 0; y < size.height(); y++)
     {
-        map[y].resize(size.width());
+        uint *line = map.scanLine(y);
         for (int x = 0; x < size.width(); x++)
-            map[y][x] = image.pixel(x, y);
+            line[x] = image.pixel(x, y);
     }
-
-    return map;
 }
 
 /****************************************************************************
@@ -270,12 +272,12 @@ int RGBText::rgbMapStepCount(const QSize& size)
         return scrollingTextStepCount();
 }
 
-RGBMap RGBText::rgbMap(const QSize& size, uint rgb, int step)
+void RGBText::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
 {
     if (animationStyle() == StaticLetters)
-        return renderStaticLetters(size, rgb, step);
+        renderStaticLetters(size, rgb, step, map);
     else
-        return renderScrollingText(size, rgb, step);
+        renderScrollingText(size, rgb, step, map);
 }
 
 QString RGBText::name() const
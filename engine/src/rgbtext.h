@@ -83,8 +83,8 @@ public:
 
 private:
     int scrollingTextStepCount() const;
-    RGBMap renderScrollingText(const QSize& size, uint rgb, int step) const;
-    RGBMap renderStaticLetters(const QSize& size, uint rgb, int step) const;
+    void renderScrollingText(const QSize& size, uint rgb, int step, RGBMap &map) const;
+    void renderStaticLetters(const QSize& size, uint rgb, int step, RGBMap &map) const;
 
 private:
     AnimationStyle m_animationStyle;
@@ -99,7 +99,7 @@ public:
     int rgbMapStepCount(const QSize& size);
 
     /** @reimp */
-    RGBMap rgbMap(const QSize& size, uint rgb, int step);
+    void rgbMap(const QSize& size, uint rgb, int step, RGBMap &map);
 
     /** @reimp */
     QString name() const;
@@ -116,6 +116,9 @@ public:
     /** @reimp */
     int acceptColors() const;
 
+    /** @reimp */
+    bool isCacheable() const { return true; }
+
     /** @reimp */
     bool loadXML(QXmlStreamReader &root);
 
@@ -248,7 +248,8 @@ int ScriptRunner::getChannelValue(int universe, int channel)
     if (m_running == false)
         return false;
 
-    QList<Universe*> uniList = m_doc->inputOutputMap()->claimUniverses();
+    UniverseSnapshotPtr snapshot = m_doc->inputOutputMap()->universesSnapshot();
+    QList<Universe*> const& uniList = snapshot->universes();
     uchar dmxValue = 0;
 
     if (universe >= 0 && universe < uniList.count())
@@ -256,7 +257,6 @@ int ScriptRunner::getChannelValue(int universe, int channel)
         Universe *uni = uniList.at(universe);
         dmxValue = uni->preGMValue(channel);
     }
-    m_doc->inputOutputMap()->releaseUniverses(false);
 
     return dmxValue;
 }
@@ -75,6 +75,7 @@ HEADERS += bus.h \
            cue.h \
            cuestack.h \
            doc.h \
+           engineprofiler.h \
            dmxdumpfactoryproperties.h \
            dmxsource.h \
            efx.h \
@@ -99,6 +100,8 @@ HEADERS += bus.h \
            qlcpoint.h \
            rgbalgorithm.h \
            rgbaudio.h \
+           rgbmap.h \
+           rgbmapcache.h \
            rgbmatrix.h \
            rgbimage.h \
            rgbplain.h \
@@ -113,7 +116,9 @@ HEADERS += bus.h \
            showfunction.h \
            showrunner.h \
            track.h \
-           universe.h
+           universe.h \
+           universemonitor.h \
+           universeworkerpool.h
 
 qmlui {
   HEADERS += rgbscriptv4.h scriptrunner.h scriptv4.h
@@ -155,6 +160,7 @@ SOURCES += bus.cpp \
            cue.cpp \
            cuestack.cpp \
            doc.cpp \
+           engineprofiler.cpp \
            dmxdumpfactoryproperties.cpp \
            efx.cpp \
            efxfixture.cpp \
@@ -178,6 +184,7 @@ SOURCES += bus.cpp \
            qlcpoint.cpp \
            rgbalgorithm.cpp \
            rgbaudio.cpp \
+           rgbmapcache.cpp \
            rgbmatrix.cpp \
            rgbimage.cpp \
            rgbplain.cpp \
@@ -190,7 +197,9 @@ SOURCES += bus.cpp \
            showfunction.cpp \
            showrunner.cpp \
            track.cpp \
-           universe.cpp
+           universe.cpp \
+           universemonitor.cpp \
+           universeworkerpool.cpp
 
 qmlui {
   SOURCES += rgbscriptv4.cpp scriptrunner.cpp scriptv4.cpp
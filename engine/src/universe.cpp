@@ -22,8 +22,15 @@
 #include <QDebug>
 #include <math.h>
 
+#if defined(__SSE2__)
+#   include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   include <arm_neon.h>
+#endif
+
 #include "channelmodifier.h"
 #include "inputoutputmap.h"
+#include "engineprofiler.h"
 #include "genericfader.h"
 #include "qlcioplugin.h"
 #include "outputpatch.h"
@@ -37,17 +44,22 @@
 
 #define RELATIVE_ZERO 127
 
+/** Flag of m_snapshotMiddle telling the readers a new snapshot is available */
+#define SNAPSHOT_FRESH 0x04
+
 #define KXMLUniverseNormalBlend "Normal"
 #define KXMLUniverseMaskBlend "Mask"
 #define KXMLUniverseAdditiveBlend "Additive"
 #define KXMLUniverseSubtractiveBlend "Subtractive"
 
 Universe::Universe(quint32 id, GrandMaster *gm, QObject *parent)
-    : QThread(parent)
+    : QObject(parent)
     , m_id(id)
     , m_grandMaster(gm)
     , m_passthrough(false)
     , m_monitor(false)
+    , m_gmAllChannels(false)
+    , m_postGMDeferred(false)
     , m_inputPatch(NULL)
     , m_fbPatch(NULL)
     , m_channelsMask(new QByteArray(UNIVERSE_SIZE, char(0)))
@@ -60,29 +72,27 @@ Universe::Universe(quint32 id, GrandMaster *gm, QObject *parent)
     , m_postGMValues(new QByteArray(UNIVERSE_SIZE, char(0)))
     , m_lastPostGMValues(new QByteArray(UNIVERSE_SIZE, char(0)))
     , m_passthroughValues()
+    , m_outputFrameIndex(0)
+    , m_snapshotBack(0)
+    , m_snapshotFront(1)
+    , m_snapshotMiddle(2)
 {
+    m_outputFrames[0].reserve(UNIVERSE_SIZE);
+    m_outputFrames[1].reserve(UNIVERSE_SIZE);
+
     m_relativeValues.fill(0, UNIVERSE_SIZE);
     m_modifiers.fill(NULL, UNIVERSE_SIZE);
 
     m_name = QString("Universe %1").arg(id + 1);
 
+    updateGMTable();
+
     connect(m_grandMaster, SIGNAL(valueChanged(uchar)),
             this, SLOT(slotGMValueChanged()));
 }
 
 Universe::~Universe()
 {
-    if (isRunning() == true)
-    {
-        // isRunning is inconsistent with m_running,
-        // so double check if the thread is really in the run loop
-        while (m_running == false)
-            usleep(10000);
-
-        m_running = false;
-        wait(1000);
-    }
-
     delete m_inputPatch;
     int opCount = m_outputPatchList.count();
     for (int i = 0; i < opCount; i++)
@@ -129,11 +139,40 @@ ushort Universe::totalChannels()
 
 bool Universe::hasChanged()
 {
-    bool changed =
-        memcmp(m_lastPostGMValues->constData(), m_postGMValues->constData(), m_usedChannels) != 0;
-    if (changed)
-        memcpy(m_lastPostGMValues->data(), m_postGMValues->constData(), m_usedChannels);
-    return changed;
+    return changedBlocks() != 0;
+}
+
+quint32 Universe::changedBlocks()
+{
+    const char *current = m_postGMValues->constData();
+    char *last = m_lastPostGMValues->data();
+    quint32 mask = 0;
+
+    for (int address = 0, block = 0; address < m_usedChannels; address += UNIVERSE_BLOCK_SIZE, block++)
+    {
+        int count = qMin(UNIVERSE_BLOCK_SIZE, m_usedChannels - address);
+        if (memcmp(last + address, current + address, count) != 0)
+        {
+            memcpy(last + address, current + address, count);
+            mask |= (1u << block);
+        }
+    }
+
+    return mask;
+}
+
+quint32 Universe::blocksMask(quint32 address, quint32 count)
+{
+    if (count == 0 || address >= UNIVERSE_SIZE)
+        return 0;
+
+    quint32 first = address / UNIVERSE_BLOCK_SIZE;
+    quint32 last = qMin(address + count - 1, quint32(UNIVERSE_SIZE - 1)) / UNIVERSE_BLOCK_SIZE;
+
+    if (last - first == 31)
+        return UINT_MAX;
+
+    return ((1u << (last - first + 1)) - 1) << first;
 }
 
 void Universe::setPassthrough(bool enable)
@@ -180,22 +219,33 @@ bool Universe::monitor() const
 
 void Universe::slotGMValueChanged()
 {
+    updateGMTable();
+    updatePostGMValues(0, m_usedChannels);
+}
+
+void Universe::updateGMTable()
+{
+    if (m_grandMaster == NULL)
     {
-        for (int i = 0; i < m_intensityChannels.size(); ++i)
-        {
-            int channel = m_intensityChannels.at(i);
-            updatePostGMValue(channel);
-        }
+        for (int i = 0; i < 256; i++)
+            m_gmTable[i] = uchar(i);
+        m_gmAllChannels = false;
+        return;
     }
 
-    if (m_grandMaster->channelMode() == GrandMaster::AllChannels)
+    bool limit = m_grandMaster->valueMode() == GrandMaster::Limit;
+    uchar gmValue = m_grandMaster->value();
+    double fraction = m_grandMaster->fraction();
+
+    for (int i = 0; i < 256; i++)
     {
-        for (int i = 0; i < m_nonIntensityChannels.size(); ++i)
-        {
-            int channel = m_nonIntensityChannels.at(i);
-            updatePostGMValue(channel);
-        }
+        if (limit)
+            m_gmTable[i] = MIN(uchar(i), gmValue);
+        else
+            m_gmTable[i] = uchar(floor((double(i) * fraction) + 0.5));
     }
+
+    m_gmAllChannels = m_grandMaster->channelMode() == GrandMaster::AllChannels;
 }
 
 /************************************************************************
@@ -208,6 +258,8 @@ QSharedPointer<GenericFader> Universe::requestFader(Universe::FaderPriority prio
     QSharedPointer<GenericFader> fader = QSharedPointer<GenericFader>(new GenericFader());
     fader->setPriority(priority);
 
+    QMutexLocker locker(&m_fadersMutex);
+
     if (m_faders.isEmpty())
     {
         m_faders.append(fader);
@@ -234,6 +286,7 @@ QSharedPointer<GenericFader> Universe::requestFader(Universe::FaderPriority prio
 
 void Universe::dismissFader(QSharedPointer<GenericFader> fader)
 {
+    QMutexLocker locker(&m_fadersMutex);
     int index = m_faders.indexOf(fader);
     if (index >= 0)
     {
@@ -244,6 +297,7 @@ void Universe::dismissFader(QSharedPointer<GenericFader> fader)
 
 void Universe::requestFaderPriority(QSharedPointer<GenericFader> fader, Universe::FaderPriority priority)
 {
+    QMutexLocker locker(&m_fadersMutex);
     if (m_faders.contains(fader) == false)
         return;
 
@@ -270,20 +324,22 @@ void Universe::requestFaderPriority(QSharedPointer<GenericFader> fader, Universe
 
 QList<QSharedPointer<GenericFader> > Universe::faders()
 {
+    QMutexLocker locker(&m_fadersMutex);
     return m_faders;
 }
 
-void Universe::tick()
+void Universe::renderFaders()
 {
-    m_semaphore.release(1);
-}
+    EngineProfilerScope scope(EngineProfiler::FadersStage, id());
 
-void Universe::processFaders()
-{
     flushInput();
     zeroIntensityChannels();
     zeroRelativeValues();
 
+    /* Post-GM values are computed once for all at the end */
+    m_postGMDeferred = true;
+
+    QMutexLocker locker(&m_fadersMutex);
     QMutableListIterator<QSharedPointer<GenericFader> > it(m_faders);
     while (it.hasNext())
     {
@@ -307,36 +363,85 @@ void Universe::processFaders()
         //qDebug() << "Processing fader" << fader->name() << fader->channelsCount();
         fader->write(this);
     }
+    locker.unlock();
+
+    m_postGMDeferred = false;
+    updatePostGMValues(0, m_usedChannels);
+}
+
+void Universe::flushOutput()
+{
+    /* Alternate between two preallocated frames, so the one still
+     * referenced by listeners of the previous tick is not touched.
+     * A frame is reallocated only if it is still shared */
+    QByteArray &frame = m_outputFrames[m_outputFrameIndex];
+    m_outputFrameIndex ^= 1;
 
-    const QByteArray postGM = m_postGMValues->mid(0, m_usedChannels);
-    dumpOutput(postGM);
+    frame.resize(m_usedChannels);
+    memcpy(frame.data(), m_postGMValues->constData(), m_usedChannels);
 
-    if (hasChanged())
-        emit universeWritten(id(), postGM);
+    dumpOutput(frame);
+
+    quint32 changed = changedBlocks();
+    if (changed)
+    {
+        publishSnapshot(frame, changed);
+        emit universeWritten(id(), frame, changed);
+    }
 }
 
-void Universe::run()
+void Universe::processFaders()
 {
-    m_running = true;
-    int timeout = int(MasterTimer::tick()) * 2;
+    renderFaders();
+    flushOutput();
+}
 
-    qDebug() << "Universe thread started" << id();
+/************************************************************************
+ * Snapshots
+ ************************************************************************/
 
-    while(m_running)
+void Universe::publishSnapshot(const QByteArray &frame, quint32 changedBlocks)
+{
+    quint32 serial = ++m_snapshotSerials.serial;
+    for (int i = 0; i < 32; i++)
     {
-        if (m_semaphore.tryAcquire(1, timeout) == false)
-        {
-            //qWarning() << "Semaphore not acquired on universe" << id();
-            continue;
-        }
-#if 0
-        if (m_faders.count())
-            qDebug() << "<<<<<<<< UNIVERSE TICK - id" << id() << "faders:" << m_faders.count();
-#endif
-        processFaders();
+        if (changedBlocks & (1u << i))
+            m_snapshotSerials.blocks[i] = serial;
     }
 
-    qDebug() << "Universe thread stopped" << id();
+    /* Copy in place: the snapshot values detach only if a
+     * reader still holds the frame it got three publishes ago */
+    Snapshot &back = m_snapshots[m_snapshotBack];
+    back.values.resize(frame.size());
+    memcpy(back.values.data(), frame.constData(), frame.size());
+    back.serials = m_snapshotSerials;
+
+    int previous = m_snapshotMiddle.fetchAndStoreOrdered(m_snapshotBack | SNAPSHOT_FRESH);
+    m_snapshotBack = previous & ~SNAPSHOT_FRESH;
+}
+
+quint32 Universe::pullSnapshot(SnapshotCursor &cursor, QByteArray &values)
+{
+    QMutexLocker locker(&m_snapshotReadMutex);
+
+    if (m_snapshotMiddle.loadAcquire() & SNAPSHOT_FRESH)
+        m_snapshotFront = m_snapshotMiddle.fetchAndStoreOrdered(m_snapshotFront) & ~SNAPSHOT_FRESH;
+
+    const Snapshot &front = m_snapshots[m_snapshotFront];
+    if (front.serials.serial == cursor.serial)
+        return 0;
+
+    quint32 mask = 0;
+    for (int i = 0; i < 32; i++)
+    {
+        if (front.serials.blocks[i] != cursor.blocks[i])
+            mask |= (1u << i);
+    }
+
+    cursor = front.serials;
+    values = front.values;
+
+    return mask;
 }
 
 /************************************************************************
@@ -490,14 +595,8 @@ uchar Universe::applyRelative(int channel, uchar value)
 
 uchar Universe::applyGM(int channel, uchar value)
 {
-    if ((m_grandMaster->channelMode() == GrandMaster::Intensity && m_channelsMask->at(channel) & Intensity) ||
-        (m_grandMaster->channelMode() == GrandMaster::AllChannels))
-    {
-        if (m_grandMaster->valueMode() == GrandMaster::Limit)
-            value = MIN(value, m_grandMaster->value());
-        else
-            value = char(floor((double(value) * m_grandMaster->fraction()) + 0.5));
-    }
+    if (m_gmAllChannels || (m_channelsMask->at(channel) & Intensity))
+        return m_gmTable[value];
 
     return value;
 }
@@ -526,6 +625,9 @@ uchar Universe::applyPassthrough(int channel, uchar value)
 
 void Universe::updatePostGMValue(int channel)
 {
+    if (m_postGMDeferred)
+        return;
+
     uchar value = preGMValue(channel);
 
     value = applyRelative(channel, value);
@@ -545,6 +647,70 @@ void Universe::updatePostGMValue(int channel)
     (*m_postGMValues)[channel] = static_cast<char>(value);
 }
 
+/** HTP merge of $count $src values into $dst */
+static void htpMerge(uchar *dst, const uchar *src, int count)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_max_epu8(d, s));
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; i + 16 <= count; i += 16)
+        vst1q_u8(dst + i, vmaxq_u8(vld1q_u8(dst + i), vld1q_u8(src + i)));
+#endif
+    for (; i < count; i++)
+    {
+        if (dst[i] < src[i])
+            dst[i] = src[i];
+    }
+}
+
+void Universe::updatePostGMValues(int address, int range)
+{
+    if (address >= UNIVERSE_SIZE || range <= 0)
+        return;
+
+    if (address + range > UNIVERSE_SIZE)
+        range = UNIVERSE_SIZE - address;
+
+    const uchar *preGM = reinterpret_cast<const uchar *>(m_preGMValues->constData());
+    const uchar *mask = reinterpret_cast<const uchar *>(m_channelsMask->constData());
+    const uchar *zeroValues = reinterpret_cast<const uchar *>(m_modifiedZeroValues->constData());
+    const short *relative = m_relativeValues.constData();
+    ChannelModifier * const *modifiers = m_modifiers.constData();
+    uchar *postGM = reinterpret_cast<uchar *>(m_postGMValues->data());
+
+    for (int i = address; i < address + range; i++)
+    {
+        int value = preGM[i];
+
+        if (relative[i] != 0)
+            value = CLAMP(value + relative[i], 0, (int)UCHAR_MAX);
+
+        if (value == 0)
+        {
+            postGM[i] = zeroValues[i];
+            continue;
+        }
+
+        if (m_gmAllChannels || (mask[i] & Intensity))
+            value = m_gmTable[value];
+
+        if (modifiers[i] != NULL)
+            value = modifiers[i]->getValue(uchar(value));
+
+        postGM[i] = uchar(value);
+    }
+
+    if (m_passthrough)
+        htpMerge(postGM + address,
+                 reinterpret_cast<const uchar *>(m_passthroughValues->constData()) + address, range);
+}
+
 /************************************************************************
  * Patches
  ************************************************************************/
@@ -562,6 +728,8 @@ bool Universe::setInputPatch(QLCIOPlugin *plugin,
 {
     qDebug() << "[Universe] setInputPatch - ID:" << m_id << ", plugin:" << ((plugin == NULL)?"None":plugin->name())
              << ", input:" << input << ", profile:" << ((profile == NULL)?"None":profile->name());
+
+    QMutexLocker locker(&m_patchMutex);
     if (m_inputPatch == NULL)
     {
         if (plugin == NULL || input == QLCIOPlugin::invalidLine())
@@ -600,6 +768,8 @@ bool Universe::setOutputPatch(QLCIOPlugin *plugin, quint32 output, int index)
     qDebug() << "[Universe] setOutputPatch - ID:" << m_id
              << ", plugin:" << ((plugin == NULL) ? "None" : plugin->name()) << ", output:" << output;
 
+    QMutexLocker locker(&m_patchMutex);
+
     // replace or delete an existing patch
     if (index < m_outputPatchList.count())
     {
@@ -636,6 +806,8 @@ bool Universe::setOutputPatch(QLCIOPlugin *plugin, quint32 output, int index)
 bool Universe::setFeedbackPatch(QLCIOPlugin *plugin, quint32 output)
 {
     qDebug() << Q_FUNC_INFO << "plugin:" << plugin << "output:" << output;
+
+    QMutexLocker locker(&m_patchMutex);
     if (m_fbPatch == NULL)
     {
         if (plugin == NULL || output == QLCIOPlugin::invalidLine())
@@ -693,6 +865,7 @@ OutputPatch *Universe::feedbackPatch() const
 
 void Universe::dumpOutput(const QByteArray &data)
 {
+    QMutexLocker locker(&m_patchMutex);
     if (m_outputPatchList.count() == 0)
         return;
 
@@ -721,6 +894,7 @@ const QByteArray& Universe::blackoutData()
 
 void Universe::flushInput()
 {
+    QMutexLocker locker(&m_patchMutex);
     if (m_inputPatch == NULL)
         return;
 
@@ -1015,6 +1189,38 @@ bool Universe::writeBlended(int channel, uchar value, Universe::BlendMode blend)
     return true;
 }
 
+void Universe::writeHTPBatch(const int *channels, const uchar *values, int count)
+{
+    uchar *preGM = reinterpret_cast<uchar *>(m_preGMValues->data());
+    const char *mask = m_channelsMask->constData();
+    int usedChannels = m_usedChannels;
+    int first = UNIVERSE_SIZE;
+    int last = -1;
+
+    for (int i = 0; i < count; i++)
+    {
+        int channel = channels[i];
+        Q_ASSERT(channel < UNIVERSE_SIZE);
+
+        if (channel >= usedChannels)
+            usedChannels = channel + 1;
+
+        if ((mask[channel] & HTP) && values[i] < preGM[channel])
+            continue;
+
+        preGM[channel] = values[i];
+        if (channel < first)
+            first = channel;
+        if (channel > last)
+            last = channel;
+    }
+
+    m_usedChannels = ushort(usedChannels);
+
+    if (m_postGMDeferred == false && first <= last)
+        updatePostGMValues(first, last - first + 1);
+}
+
 /*********************************************************************
  * Load & Save
  *********************************************************************/
@@ -1087,6 +1293,15 @@ bool Universe::loadXML(QXmlStreamReader &root, int index, InputOutputMap *ioMap)
                 output = pAttrs.value(KXMLQLCUniverseLine).toString().toUInt();
             ioMap->setOutputPatch(index, plugin, output, false);
 
+            OutputPatch *op = outputPatch();
+            if (op != NULL)
+            {
+                if (pAttrs.hasAttribute(KXMLQLCUniverseKeepAlive))
+                    op->setKeepAliveInterval(pAttrs.value(KXMLQLCUniverseKeepAlive).toString().toInt());
+                if (pAttrs.hasAttribute(KXMLQLCUniverseMinInterval))
+                    op->setMinimumInterval(pAttrs.value(KXMLQLCUniverseMinInterval).toString().toInt());
+            }
+
             QXmlStreamReader::TokenType tType = root.readNext();
             if (tType == QXmlStreamReader::Characters)
                 tType = root.readNext();
@@ -1181,17 +1396,25 @@ bool Universe::saveXML(QXmlStreamWriter *doc) const
     if (inputPatch() != NULL)
     {
         savePatchXML(doc, KXMLQLCUniverseInputPatch, inputPatch()->pluginName(),
-            inputPatch()->input(), inputPatch()->profileName(), inputPatch()->getPluginParameters());
+            inputPatch()->input(), inputPatch()->profileName(), inputPatch()->getPluginParameters(),
+            QXmlStreamAttributes());
     }
     if (outputPatch() != NULL)
     {
+        QXmlStreamAttributes attributes;
+        if (outputPatch()->keepAliveInterval() != -1)
+            attributes.append(KXMLQLCUniverseKeepAlive, QString::number(outputPatch()->keepAliveInterval()));
+        if (outputPatch()->minimumInterval() != 0)
+            attributes.append(KXMLQLCUniverseMinInterval, QString::number(outputPatch()->minimumInterval()));
+
         savePatchXML(doc, KXMLQLCUniverseOutputPatch, outputPatch()->pluginName(),
-            outputPatch()->output(), "", outputPatch()->getPluginParameters());
+            outputPatch()->output(), "", outputPatch()->getPluginParameters(), attributes);
     }
     if (feedbackPatch() != NULL)
     {
         savePatchXML(doc, KXMLQLCUniverseFeedbackPatch, feedbackPatch()->pluginName(),
-            feedbackPatch()->output(), "", feedbackPatch()->getPluginParameters());
+            feedbackPatch()->output(), "", feedbackPatch()->getPluginParameters(),
+            QXmlStreamAttributes());
     }
 
     /* End the <Universe> tag */
@@ -1206,7 +1429,8 @@ void Universe::savePatchXML(
     const QString &pluginName,
     quint32 line,
     QString profileName,
-    QMap<QString, QVariant> parameters) const
+    QMap<QString, QVariant> parameters,
+    QXmlStreamAttributes const & attributes) const
 {
     // sanity check: don't save invalid data
     if (pluginName.isEmpty() || pluginName == KInputNone || line == QLCIOPlugin::invalidLine())
@@ -1217,6 +1441,7 @@ void Universe::savePatchXML(
     doc->writeAttribute(KXMLQLCUniverseLine, QString::number(line));
     if (!profileName.isEmpty() && profileName != KInputNone)
         doc->writeAttribute(KXMLQLCUniverseProfileName, profileName);
+    doc->writeAttributes(attributes);
 
     savePluginParametersXML(doc, parameters);
     doc->writeEndElement();
@@ -22,13 +22,16 @@
 #define UNIVERSE_H
 
 #include <QScopedPointer>
-#include <QSemaphore>
+#include <QAtomicInt>
 #include <QByteArray>
-#include <QThread>
+#include <QObject>
+#include <QVector>
+#include <QMutex>
 #include <QSet>
 
 #include "qlcchannel.h"
 
+class QXmlStreamAttributes;
 class QXmlStreamReader;
 class QLCInputProfile;
 class ChannelModifier;
@@ -46,6 +49,9 @@ class Doc;
 
 #define UNIVERSE_SIZE 512
 
+/** Number of channels represented by each bit of a changed blocks mask */
+#define UNIVERSE_BLOCK_SIZE (UNIVERSE_SIZE / 32)
+
 #define KXMLQLCUniverse "Universe"
 #define KXMLQLCUniverseName "Name"
 #define KXMLQLCUniverseID "ID"
@@ -59,10 +65,12 @@ class Doc;
 #define KXMLQLCUniverseLine "Line"
 #define KXMLQLCUniverseProfileName "Profile"
 #define KXMLQLCUniversePluginParameters "PluginParameters"
+#define KXMLQLCUniverseKeepAlive "KeepAlive"
+#define KXMLQLCUniverseMinInterval "MinInterval"
 
 /** Universe class contains input/output data for one DMX universe
  */
-class Universe: public QThread
+class Universe: public QObject
 {
     Q_OBJECT
     Q_DISABLE_COPY(Universe)
@@ -130,6 +138,19 @@ public:
      */
     bool hasChanged();
 
+    /**
+     * Returns a mask of the blocks of UNIVERSE_BLOCK_SIZE channels changed
+     * since the last MasterTimer tick, where bit N covers the channels
+     * from N * UNIVERSE_BLOCK_SIZE. Returns 0 if nothing changed.
+     */
+    quint32 changedBlocks();
+
+    /**
+     * Returns the mask of the blocks covering @a count channels
+     * starting from @a address
+     */
+    static quint32 blocksMask(quint32 address, quint32 count);
+
     /**
      * Enable or disable the passthrough mode for this universe
      */
@@ -173,6 +194,13 @@ protected:
     uchar applyModifiers(int channel, uchar value);
     void updatePostGMValue(int channel);
 
+    /** Compute the post-GM values of a range of channels in a single pass.
+     *  This is the block version of updatePostGMValue */
+    void updatePostGMValues(int address, int range);
+
+    /** Rebuild the Grand Master lookup table from the current GM settings */
+    void updateGMTable();
+
 signals:
     void nameChanged();
     void passthroughChanged();
@@ -188,6 +216,13 @@ protected:
     bool m_passthrough;
     /** Flag to monitor the universe changes */
     bool m_monitor;
+    /** Grand Master lookup table: the post-GM value of each DMX value */
+    uchar m_gmTable[256];
+    /** Cached GrandMaster::AllChannels mode flag */
+    bool m_gmAllChannels;
+    /** When true, post-GM values are computed in block by renderFaders,
+     *  so single channel writes don't need to update them */
+    bool m_postGMDeferred;
 
     /************************************************************************
      * Patches
@@ -279,6 +314,10 @@ private:
     /** Reference to the feedback patch associated to this universe. */
     OutputPatch *m_fbPatch;
 
+    /** Mutex guarding the patches, which are used by the universe
+     *  workers while the UI changes them */
+    QMutex m_patchMutex;
+
 private:
     // Connect to inputPatch's valueChanged signal
     void connectInputPatch();
@@ -359,28 +398,90 @@ public:
     /** Retrieve a modifiable list of the currently active faders */
     QList<QSharedPointer<GenericFader> > faders();
 
-public slots:
-    void tick();
+public:
+    /** Compose the values of this Universe for the current tick, by
+     *  flushing the input data and writing all the faders */
+    void renderFaders();
+
+    /** Send the values composed by renderFaders() to the output patches
+     *  and notify the listeners if anything changed */
+    void flushOutput();
 
 protected:
+    /** Render and flush one tick in a row */
     void processFaders();
 
-    /** DMX writer thread worker method */
-    void run();
-
 signals:
-    void universeWritten(quint32 universeID, const QByteArray& universeData);
+    /** Emitted when the output values changed. @a changedBlocks is the
+     *  mask of the changed channel blocks (see changedBlocks()) */
+    void universeWritten(quint32 universeID, const QByteArray& universeData,
+                         quint32 changedBlocks = UINT_MAX);
 
-protected:
-    QSemaphore m_semaphore;
+    /************************************************************************
+     * Snapshots
+     ************************************************************************/
+public:
+    /** The serial numbers of a frame and of the last change of each
+     *  of its channel blocks. Readers keep one to know what they've seen */
+    struct SnapshotCursor
+    {
+        SnapshotCursor()
+            : serial(0)
+        {
+            for (int i = 0; i < 32; i++)
+                blocks[i] = 0;
+        }
+
+        quint32 serial;
+        quint32 blocks[32];
+    };
+
+    /**
+     * Retrieve the latest frame published by flushOutput(). Frames are
+     * exchanged through a triple buffer, so the universe thread never waits
+     * for a reader, and a reader always gets the most recent frame, with
+     * the changes of the frames it didn't see coalesced.
+     *
+     * @param cursor The reader state, updated by this call
+     * @param values Filled with the frame values, if anything changed
+     * @return The mask of the blocks changed since the previous pull with
+     *         @a cursor, or 0 if nothing changed
+     */
+    quint32 pullSnapshot(SnapshotCursor &cursor, QByteArray &values);
+
+private:
+    /** Publish a frame to the snapshot readers */
+    void publishSnapshot(const QByteArray &frame, quint32 changedBlocks);
+
+private:
+    struct Snapshot
+    {
+        QByteArray values;
+        SnapshotCursor serials;
+    };
 
-    /** Indicated if the DMX writer worker thread is running */
-    bool m_running;
+    Snapshot m_snapshots[3];
+    /** Index of the snapshot written by the universe thread */
+    int m_snapshotBack;
+    /** Index of the snapshot read by the readers */
+    int m_snapshotFront;
+    /** Index of the latest published snapshot, plus SNAPSHOT_FRESH
+     *  if the readers haven't taken it yet */
+    QAtomicInt m_snapshotMiddle;
+    /** The serials of the latest frame written by the universe thread */
+    SnapshotCursor m_snapshotSerials;
+    /** Serializes the readers. Never taken by the universe thread */
+    QMutex m_snapshotReadMutex;
 
+protected:
     /** IMPORTANT: this is the list of faders that will compose
      *  the Universe values. The order is very important ! */
     QList<QSharedPointer<GenericFader> > m_faders;
 
+    /** Mutex guarding m_faders, as the universes are not locked
+     *  anymore while a tick is processed */
+    QMutex m_fadersMutex;
+
     /************************************************************************
      * Values
      ************************************************************************/
@@ -489,6 +590,11 @@ protected:
     /** Array of values from input line, when passtrhough is enabled */
     QScopedPointer<QByteArray> m_passthroughValues;
 
+    /** Double buffered frames sent to the output patches and to the
+     *  universeWritten listeners, to avoid allocating one every tick */
+    QByteArray m_outputFrames[2];
+    int m_outputFrameIndex;
+
     QVector<short> m_relativeValues;
 
     /* impl speedup */
@@ -550,6 +656,16 @@ public:
      */
     bool writeBlended(int channel, uchar value, BlendMode blend = NormalBlend);
 
+    /**
+     * Write a batch of values with a HTP check, as write() would do for
+     * each of them, in a single pass over the given arrays.
+     *
+     * @param channels Array of the channel numbers to write to
+     * @param values Array of the values to write
+     * @param count The number of elements in both arrays
+     */
+    void writeHTPBatch(const int *channels, const uchar *values, int count);
+
     /*********************************************************************
      * Load & Save
      *********************************************************************/
@@ -591,13 +707,15 @@ public:
      * @param line
      * @param profileName
      * @param parameters
+     * @param attributes additional patch attributes
      */
     void savePatchXML(QXmlStreamWriter *doc,
         QString const & tag,
         QString const & pluginName,
         quint32 line,
         QString profileName,
-        QMap<QString, QVariant>parameters) const;
+        QMap<QString, QVariant>parameters,
+        QXmlStreamAttributes const & attributes) const;
 
     /**
      * Save a plugin custom parameters (if available) into a tag nested
@@ -0,0 +1,105 @@
+/*
+  Q Light Controller Plus
+  universemonitor.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QDebug>
+
+#include "universemonitor.h"
+#include "inputoutputmap.h"
+
+UniverseMonitor::UniverseMonitor(InputOutputMap *ioMap, int rate, QObject *parent)
+    : QObject(parent)
+    , m_ioMap(ioMap)
+    , m_timer(this)
+    , m_rate(0)
+{
+    Q_ASSERT(ioMap != NULL);
+
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(slotTimeout()));
+
+    setRate(rate);
+}
+
+UniverseMonitor::~UniverseMonitor()
+{
+    m_timer.stop();
+}
+
+int UniverseMonitor::rate() const
+{
+    return m_rate;
+}
+
+void UniverseMonitor::setRate(int rate)
+{
+    m_rate = qMax(0, rate);
+
+    if (m_rate == 0)
+    {
+        m_timer.stop();
+        return;
+    }
+
+    m_timer.start(qMax(1, 1000 / m_rate));
+}
+
+void UniverseMonitor::pull()
+{
+    m_frames.resize(0);
+
+    {
+        UniverseSnapshotPtr snapshot = m_ioMap->universesSnapshot();
+        QList<Universe *> const& universes = snapshot->universes();
+
+        m_cursors.resize(universes.count());
+        m_universes.resize(universes.count());
+
+        for (int i = 0; i < universes.count(); i++)
+        {
+            Universe *universe = universes.at(i);
+
+            /* A universe was replaced: start over with the new one */
+            if (m_universes.at(i) != universe)
+            {
+                m_universes[i] = universe;
+                m_cursors[i] = Universe::SnapshotCursor();
+            }
+
+            Frame frame;
+            frame.changedBlocks = universe->pullSnapshot(m_cursors[i], frame.values);
+            if (frame.changedBlocks)
+            {
+                frame.universeID = universe->id();
+                m_frames.append(frame);
+            }
+        }
+    }
+
+    /* Emit with the snapshot released, since the receivers
+     * might as well change the universes list */
+    foreach (Frame const& frame, m_frames)
+        emit universeWritten(frame.universeID, frame.values, frame.changedBlocks);
+
+    m_frames.resize(0);
+}
+
+void UniverseMonitor::slotTimeout()
+{
+    pull();
+}
@@ -0,0 +1,103 @@
+/*
+  Q Light Controller Plus
+  universemonitor.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef UNIVERSEMONITOR_H
+#define UNIVERSEMONITOR_H
+
+#include <QObject>
+#include <QVector>
+#include <QTimer>
+
+#include "universe.h"
+
+class InputOutputMap;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** Default pull rate of a UniverseMonitor, in frames per second */
+#define UNIVERSEMONITOR_DEFAULT_RATE 25
+
+/**
+ * UniverseMonitor delivers the universe values to the UI at its own rate,
+ * instead of the MasterTimer one.
+ *
+ * Universes publish each changed frame into a triple buffer (see
+ * Universe::pullSnapshot). A monitor pulls the latest frame of every
+ * universe on a timer living in its own thread and emits universeWritten
+ * with the channel blocks changed since its previous pull, so the changes
+ * of the frames it skipped are coalesced. A slow consumer never stalls
+ * the engine and a fast engine doesn't flood the consumer event queue.
+ *
+ * Each consumer creates its own monitor with the rate it needs. Consumers
+ * with many instances (e.g. VC widgets) share one monitor and filter the
+ * universes they're interested in.
+ */
+class UniverseMonitor : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(UniverseMonitor)
+
+public:
+    UniverseMonitor(InputOutputMap *ioMap, int rate = UNIVERSEMONITOR_DEFAULT_RATE,
+                    QObject *parent = 0);
+    ~UniverseMonitor();
+
+    /** Get the pull rate, in frames per second */
+    int rate() const;
+
+    /** Set the pull rate, in frames per second. 0 stops pulling */
+    void setRate(int rate);
+
+    /** Pull the latest frames now, emitting universeWritten
+     *  for each universe changed since the previous pull */
+    void pull();
+
+signals:
+    void universeWritten(quint32 universeID, const QByteArray& universeData,
+                         quint32 changedBlocks);
+
+private slots:
+    void slotTimeout();
+
+private:
+    InputOutputMap *m_ioMap;
+    QTimer m_timer;
+    int m_rate;
+
+    /** What this monitor has seen of each universe, by universe index */
+    QVector<Universe::SnapshotCursor> m_cursors;
+    /** The universe instances m_cursors refer to */
+    QVector<Universe *> m_universes;
+
+    /** A frame pulled from a universe, waiting to be emitted */
+    typedef struct
+    {
+        quint32 universeID;
+        QByteArray values;
+        quint32 changedBlocks;
+    } Frame;
+
+    QVector<Frame> m_frames;
+};
+
+/** @} */
+
+#endif
@@ -0,0 +1,257 @@
+/*
+  Q Light Controller Plus
+  universeworkerpool.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QMutexLocker>
+#include <QSettings>
+#include <QDebug>
+
+#if defined(Q_OS_LINUX)
+#   include <pthread.h>
+#   include <sched.h>
+#endif
+
+#include "universeworkerpool.h"
+#include "universe.h"
+
+#define UNIVERSE_WORKER_THREADS "universes/workerthreads"
+#define UNIVERSE_WORKER_AFFINITY "universes/cpuaffinity"
+
+/****************************************************************************
+ * UniverseWorker
+ ****************************************************************************/
+
+UniverseWorker::UniverseWorker(UniverseWorkerPool *pool, int index)
+    : QThread()
+    , m_pool(pool)
+    , m_index(index)
+{
+    Q_ASSERT(pool != NULL);
+}
+
+void UniverseWorker::run()
+{
+#if defined(Q_OS_LINUX)
+    if (m_pool->cpuAffinity())
+    {
+        int cores = QThread::idealThreadCount();
+        if (cores > 0)
+        {
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            CPU_SET(m_index % cores, &cpuSet);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0)
+                qWarning() << "[UniverseWorker] Unable to pin worker" << m_index << "to core" << m_index % cores;
+        }
+    }
+#endif
+
+    quint64 lastBatch = 0;
+
+    while (true)
+    {
+        {
+            QMutexLocker locker(&m_pool->m_wakeMutex);
+            while (m_pool->m_running && m_pool->m_batchId == lastBatch)
+                m_pool->m_wakeCondition.wait(&m_pool->m_wakeMutex);
+
+            if (m_pool->m_running == false)
+                break;
+
+            lastBatch = m_pool->m_batchId;
+        }
+
+        m_pool->work(m_index);
+    }
+}
+
+/****************************************************************************
+ * UniverseWorkerPool
+ ****************************************************************************/
+
+UniverseWorkerPool::UniverseWorkerPool(int threadCount)
+    : m_threadCount(threadCount)
+    , m_cpuAffinity(false)
+    , m_running(false)
+    , m_phase(RenderPhase)
+    , m_pendingJobs(0)
+    , m_batchId(0)
+{
+    QSettings settings;
+
+    if (m_threadCount < 0)
+    {
+        QVariant var = settings.value(UNIVERSE_WORKER_THREADS);
+        if (var.isValid() == true)
+            m_threadCount = var.toInt();
+    }
+
+    /* The thread calling process() does its share of the work too */
+    if (m_threadCount < 0)
+        m_threadCount = qMax(0, QThread::idealThreadCount() - 1);
+
+    QVariant var = settings.value(UNIVERSE_WORKER_AFFINITY);
+    if (var.isValid() == true)
+        m_cpuAffinity = var.toBool();
+
+    for (int i = 0; i <= m_threadCount; i++)
+        m_queues.append(new JobQueue);
+}
+
+UniverseWorkerPool::~UniverseWorkerPool()
+{
+    stop();
+    qDeleteAll(m_queues);
+}
+
+void UniverseWorkerPool::start()
+{
+    if (m_running == true)
+        return;
+
+    m_running = true;
+
+    for (int i = 0; i < m_threadCount; i++)
+    {
+        UniverseWorker *worker = new UniverseWorker(this, i);
+        m_workers.append(worker);
+        worker->start();
+    }
+
+    qDebug() << "[UniverseWorkerPool] Started" << m_threadCount << "worker threads";
+}
+
+void UniverseWorkerPool::stop()
+{
+    if (m_running == false)
+        return;
+
+    {
+        QMutexLocker locker(&m_wakeMutex);
+        m_running = false;
+        m_wakeCondition.wakeAll();
+    }
+
+    foreach (UniverseWorker *worker, m_workers)
+    {
+        worker->wait();
+        delete worker;
+    }
+    m_workers.clear();
+
+    qDebug() << "[UniverseWorkerPool] Stopped";
+}
+
+bool UniverseWorkerPool::isRunning() const
+{
+    return m_running;
+}
+
+int UniverseWorkerPool::threadCount() const
+{
+    return m_threadCount;
+}
+
+void UniverseWorkerPool::setCpuAffinity(bool enable)
+{
+    m_cpuAffinity = enable;
+}
+
+bool UniverseWorkerPool::cpuAffinity() const
+{
+    return m_cpuAffinity;
+}
+
+void UniverseWorkerPool::process(const QList<Universe *> &universes)
+{
+    if (universes.isEmpty())
+        return;
+
+    runPhase(RenderPhase, universes);
+
+    /* At this point every Universe has its final values for this tick */
+
+    runPhase(FlushPhase, universes);
+}
+
+void UniverseWorkerPool::runPhase(UniverseWorkerPool::Phase phase, const QList<Universe *> &universes)
+{
+    m_phase = phase;
+    m_pendingJobs.storeRelease(universes.count());
+
+    for (int i = 0; i < universes.count(); i++)
+    {
+        JobQueue *queue = m_queues.at(i % m_queues.count());
+        QMutexLocker locker(&queue->m_mutex);
+        queue->m_jobs.append(universes.at(i));
+    }
+
+    if (m_workers.isEmpty() == false)
+    {
+        QMutexLocker locker(&m_wakeMutex);
+        m_batchId++;
+        m_wakeCondition.wakeAll();
+    }
+
+    /* The last queue belongs to the calling thread */
+    work(m_queues.count() - 1);
+
+    m_batchDone.acquire();
+}
+
+Universe *UniverseWorkerPool::takeJob(int index)
+{
+    /* Pop from the back of the own queue first */
+    {
+        JobQueue *queue = m_queues.at(index);
+        QMutexLocker locker(&queue->m_mutex);
+        if (queue->m_jobs.isEmpty() == false)
+        {
+            Universe *universe = queue->m_jobs.last();
+            queue->m_jobs.removeLast();
+            return universe;
+        }
+    }
+
+    /* Then steal from the front of the other queues */
+    for (int i = 1; i < m_queues.count(); i++)
+    {
+        JobQueue *queue = m_queues.at((index + i) % m_queues.count());
+        QMutexLocker locker(&queue->m_mutex);
+        if (queue->m_jobs.isEmpty() == false)
+            return queue->m_jobs.takeFirst();
+    }
+
+    return NULL;
+}
+
+void UniverseWorkerPool::work(int index)
+{
+    Universe *universe = NULL;
+
+    while ((universe = takeJob(index)) != NULL)
+    {
+        if (m_phase == RenderPhase)
+            universe->renderFaders();
+        else
+            universe->flushOutput();
+
+        if (m_pendingJobs.fetchAndAddOrdered(-1) == 1)
+            m_batchDone.release();
+    }
+}
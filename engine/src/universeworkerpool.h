@@ -0,0 +1,149 @@
+/*
+  Q Light Controller Plus
+  universeworkerpool.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef UNIVERSEWORKERPOOL_H
+#define UNIVERSEWORKERPOOL_H
+
+#include <QWaitCondition>
+#include <QSemaphore>
+#include <QAtomicInt>
+#include <QVector>
+#include <QThread>
+#include <QMutex>
+#include <QList>
+
+class UniverseWorkerPool;
+class Universe;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+class UniverseWorker : public QThread
+{
+public:
+    UniverseWorker(UniverseWorkerPool *pool, int index);
+
+protected:
+    /** Worker thread loop: sleep until a new job batch is posted */
+    void run();
+
+private:
+    UniverseWorkerPool *m_pool;
+    /** Index of this worker's job queue in the pool */
+    int m_index;
+};
+
+/**
+ * A fixed size pool of threads processing the Universes on every
+ * MasterTimer tick. Each worker owns a job queue and steals jobs
+ * from the other queues when its own is empty.
+ *
+ * A tick is processed in two phases: first all the Universes faders
+ * are rendered, then, once every Universe is done, all the outputs
+ * are flushed. This way every output patch gets a consistent frame.
+ */
+class UniverseWorkerPool
+{
+    Q_DISABLE_COPY(UniverseWorkerPool)
+
+    friend class UniverseWorker;
+
+public:
+    /**
+     * Create a new pool. If $threadCount is negative, the number
+     * of threads is read from the settings or derived from the
+     * number of available CPU cores.
+     */
+    UniverseWorkerPool(int threadCount = -1);
+    ~UniverseWorkerPool();
+
+    /** Start the worker threads */
+    void start();
+
+    /** Stop and join the worker threads */
+    void stop();
+
+    /** Returns true if the worker threads are running */
+    bool isRunning() const;
+
+    /** Returns the number of worker threads. The thread calling
+     *  process() acts as an additional worker */
+    int threadCount() const;
+
+    /** Enable/disable pinning of each worker thread to a CPU core.
+     *  This takes effect on the next start() */
+    void setCpuAffinity(bool enable);
+
+    /** Returns if the worker threads are pinned to CPU cores */
+    bool cpuAffinity() const;
+
+    /**
+     * Process one tick for the given list of Universes and return
+     * when all of them have been rendered and flushed.
+     */
+    void process(const QList<Universe *> &universes);
+
+private:
+    enum Phase
+    {
+        RenderPhase,
+        FlushPhase
+    };
+
+    /** Distribute one job per Universe and wait for all of them to complete */
+    void runPhase(Phase phase, const QList<Universe *> &universes);
+
+    /** Take a job from the queue at $index, or steal one from another queue */
+    Universe *takeJob(int index);
+
+    /** Process jobs until there's none left in any queue */
+    void work(int index);
+
+private:
+    struct JobQueue
+    {
+        QMutex m_mutex;
+        QVector<Universe *> m_jobs;
+    };
+
+    int m_threadCount;
+    bool m_cpuAffinity;
+    bool m_running;
+
+    QList<UniverseWorker *> m_workers;
+    /** One queue per worker, plus one for the calling thread */
+    QVector<JobQueue *> m_queues;
+
+    /** The phase the current job batch belongs to */
+    Phase m_phase;
+    /** Number of jobs of the current batch not completed yet */
+    QAtomicInt m_pendingJobs;
+    /** Released when the last job of a batch is completed */
+    QSemaphore m_batchDone;
+
+    /** Guards m_running and m_batchId and wakes up the workers */
+    QMutex m_wakeMutex;
+    QWaitCondition m_wakeCondition;
+    quint64 m_batchId;
+};
+
+/** @} */
+
+#endif
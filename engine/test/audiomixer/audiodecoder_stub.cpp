@@ -0,0 +1,93 @@
+/*
+  Q Light Controller Plus - Unit test
+  audiodecoder_stub.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "audiodecoder_stub.h"
+
+AudioDecoder_Stub::AudioDecoder_Stub(quint32 sampleRate, int channels, qint64 frames, qint16 value)
+    : m_channels(channels)
+    , m_frames(frames)
+    , m_value(value)
+    , m_position(0)
+    , m_framesRead(0)
+{
+    configure(sampleRate, channels, PCM_S16LE);
+}
+
+AudioDecoder_Stub::~AudioDecoder_Stub()
+{
+}
+
+qint16 AudioDecoder_Stub::sample(qint64 frame, int channel)
+{
+    qint16 value = qint16((frame % 8192) * 2);
+    return channel == 0 ? value : -value;
+}
+
+AudioDecoder *AudioDecoder_Stub::createCopy()
+{
+    return NULL;
+}
+
+int AudioDecoder_Stub::priority() const
+{
+    return 0;
+}
+
+QStringList AudioDecoder_Stub::supportedFormats()
+{
+    return QStringList();
+}
+
+bool AudioDecoder_Stub::initialize(const QString &path)
+{
+    Q_UNUSED(path)
+    return true;
+}
+
+qint64 AudioDecoder_Stub::totalTime()
+{
+    return m_frames * 1000 / audioParameters().sampleRate();
+}
+
+void AudioDecoder_Stub::seek(qint64 time)
+{
+    m_position = qMin(m_frames, time * audioParameters().sampleRate() / 1000);
+}
+
+qint64 AudioDecoder_Stub::read(char *data, qint64 maxSize)
+{
+    qint64 frames = qMin(maxSize / (m_channels * qint64(sizeof(qint16))), m_frames - m_position);
+    qint16 *out = (qint16 *)data;
+
+    for (qint64 i = 0; i < frames; i++)
+    {
+        for (int c = 0; c < m_channels; c++)
+            out[i * m_channels + c] = m_value ? m_value : sample(m_position + i, c);
+    }
+
+    m_position += frames;
+    m_framesRead += frames;
+
+    return frames * m_channels * sizeof(qint16);
+}
+
+int AudioDecoder_Stub::bitrate()
+{
+    return audioParameters().sampleRate() * m_channels * 16 / 1000;
+}
@@ -0,0 +1,58 @@
+/*
+  Q Light Controller Plus - Unit test
+  audiodecoder_stub.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef AUDIODECODER_STUB_H
+#define AUDIODECODER_STUB_H
+
+#include "audiodecoder.h"
+
+/**
+ * A 16 bit decoder producing $frames frames of either a constant $value,
+ * or a ramp (see sample()) when $value is 0
+ */
+class AudioDecoder_Stub : public AudioDecoder
+{
+public:
+    AudioDecoder_Stub(quint32 sampleRate, int channels, qint64 frames, qint16 value = 0);
+    ~AudioDecoder_Stub();
+
+    /** The ramp sample of $channel at $frame */
+    static qint16 sample(qint64 frame, int channel);
+
+    AudioDecoder *createCopy();
+    int priority() const;
+    QStringList supportedFormats();
+    bool initialize(const QString& path);
+    qint64 totalTime();
+    void seek(qint64 time);
+    qint64 read(char *data, qint64 maxSize);
+    int bitrate();
+
+    int m_channels;
+    qint64 m_frames;
+    qint16 m_value;
+
+    /** The next frame to be read */
+    qint64 m_position;
+
+    /** Number of frames read so far */
+    qint64 m_framesRead;
+};
+
+#endif
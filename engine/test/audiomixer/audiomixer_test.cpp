@@ -0,0 +1,324 @@
+/*
+  Q Light Controller Plus - Unit test
+  audiomixer_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QSignalSpy>
+#include <QtTest>
+
+#define private public
+#include "audiodecoder_stub.h"
+#include "audiomixer_test.h"
+#include "audiomixer.h"
+#include "mastertimer.h"
+#undef private
+
+/* The tests drive the mixer by hand: the feeder thread is stopped and
+ * no renderer is ever started, so feedVoices() and mix() are called
+ * here in place of the feeder and the renderer threads */
+
+static QVector<qint16> mixFrames(AudioMixer &mixer, int frames)
+{
+    QVector<qint16> data(frames * AUDIOMIXER_CHANNELS);
+    mixer.mix(data.data(), frames);
+    return data;
+}
+
+void AudioMixer_Test::commandQueue()
+{
+    AudioMixer mixer(QString());
+    mixer.stopFeeder();
+
+    AudioMixer::Command command;
+    command.type = AudioMixer::SetGain;
+    command.voiceId = 42;
+    command.voice = NULL;
+    command.value = 0.5;
+    command.frames = 0;
+
+    for (int i = 0; i < AUDIOMIXER_QUEUE_SIZE; i++)
+        QVERIFY(mixer.postCommand(command) == true);
+
+    /* Full */
+    QVERIFY(mixer.postCommand(command) == false);
+
+    /* Commands for unknown voices are dropped */
+    mixer.processCommands();
+    QCOMPARE(mixer.m_queueTail, quint32(AUDIOMIXER_QUEUE_SIZE));
+    QCOMPARE(mixer.m_mixing.count(), 0);
+
+    /* The cells are reused once consumed */
+    QVERIFY(mixer.postCommand(command) == true);
+    QVERIFY(mixer.postCommand(command) == true);
+    mixer.processCommands();
+    QCOMPARE(mixer.m_queueTail, quint32(AUDIOMIXER_QUEUE_SIZE + 2));
+
+    /* Nothing left */
+    mixer.processCommands();
+    QCOMPARE(mixer.m_queueTail, quint32(AUDIOMIXER_QUEUE_SIZE + 2));
+}
+
+void AudioMixer_Test::addVoice()
+{
+    AudioMixer mixer(QString());
+    mixer.stopFeeder();
+
+    QVERIFY(mixer.addVoice(NULL, 0, 1.0, 0, false) == AudioMixer::invalidVoice());
+
+    AudioDecoder_Stub invalid(0, 2, 1000);
+    QVERIFY(mixer.addVoice(&invalid, 0, 1.0, 0, false) == AudioMixer::invalidVoice());
+
+    AudioDecoder_Stub decoder(AUDIOMIXER_SAMPLE_RATE, 2, 100000);
+    quint32 voice = mixer.addVoice(&decoder, 0, 1.0, 0, false);
+    QVERIFY(voice != AudioMixer::invalidVoice());
+
+    /* Nothing is decoded nor posted by the caller */
+    QCOMPARE(decoder.m_framesRead, qint64(0));
+    QCOMPARE(mixer.m_queueHead.load(), quint32(0));
+    QCOMPARE(mixer.m_voices.count(), 0);
+    QVERIFY(mixer.m_pendingVoices.load() != NULL);
+
+    /* The feeder takes the voice in, prebuffers it and hands it to the mixer */
+    QVERIFY(mixer.feedVoices() == true);
+    QVERIFY(mixer.m_pendingVoices.load() == NULL);
+    QCOMPARE(mixer.m_voices.count(), 1);
+    QCOMPARE(decoder.m_framesRead, qint64(AUDIOMIXER_PREBUFFER_FRAMES));
+    QCOMPARE(mixer.m_queueHead.load(), quint32(1));
+
+    mixer.processCommands();
+    QCOMPARE(mixer.m_mixing.count(), 1);
+
+    /* Once handed over, the voice is fed further ahead */
+    QVERIFY(mixer.feedVoices() == true);
+    QCOMPARE(decoder.m_framesRead, qint64(AUDIOMIXER_FEED_FRAMES));
+    QCOMPARE(mixer.m_queueHead.load(), quint32(1));
+
+    /* Removed voices are dropped by the mixer, then released by the feeder */
+    QSignalSpy spy(&mixer, SIGNAL(voiceReleased(quint32,bool)));
+    mixer.removeVoice(voice);
+    mixFrames(mixer, 1024);
+    QCOMPARE(mixer.m_mixing.count(), 0);
+
+    QVERIFY(mixer.feedVoices() == false);
+    QCOMPARE(mixer.m_voices.count(), 0);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toUInt(), voice);
+    QCOMPARE(spy.at(0).at(1).toBool(), false);
+}
+
+void AudioMixer_Test::removePendingVoice()
+{
+    AudioMixer mixer(QString());
+    mixer.stopFeeder();
+
+    AudioDecoder_Stub decoder1(AUDIOMIXER_SAMPLE_RATE, 2, 100000);
+    AudioDecoder_Stub decoder2(AUDIOMIXER_SAMPLE_RATE, 2, 100000);
+    quint32 voice1 = mixer.addVoice(&decoder1, 0, 1.0, 0, false);
+    quint32 voice2 = mixer.addVoice(&decoder2, 0, 1.0, 0, false);
+    QVERIFY(voice1 != voice2);
+
+    /* Removed before the feeder took it in: it never reaches the mixer */
+    QSignalSpy spy(&mixer, SIGNAL(voiceReleased(quint32,bool)));
+    mixer.removeVoice(voice1);
+
+    QVERIFY(mixer.feedVoices() == true);
+    QCOMPARE(decoder1.m_framesRead, qint64(0));
+    QCOMPARE(decoder2.m_framesRead, qint64(AUDIOMIXER_PREBUFFER_FRAMES));
+    QCOMPARE(mixer.m_queueHead.load(), quint32(1));
+
+    QVERIFY(mixer.feedVoices() == true);
+    QCOMPARE(mixer.m_voices.count(), 1);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toUInt(), voice1);
+    QCOMPARE(spy.at(0).at(1).toBool(), false);
+}
+
+void AudioMixer_Test::ringBuffer()
+{
+    AudioMixer mixer(QString());
+    mixer.stopFeeder();
+
+    /* Long enough to wrap the voice buffer twice */
+    qint64 length = 150000;
+    AudioDecoder_Stub decoder(AUDIOMIXER_SAMPLE_RATE, 2, length);
+    quint32 voice = mixer.addVoice(&decoder, 0, 1.0, 0, false);
+    QVERIFY(mixer.feedVoices() == true);
+
+    QSignalSpy spy(&mixer, SIGNAL(voiceReleased(quint32,bool)));
+
+    qint64 frame = 0;
+    while (frame < length + 4096)
+    {
+        for (int b = 0; b < 4; b++)
+        {
+            QVector<qint16> data = mixFrames(mixer, 1024);
+            for (int i = 0; i < 1024; i++, frame++)
+            {
+                for (int c = 0; c < AUDIOMIXER_CHANNELS; c++)
+                {
+                    qint16 expected = frame < length ? AudioDecoder_Stub::sample(frame, c) : 0;
+                    if (data[i * AUDIOMIXER_CHANNELS + c] != expected)
+                        QFAIL(QString("Frame %1 channel %2: %3 instead of %4").arg(frame).arg(c)
+                              .arg(data[i * AUDIOMIXER_CHANNELS + c]).arg(expected).toUtf8().constData());
+                }
+            }
+        }
+
+        mixer.feedVoices();
+    }
+
+    QCOMPARE(decoder.m_framesRead, length);
+    QCOMPARE(mixer.m_mixing.count(), 0);
+    QCOMPARE(mixer.m_voices.count(), 0);
+    QCOMPARE(mixer.framesMixed(), quint32(frame));
+
+    /* The voice has played until its end */
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toUInt(), voice);
+    QCOMPARE(spy.at(0).at(1).toBool(), true);
+}
+
+void AudioMixer_Test::gainRamp()
+{
+    AudioMixer mixer(QString());
+    mixer.stopFeeder();
+
+    /* 100ms fade in */
+    AudioDecoder_Stub decoder(AUDIOMIXER_SAMPLE_RATE, 2, 1000000, 10000);
+    quint32 voice = mixer.addVoice(&decoder, 0, 1.0, 100, false);
+    QVERIFY(mixer.feedVoices() == true);
+
+    int rampFrames = AUDIOMIXER_SAMPLE_RATE / 10;
+    QVector<qint16> data = mixFrames(mixer, 8192);
+    QCOMPARE(data[0], qint16(0));
+    QVERIFY(qAbs(data[(rampFrames / 2) * AUDIOMIXER_CHANNELS] - 5000) <= 1);
+    for (int i = 1; i < rampFrames; i++)
+        QVERIFY(data[i * AUDIOMIXER_CHANNELS] >= data[(i - 1) * AUDIOMIXER_CHANNELS]);
+    for (int i = rampFrames; i < 8192; i++)
+    {
+        QCOMPARE(data[i * AUDIOMIXER_CHANNELS], qint16(10000));
+        QCOMPARE(data[i * AUDIOMIXER_CHANNELS + 1], qint16(10000));
+    }
+
+    /* Immediate change */
+    mixer.setVoiceGain(voice, 0.5, 0);
+    mixer.feedVoices();
+    data = mixFrames(mixer, 1024);
+    QCOMPARE(data[0], qint16(5000));
+    QCOMPARE(data[1023 * AUDIOMIXER_CHANNELS], qint16(5000));
+
+    /* 10ms fade out */
+    mixer.setVoiceGain(voice, 0.0, 10);
+    rampFrames = AUDIOMIXER_SAMPLE_RATE / 100;
+    mixer.feedVoices();
+    data = mixFrames(mixer, 1024);
+    QVERIFY(qAbs(data[0] - 5000) <= 1);
+    QVERIFY(qAbs(data[(rampFrames / 2) * AUDIOMIXER_CHANNELS] - (5000 - 5000 * (rampFrames / 2) / rampFrames)) <= 1);
+    for (int i = 1; i < rampFrames; i++)
+        QVERIFY(data[i * AUDIOMIXER_CHANNELS] <= data[(i - 1) * AUDIOMIXER_CHANNELS]);
+    for (int i = rampFrames; i < 1024; i++)
+        QCOMPARE(data[i * AUDIOMIXER_CHANNELS], qint16(0));
+
+    /* A paused voice doesn't consume its frames */
+    mixer.setVoiceGain(voice, 1.0, 0);
+    mixer.setVoicePaused(voice, true);
+    mixer.feedVoices();
+    qint64 framesRead = decoder.m_framesRead;
+    data = mixFrames(mixer, 1024);
+    QCOMPARE(data[0], qint16(0));
+    mixer.feedVoices();
+    QCOMPARE(decoder.m_framesRead, framesRead);
+
+    mixer.setVoicePaused(voice, false);
+    data = mixFrames(mixer, 1024);
+    QCOMPARE(data[0], qint16(10000));
+}
+
+void AudioMixer_Test::resampler()
+{
+    AudioMixer mixer(QString());
+    mixer.stopFeeder();
+
+    /* A mono ramp at half the mixer rate: each frame is played twice as
+     * long, the frames in between being interpolated. Mono is played on
+     * both channels */
+    AudioDecoder_Stub decoder(AUDIOMIXER_SAMPLE_RATE / 2, 1, 100000);
+    mixer.addVoice(&decoder, 0, 1.0, 0, false);
+    QVERIFY(mixer.feedVoices() == true);
+
+    /* sample(n) is 2 * n, so the mixer frame k is k, across
+     * the decoder chunks too */
+    QVector<qint16> data = mixFrames(mixer, 8000);
+    for (int k = 0; k < 8000; k++)
+    {
+        QCOMPARE(data[k * AUDIOMIXER_CHANNELS], qint16(k));
+        QCOMPARE(data[k * AUDIOMIXER_CHANNELS + 1], qint16(k));
+    }
+}
+
+void AudioMixer_Test::startFrame()
+{
+    AudioMixer mixer(QString());
+    mixer.stopFeeder();
+
+    quint32 framesPerTick = AUDIOMIXER_SAMPLE_RATE / MasterTimer::frequency();
+
+    /* Anchored on the mixer clock, then one tick apart */
+    quint32 first = mixer.startFrame(10);
+    QCOMPARE(first, quint32(AUDIOMIXER_START_LATENCY));
+    QCOMPARE(mixer.startFrame(10), first);
+    QCOMPARE(mixer.startFrame(11), first + framesPerTick);
+
+    /* Two voices of the same tick start on the same sample */
+    quint32 start = mixer.startFrame(11);
+    AudioDecoder_Stub decoder1(AUDIOMIXER_SAMPLE_RATE, 2, 100000, 1000);
+    AudioDecoder_Stub decoder2(AUDIOMIXER_SAMPLE_RATE, 2, 100000, 2000);
+    mixer.addVoice(&decoder1, start, 1.0, 0, false);
+    mixer.addVoice(&decoder2, start, 1.0, 0, false);
+    QVERIFY(mixer.feedVoices() == true);
+
+    QVector<qint16> data = mixFrames(mixer, 4096);
+    QCOMPARE(data[(start - 1) * AUDIOMIXER_CHANNELS], qint16(0));
+    QCOMPARE(data[start * AUDIOMIXER_CHANNELS], qint16(3000));
+    QCOMPARE(data[4095 * AUDIOMIXER_CHANNELS], qint16(3000));
+
+    /* The mixer went past the scheduled frames: re-anchor */
+    QCOMPARE(mixer.startFrame(12), quint32(4096 + AUDIOMIXER_START_LATENCY));
+}
+
+void AudioMixer_Test::lateStart()
+{
+    AudioMixer mixer(QString());
+    mixer.stopFeeder();
+
+    mixFrames(mixer, 4096);
+
+    /* A voice scheduled 100 frames ago, prebuffered late, plays from
+     * the frame it should be at by now */
+    AudioDecoder_Stub decoder(AUDIOMIXER_SAMPLE_RATE, 2, 100000);
+    mixer.addVoice(&decoder, 4096 - 100, 1.0, 0, false);
+    QVERIFY(mixer.feedVoices() == true);
+
+    QVector<qint16> data = mixFrames(mixer, 1024);
+    for (int i = 0; i < 1024; i++)
+    {
+        QCOMPARE(data[i * AUDIOMIXER_CHANNELS], AudioDecoder_Stub::sample(100 + i, 0));
+        QCOMPARE(data[i * AUDIOMIXER_CHANNELS + 1], AudioDecoder_Stub::sample(100 + i, 1));
+    }
+}
+
+QTEST_MAIN(AudioMixer_Test)
@@ -407,6 +407,50 @@ void Doc_Test::fixture()
     QVERIFY(m_doc->fixture(Fixture::invalidId()) == NULL);
 }
 
+void Doc_Test::fixturesInBlocks()
+{
+    Fixture *f1 = new Fixture(m_doc);
+    f1->setChannels(5);
+    f1->setAddress(0);
+    f1->setUniverse(0);
+    m_doc->addFixture(f1);
+
+    Fixture *f2 = new Fixture(m_doc);
+    f2->setChannels(20);
+    f2->setAddress(20);
+    f2->setUniverse(0);
+    m_doc->addFixture(f2);
+
+    Fixture *f3 = new Fixture(m_doc);
+    f3->setChannels(12);
+    f3->setAddress(500);
+    f3->setUniverse(0);
+    m_doc->addFixture(f3);
+
+    /* The first query after a layout change returns everything */
+    QCOMPARE(m_doc->fixturesInBlocks(0, 0), QList<Fixture*>() << f1 << f2 << f3);
+    QCOMPARE(m_doc->fixturesInBlocks(0, 0), QList<Fixture*>());
+
+    QCOMPARE(m_doc->fixturesInBlocks(0, 1 << 0), QList<Fixture*>() << f1);
+    QCOMPARE(m_doc->fixturesInBlocks(0, 1 << 1), QList<Fixture*>() << f2);
+    QCOMPARE(m_doc->fixturesInBlocks(0, 1 << 2), QList<Fixture*>() << f2);
+    QCOMPARE(m_doc->fixturesInBlocks(0, 1 << 3), QList<Fixture*>());
+    QCOMPARE(m_doc->fixturesInBlocks(0, 1u << 31), QList<Fixture*>() << f3);
+    QCOMPARE(m_doc->fixturesInBlocks(0, (1 << 0) | (1u << 31)), QList<Fixture*>() << f1 << f3);
+    QCOMPARE(m_doc->fixturesInBlocks(1, UINT_MAX), QList<Fixture*>());
+
+    /* Moving a fixture rebuilds the index */
+    f1->setAddress(100);
+    QCOMPARE(m_doc->fixturesInBlocks(0, 0), QList<Fixture*>() << f1 << f2 << f3);
+    QCOMPARE(m_doc->fixturesInBlocks(0, 1 << 0), QList<Fixture*>());
+    QCOMPARE(m_doc->fixturesInBlocks(0, 1 << 6), QList<Fixture*>() << f1);
+
+    /* Deleting a fixture too */
+    m_doc->deleteFixture(f2->id());
+    QCOMPARE(m_doc->fixturesInBlocks(0, 0), QList<Fixture*>() << f1 << f3);
+    QCOMPARE(m_doc->fixturesInBlocks(0, 1 << 1), QList<Fixture*>());
+}
+
 void Doc_Test::totalPowerConsumption()
 {
     int fuzzy = 0;
@@ -46,6 +46,7 @@ private slots:
     void deleteFixture();
     void replaceFixtures();
     void fixture();
+    void fixturesInBlocks();
     void totalPowerConsumption();
 
     void addFixtureGroup();
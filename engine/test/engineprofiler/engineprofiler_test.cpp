@@ -0,0 +1,174 @@
+/*
+  Q Light Controller Plus - Unit tests
+  engineprofiler_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "engineprofiler_test.h"
+#include "engineprofiler.h"
+
+void EngineProfiler_Test::cleanup()
+{
+    EngineProfiler::instance()->setEnabled(false);
+    EngineProfiler::instance()->reset();
+}
+
+void EngineProfiler_Test::disabled()
+{
+    EngineProfiler *profiler = EngineProfiler::instance();
+    QVERIFY(profiler->isEnabled() == false);
+
+    profiler->record(EngineProfiler::TickStage, 0, 1000);
+    QVERIFY(profiler->summaries().isEmpty());
+}
+
+void EngineProfiler_Test::summary()
+{
+    EngineProfiler *profiler = EngineProfiler::instance();
+    profiler->setEnabled(true);
+    QVERIFY(profiler->isEnabled() == true);
+
+    for (int i = 1; i <= 100; i++)
+        profiler->record(EngineProfiler::FunctionWriteStage, 42, i * 1000);
+    profiler->record(EngineProfiler::FadersStage, 3, 500);
+
+    QList<EngineProfiler::Summary> list = profiler->summaries();
+    QCOMPARE(list.count(), 2);
+
+    foreach (EngineProfiler::Summary summary, list)
+    {
+        if (summary.stage == EngineProfiler::FunctionWriteStage)
+        {
+            QCOMPARE(summary.id, quint32(42));
+            QCOMPARE(summary.count, 100);
+            QCOMPARE(summary.p50, qint64(50000));
+            QCOMPARE(summary.p99, qint64(99000));
+            QCOMPARE(summary.max, qint64(100000));
+        }
+        else
+        {
+            QCOMPARE(summary.stage, EngineProfiler::FadersStage);
+            QCOMPARE(summary.id, quint32(3));
+            QCOMPARE(summary.count, 1);
+            QCOMPARE(summary.p50, qint64(500));
+            QCOMPARE(summary.p99, qint64(500));
+            QCOMPARE(summary.max, qint64(500));
+        }
+    }
+}
+
+void EngineProfiler_Test::ringWrap()
+{
+    EngineProfiler *profiler = EngineProfiler::instance();
+    profiler->setEnabled(true);
+
+    /* Only the latest samples are summarized */
+    for (int i = 0; i < 1000; i++)
+        profiler->record(EngineProfiler::OutputStage, 1, i < 500 ? 1000000 : 10);
+
+    QList<EngineProfiler::Summary> list = profiler->summaries();
+    QCOMPARE(list.count(), 1);
+    QCOMPARE(list.first().count, 256);
+    QCOMPARE(list.first().max, qint64(10));
+}
+
+void EngineProfiler_Test::reset()
+{
+    EngineProfiler *profiler = EngineProfiler::instance();
+    profiler->setEnabled(true);
+
+    profiler->record(EngineProfiler::DMXSourcesStage, 0, 1000);
+    QCOMPARE(profiler->summaries().count(), 1);
+
+    profiler->reset();
+    QVERIFY(profiler->summaries().isEmpty());
+
+    profiler->record(EngineProfiler::DMXSourcesStage, 0, 2000);
+    QCOMPARE(profiler->summaries().count(), 1);
+    QCOMPARE(profiler->summaries().first().max, qint64(2000));
+}
+
+void EngineProfiler_Test::capacity()
+{
+    EngineProfiler *profiler = EngineProfiler::instance();
+    profiler->setCapacity(100);
+    QCOMPARE(profiler->capacity(), 128);
+    profiler->setEnabled(true);
+
+    /* Entities beyond the table capacity are dropped and counted */
+    for (quint32 id = 0; id < 1000; id++)
+        profiler->record(EngineProfiler::FunctionWriteStage, id, 1000);
+
+    int profiled = profiler->summaries().count();
+    QVERIFY(profiled <= 128);
+    QVERIFY(profiler->droppedEntities() > 0);
+    QCOMPARE(profiled + profiler->droppedEntities(), 1000);
+
+    profiler->reset();
+    QCOMPARE(profiler->droppedEntities(), 0);
+
+    profiler->setCapacity(ENGINEPROFILER_DEFAULT_ENTITIES);
+    QCOMPARE(profiler->capacity(), ENGINEPROFILER_DEFAULT_ENTITIES);
+    QVERIFY(profiler->summaries().isEmpty());
+}
+
+void EngineProfiler_Test::release()
+{
+    EngineProfiler *profiler = EngineProfiler::instance();
+    profiler->setEnabled(true);
+
+    profiler->record(EngineProfiler::FunctionWriteStage, 1, 1000);
+    profiler->record(EngineProfiler::FunctionWriteStage, 2, 2000);
+    QCOMPARE(profiler->summaries().count(), 2);
+
+    profiler->release(EngineProfiler::FunctionWriteStage, 1);
+    QCOMPARE(profiler->summaries().count(), 1);
+    QCOMPARE(profiler->summaries().first().id, quint32(2));
+
+    /* The released slot can be claimed again */
+    profiler->record(EngineProfiler::FunctionWriteStage, 1, 3000);
+    QCOMPARE(profiler->summaries().count(), 2);
+
+    profiler->release(EngineProfiler::FunctionWriteStage, 1);
+    profiler->release(EngineProfiler::FunctionWriteStage, 2);
+    profiler->release(EngineProfiler::FunctionWriteStage, 3);
+    QVERIFY(profiler->summaries().isEmpty());
+}
+
+void EngineProfiler_Test::scope()
+{
+    EngineProfiler *profiler = EngineProfiler::instance();
+
+    {
+        EngineProfilerScope scope(EngineProfiler::TickStage);
+    }
+    QVERIFY(profiler->summaries().isEmpty());
+
+    profiler->setEnabled(true);
+    {
+        EngineProfilerScope scope(EngineProfiler::TickStage);
+        QTest::qSleep(2);
+    }
+
+    QList<EngineProfiler::Summary> list = profiler->summaries();
+    QCOMPARE(list.count(), 1);
+    QCOMPARE(list.first().stage, EngineProfiler::TickStage);
+    QVERIFY(list.first().max >= 1000000);
+}
+
+QTEST_APPLESS_MAIN(EngineProfiler_Test)
@@ -392,4 +392,30 @@ void FadeChannel_Test::calculateCurrent()
     QCOMPARE(fch.calculateCurrent(200, 200), uchar(101));
 }
 
+void FadeChannel_Test::current16()
+{
+    FadeChannel fc;
+    fc.setStart(0);
+    fc.setTarget(1);
+    fc.setFadeTime(MasterTimer::tick() * 256);
+
+    // 0x0000 -> 0x01FF in 256 steps: the LSB moves while the MSB barely does
+    fc.nextStep(MasterTimer::tick());
+    QCOMPARE(fc.current16(0, 0xFF), quint16(1));
+    QCOMPARE(fc.current(), uchar(0));
+
+    for (int i = 1; i < 128; i++)
+        fc.nextStep(MasterTimer::tick());
+    QCOMPARE(fc.current16(0, 0xFF), quint16(0xFF));
+
+    for (int i = 128; i < 256; i++)
+        fc.nextStep(MasterTimer::tick());
+    QCOMPARE(fc.isReady(), true);
+    QCOMPARE(fc.current16(0, 0xFF), quint16(0x01FF));
+
+    fc.setElapsed(0);
+    fc.setReady(false);
+    QCOMPARE(fc.current16(0x80, 0xFF), quint16(0x0080));
+}
+
 QTEST_APPLESS_MAIN(FadeChannel_Test)
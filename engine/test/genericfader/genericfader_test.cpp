@@ -22,7 +22,6 @@
 #include "genericfader_test.h"
 #include "qlcfixturemode.h"
 #include "qlcfixturedef.h"
-#include "fadechannel.h"
 #include "qlcchannel.h"
 #include "universe.h"
 #include "qlcfile.h"
@@ -30,6 +29,7 @@
 
 #define private public
 #include "genericfader.h"
+#include "fadechannel.h"
 #undef private
 
 #include "../common/resource_paths.h"
@@ -173,6 +173,88 @@ void GenericFader_Test::writeLoop()
     }
 }
 
+void GenericFader_Test::writeFinePair()
+{
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
+
+    /* Both channels orders, so the LSB is processed first at least once */
+    for (quint32 msb = 0; msb < 2; msb++)
+    {
+        quint32 lsb = 1 - msb;
+        QSharedPointer<GenericFader> fader = ua[0]->requestFader();
+
+        FadeChannel coarse;
+        coarse.setFixture(m_doc, 0);
+        coarse.setChannel(m_doc, msb);
+        coarse.setFlags(coarse.flags() | FadeChannel::Coarse);
+        coarse.m_pairedChannel = lsb;
+        coarse.setStart(0);
+        coarse.setTarget(0x12);
+        coarse.setFadeTime(0);
+
+        FadeChannel fine;
+        fine.setFixture(m_doc, 0);
+        fine.setChannel(m_doc, lsb);
+        fine.setFlags(fine.flags() | FadeChannel::Fine | FadeChannel::Autoremove);
+        fine.m_pairedChannel = msb;
+        fine.setStart(0);
+        fine.setTarget(0x34);
+        fine.setFadeTime(0);
+
+        fader->add(coarse);
+        fader->add(fine);
+        fader->write(ua[0]);
+
+        /* The autoremoved LSB is still written along with its MSB */
+        QCOMPARE(uchar(ua[0]->preGMValues()[10 + msb]), uchar(0x12));
+        QCOMPARE(uchar(ua[0]->preGMValues()[10 + lsb]), uchar(0x34));
+        QCOMPARE(fader->channelsCount(), 1);
+
+        ua[0]->dismissFader(fader);
+        ua[0]->reset();
+    }
+}
+
+void GenericFader_Test::keepZeroChannels()
+{
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
+    QSharedPointer<GenericFader> fader = ua[0]->requestFader();
+
+    FadeChannel fc;
+    fc.setFixture(m_doc, 0);
+    fc.setChannel(m_doc, 5);
+    fc.setStart(0);
+    fc.setTarget(0);
+    fc.setFadeTime(0);
+
+    /* A dark HTP intensity channel is dropped by default */
+    fader->add(fc);
+    uint generation = fader->channelsGeneration();
+    fader->write(ua[0]);
+    QCOMPARE(fader->channels().count(), 0);
+    QVERIFY(fader->channelsGeneration() != generation);
+
+    /* ...but kept when requested, along with the pointers to it */
+    fader->setKeepZeroChannels(true);
+    FadeChannel *ptr = fader->getChannelFader(m_doc, ua[0], 0, 5);
+    ptr->setTarget(0);
+    generation = fader->channelsGeneration();
+    fader->write(ua[0]);
+    fader->write(ua[0]);
+    QCOMPARE(fader->channels().count(), 1);
+    QCOMPARE(fader->channelsGeneration(), generation);
+    QVERIFY(fader->getChannelFader(m_doc, ua[0], 0, 5) == ptr);
+
+    /* Adding channels doesn't invalidate the pointers */
+    fader->getChannelFader(m_doc, ua[0], 0, 6);
+    QCOMPARE(fader->channelsGeneration(), generation);
+
+    /* A fader fading out still drops them */
+    fader->setFadeOut(true, 0);
+    fader->write(ua[0]);
+    QVERIFY(fader->channelsGeneration() != generation);
+}
+
 void GenericFader_Test::adjustIntensity()
 {
     QList<Universe*> ua = m_doc->inputOutputMap()->universes();
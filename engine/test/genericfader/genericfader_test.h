@@ -35,6 +35,8 @@ private slots:
     void addRemove();
     void writeZeroFade();
     void writeLoop();
+    void writeFinePair();
+    void keepZeroChannels();
     void adjustIntensity();
 
 private:
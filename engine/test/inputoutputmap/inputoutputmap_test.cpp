@@ -17,6 +17,7 @@
   limitations under the License.
 */
 #include <QSignalSpy>
+#include <QPointer>
 #include <QtTest>
 
 #define private public
@@ -679,6 +680,87 @@ void InputOutputMap_Test::claimReleaseDumpReset()
     }
 }
 
+void InputOutputMap_Test::claimSnapshot()
+{
+    InputOutputMap iom(m_doc, 4);
+
+    /* Claiming never waits for the writers */
+    iom.m_universeMutex.lock();
+    QList<Universe*> unis = iom.claimUniverses();
+    QCOMPARE(unis.count(), 4);
+    QVERIFY(iom.universesSnapshot() == iom.m_claimedSnapshot);
+    iom.releaseUniverses(false);
+    iom.m_universeMutex.unlock();
+
+    QVERIFY(iom.m_claimedSnapshot.isNull());
+    QVERIFY(iom.m_universeChanged.loadAcquire() == 0);
+
+    /* A snapshot taken before a change keeps its content */
+    UniverseSnapshotPtr older = iom.universesSnapshot();
+    QVERIFY(iom.addUniverse() == true);
+    QCOMPARE(older->universes().count(), 4);
+    QCOMPARE(iom.universesSnapshot()->universes().count(), 5);
+
+    unis = iom.claimUniverses();
+    QCOMPARE(unis.count(), 5);
+    QVERIFY(unis == iom.universes());
+    iom.releaseUniverses(false);
+
+    /* A removed universe lives as long as any snapshot taken before
+     * its removal, without the writer waiting for them */
+    UniverseSnapshotPtr newer = iom.universesSnapshot();
+    QPointer<Universe> removed(newer->universes().at(4));
+    QVERIFY(iom.removeUniverse(4) == true);
+    QCOMPARE(iom.universesSnapshot()->universes().count(), 4);
+    QVERIFY(removed.isNull() == false);
+
+    newer.clear();
+    QVERIFY(removed.isNull() == false);
+    older.clear();
+    QVERIFY(removed.isNull() == true);
+
+    QVERIFY(iom.removeAllUniverses() == true);
+    unis = iom.claimUniverses();
+    QCOMPARE(unis.count(), 0);
+    iom.releaseUniverses(false);
+}
+
+void InputOutputMap_Test::channelsChanges()
+{
+    InputOutputMap iom(m_doc, 4);
+
+    InputOutputMap::ChannelSetup setup;
+    setup.address = 5;
+    setup.group = QLCChannel::Intensity;
+    setup.forcedType = Universe::LTP;
+    setup.defaultValue = 0;
+    setup.modifier = NULL;
+
+    /* Without a running MasterTimer, changes are applied right away */
+    iom.setupUniverseChannels(1, QVector<InputOutputMap::ChannelSetup>() << setup);
+    QVERIFY(iom.m_channelsChanges.isEmpty());
+    QCOMPARE(int(iom.universes().at(1)->channelCapabilities(5)), int(Universe::LTP));
+
+    /* Otherwise the next claim applies them */
+    setup.forcedType = Universe::Undefined;
+    InputOutputMap::ChannelsChange change;
+    change.universe = 1;
+    change.channels << setup;
+    change.address = 0;
+    change.range = 0;
+    iom.m_channelsChanges.append(change);
+    QCOMPARE(int(iom.universes().at(1)->channelCapabilities(5)), int(Universe::LTP));
+
+    QList<Universe*> unis = iom.claimUniverses();
+    QVERIFY(iom.m_channelsChanges.isEmpty());
+    QCOMPARE(int(unis.at(1)->channelCapabilities(5)), int(Universe::HTP | Universe::Intensity));
+    iom.releaseUniverses(false);
+
+    /* Changes of missing universes are dropped */
+    iom.resetUniverseChannels(42, 0, 10);
+    QVERIFY(iom.m_channelsChanges.isEmpty());
+}
+
 void InputOutputMap_Test::blackout()
 {
     InputOutputMap iom(m_doc, 4);
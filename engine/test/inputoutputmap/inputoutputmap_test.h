@@ -52,6 +52,8 @@ private slots:
     void inputSourceNames();
     void profileDirectories();
     void claimReleaseDumpReset();
+    void claimSnapshot();
+    void channelsChanges();
     void blackout();
     void grandMaster();
 
@@ -158,4 +158,118 @@ void InputPatch_Test::parameters()
     delete ip;
 }
 
+void InputPatch_Test::inputBuffer()
+{
+    InputPatch ip(0, this);
+    ip.m_pluginLine = 0;
+
+    QSignalSpy spy(&ip, SIGNAL(inputValueChanged(quint32,quint32,uchar,QString)));
+
+    /* Values for the same channel are merged until the next flush */
+    ip.slotValueChanged(0, 0, 3, 10);
+    ip.slotValueChanged(0, 0, 3, 20);
+    ip.slotValueChanged(0, 1, 4, 30);
+    ip.slotValueChanged(1, 0, 4, 30);
+    QCOMPARE(spy.count(), 0);
+    QVERIFY(ip.m_blocks[0].loadAcquire() != NULL);
+    QVERIFY(ip.m_blocks[1].loadAcquire() == NULL);
+
+    ip.flush(1);
+    QCOMPARE(spy.count(), 0);
+
+    ip.flush(0);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toUInt(), quint32(0));
+    QCOMPARE(spy.at(0).at(1).toUInt(), quint32(3));
+    QCOMPARE(spy.at(0).at(2).toUInt(), uint(20));
+
+    ip.flush(0);
+    QCOMPARE(spy.count(), 1);
+
+    /* ON/OFF changes pass through, in order */
+    spy.clear();
+    ip.slotValueChanged(0, 0, 1000, 255);
+    ip.slotValueChanged(0, 0, 1000, 0);
+    QCOMPARE(spy.count(), 0);
+    QCOMPARE(ip.m_transitions.count(), 1);
+    ip.flush(UINT_MAX);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(0).at(1).toUInt(), quint32(1000));
+    QCOMPARE(spy.at(0).at(2).toUInt(), uint(255));
+    QCOMPARE(spy.at(1).at(1).toUInt(), quint32(1000));
+    QCOMPARE(spy.at(1).at(2).toUInt(), uint(0));
+    QCOMPARE(ip.m_transitions.count(), 0);
+
+    spy.clear();
+    ip.slotValueChanged(0, 0, 1000, 255);
+    ip.slotValueChanged(0, 0, 1000, 128);
+    ip.slotValueChanged(0, 0, 1000, 0);
+    ip.slotValueChanged(0, 0, 1000, 64);
+    ip.flush(0);
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(spy.at(0).at(2).toUInt(), uint(128));
+    QCOMPARE(spy.at(1).at(2).toUInt(), uint(0));
+    QCOMPARE(spy.at(2).at(2).toUInt(), uint(64));
+
+    /* Keys are delivered along with their values */
+    spy.clear();
+    ip.slotValueChanged(0, 0, 42, 127, "/foo/bar");
+    ip.slotValueChanged(0, 0, 43, 1);
+    ip.flush(0);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(0).at(1).toUInt(), quint32(42));
+    QCOMPARE(spy.at(0).at(3).toString(), QString("/foo/bar"));
+    QCOMPARE(spy.at(1).at(1).toUInt(), quint32(43));
+    QVERIFY(spy.at(1).at(3).toString().isEmpty());
+
+    /* Channels beyond the slot blocks go through the fallback buffer */
+    spy.clear();
+    quint32 farChannel = INPUTPATCH_BLOCK_SIZE * INPUTPATCH_BLOCK_COUNT + 5;
+    ip.slotValueChanged(0, 0, farChannel, 1);
+    ip.slotValueChanged(0, 0, farChannel, 2);
+    QCOMPARE(ip.m_overflowBuffer.count(), 1);
+    ip.flush(0);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(1).toUInt(), farChannel);
+    QCOMPARE(spy.at(0).at(2).toUInt(), uint(2));
+    QCOMPARE(ip.m_overflowBuffer.count(), 0);
+}
+
+void InputPatch_Test::inputFrame()
+{
+    InputPatch ip(0, this);
+    ip.m_pluginLine = 0;
+
+    QSignalSpy spy(&ip, SIGNAL(inputValueChanged(quint32,quint32,uchar,QString)));
+
+    /* Only the channels which differ from the previous frame are buffered */
+    QByteArray frame(512, 0);
+    frame[5] = 10;
+    frame[300] = 20;
+    ip.slotFrameReceived(0, 0, frame);
+    ip.slotFrameReceived(0, 1, QByteArray(512, 1));
+    ip.slotFrameReceived(1, 0, QByteArray(512, 1));
+    ip.flush(0);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(0).at(1).toUInt(), quint32(5));
+    QCOMPARE(spy.at(0).at(2).toUInt(), uint(10));
+    QCOMPARE(spy.at(1).at(1).toUInt(), quint32(300));
+    QCOMPARE(spy.at(1).at(2).toUInt(), uint(20));
+
+    spy.clear();
+    ip.slotFrameReceived(0, 0, frame);
+    ip.flush(0);
+    QCOMPARE(spy.count(), 0);
+
+    frame[300] = 30;
+    frame[511] = 40;
+    ip.slotFrameReceived(0, 0, frame);
+    ip.flush(0);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(0).at(1).toUInt(), quint32(300));
+    QCOMPARE(spy.at(0).at(2).toUInt(), uint(30));
+    QCOMPARE(spy.at(1).at(1).toUInt(), quint32(511));
+    QCOMPARE(spy.at(1).at(2).toUInt(), uint(40));
+}
+
 QTEST_APPLESS_MAIN(InputPatch_Test)
@@ -34,6 +34,8 @@ private slots:
     void defaults();
     void patch();
     void parameters();
+    void inputBuffer();
+    void inputFrame();
 
 private:
     Doc* m_doc;
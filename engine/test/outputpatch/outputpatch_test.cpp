@@ -144,4 +144,88 @@ void OutputPatch_Test::dump()
     delete op;
 }
 
+void OutputPatch_Test::transmitPolicy()
+{
+    QByteArray uni(512, char(0));
+    uni[0] = 100;
+
+    OutputPatch* op = new OutputPatch(0, this);
+    QVERIFY(op->keepAliveInterval() == -1);
+    QVERIFY(op->minimumInterval() == 0);
+
+    IOPluginStub* stub = static_cast<IOPluginStub*>
+                                (m_doc->ioPluginCache()->plugins().at(0));
+    QVERIFY(stub != NULL);
+
+    /* The stub is not a network plugin: data is written at every tick */
+    op->set(stub, 0);
+    QVERIFY(op->m_effectiveKeepAlive.loadAcquire() == 0);
+    op->dump(0, uni);
+    QVERIFY(stub->m_universe[0] == (char) 100);
+    stub->m_universe[0] = 0;
+    op->dump(0, uni);
+    QVERIFY(stub->m_universe[0] == (char) 100);
+
+    /* A change is written, then repeated for a few ticks */
+    op->setKeepAliveInterval(50);
+    QVERIFY(op->keepAliveInterval() == 50);
+    QVERIFY(op->m_effectiveKeepAlive.loadAcquire() == 50);
+    for (int i = 0; i <= KOutputPatchChangeRepeats; i++)
+    {
+        stub->m_universe[0] = 0;
+        op->dump(0, uni);
+        QVERIFY(stub->m_universe[0] == (char) 100);
+    }
+
+    /* Then unchanged data is written only when the keep-alive expires */
+    stub->m_universe[0] = 0;
+    op->dump(0, uni);
+    QVERIFY(stub->m_universe[0] == (char) 0);
+
+    /* Changed data is written immediately, and repeated as well */
+    uni[0] = 200;
+    op->dump(0, uni);
+    QVERIFY(stub->m_universe[0] == (char) 200);
+    for (int i = 0; i < KOutputPatchChangeRepeats; i++)
+    {
+        stub->m_universe[0] = 0;
+        op->dump(0, uni);
+        QVERIFY(stub->m_universe[0] == (char) 200);
+    }
+    stub->m_universe[0] = 0;
+    op->dump(0, uni);
+    QVERIFY(stub->m_universe[0] == (char) 0);
+
+    QTest::qSleep(60);
+    op->dump(0, uni);
+    QVERIFY(stub->m_universe[0] == (char) 200);
+
+    /* A refresh forces the next write */
+    stub->m_universe[0] = 0;
+    op->refresh();
+    op->dump(0, uni);
+    QVERIFY(stub->m_universe[0] == (char) 200);
+
+    /* Changes happening before the minimum interval are delayed */
+    op->setMinimumInterval(50);
+    QVERIFY(op->minimumInterval() == 50);
+    op->dump(0, uni);
+    uni[0] = 10;
+    op->dump(0, uni);
+    QVERIFY(stub->m_universe[0] == (char) 200);
+
+    QTest::qSleep(60);
+    op->dump(0, uni);
+    QVERIFY(stub->m_universe[0] == (char) 10);
+
+    /* Restore the defaults */
+    op->setMinimumInterval(-5);
+    QVERIFY(op->minimumInterval() == 0);
+    op->setKeepAliveInterval(-5);
+    QVERIFY(op->keepAliveInterval() == -1);
+    QVERIFY(op->m_effectiveKeepAlive.loadAcquire() == 0);
+
+    delete op;
+}
+
 QTEST_APPLESS_MAIN(OutputPatch_Test)
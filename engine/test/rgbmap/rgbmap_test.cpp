@@ -0,0 +1,97 @@
+/*
+  Q Light Controller Plus
+  rgbmap_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "rgbmap_test.h"
+#include "rgbmap.h"
+
+void RGBMap_Test::initial()
+{
+    RGBMap map;
+    QVERIFY(map.isEmpty() == true);
+    QCOMPARE(map.width(), 0);
+    QCOMPARE(map.height(), 0);
+    QCOMPARE(map.size(), QSize(0, 0));
+
+    RGBMap filled(QSize(4, 3), 0xFF0000);
+    QVERIFY(filled.isEmpty() == false);
+    QCOMPARE(filled.width(), 4);
+    QCOMPARE(filled.height(), 3);
+    for (int y = 0; y < 3; y++)
+        for (int x = 0; x < 4; x++)
+            QCOMPARE(filled.pixel(x, y), uint(0xFF0000));
+
+    // An invalid size gives an empty map
+    RGBMap invalid((QSize()));
+    QVERIFY(invalid.isEmpty() == true);
+}
+
+void RGBMap_Test::pixels()
+{
+    RGBMap map(QSize(3, 2));
+    map.setPixel(2, 1, 0x00FF00);
+    map[0][1] = 0x0000FF;
+
+    QCOMPARE(map.pixel(2, 1), uint(0x00FF00));
+    QCOMPARE(map[1][2], uint(0x00FF00));
+    QCOMPARE(map.pixel(1, 0), uint(0x0000FF));
+
+    // Rows are stored one after the other
+    QCOMPARE(map.constData()[1 * 3 + 2], uint(0x00FF00));
+    QCOMPARE(map.constScanLine(1), map.constData() + 3);
+
+    map.fill(0x123456);
+    for (int i = 0; i < 6; i++)
+        QCOMPARE(map.constData()[i], uint(0x123456));
+}
+
+void RGBMap_Test::resize()
+{
+    RGBMap map(QSize(8, 8));
+    const uint *buffer = map.constData();
+
+    // Same or smaller sizes reuse the buffer
+    map.resize(QSize(8, 8));
+    QCOMPARE(map.constData(), buffer);
+    map.resize(QSize(4, 2));
+    QCOMPARE(map.size(), QSize(4, 2));
+    QCOMPARE(map.constData(), buffer);
+    map.resize(QSize(8, 8));
+    QCOMPARE(map.constData(), buffer);
+
+    map.resize(QSize());
+    QVERIFY(map.isEmpty() == true);
+}
+
+void RGBMap_Test::sharing()
+{
+    RGBMap map(QSize(2, 2), 0xFF);
+    RGBMap copy = map;
+    QCOMPARE(copy.constData(), map.constData());
+    QVERIFY(copy == map);
+
+    // Writing detaches the copy
+    copy.setPixel(0, 0, 0xAA);
+    QVERIFY(copy.constData() != map.constData());
+    QCOMPARE(map.pixel(0, 0), uint(0xFF));
+    QVERIFY(copy != map);
+}
+
+QTEST_MAIN(RGBMap_Test)
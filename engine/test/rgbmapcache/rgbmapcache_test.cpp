@@ -0,0 +1,165 @@
+/*
+  Q Light Controller Plus
+  rgbmapcache_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QThreadPool>
+#include <QtTest>
+
+#define private public
+#include "rgbmapcache_test.h"
+#include "rgbmapcache.h"
+#include "rgbimage.h"
+#undef private
+
+#ifdef QT_QML_LIB
+  #include "rgbscriptv4.h"
+#else
+  #include "rgbscript.h"
+#endif
+#include "rgbplain.h"
+#include "rgbtext.h"
+#include "doc.h"
+
+static RGBMap makeMap(const QSize& size, uint rgb)
+{
+    return RGBMap(size, rgb);
+}
+
+void RGBMapCache_Test::initTestCase()
+{
+    m_doc = new Doc(this);
+}
+
+void RGBMapCache_Test::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void RGBMapCache_Test::lookup()
+{
+    RGBMapCache cache;
+    QCOMPARE(cache.count(), 0);
+    QCOMPARE(cache.usage(), qint64(0));
+
+    RGBMap map;
+    QVERIFY(cache.lookup(QSize(4, 3), 0xFF0000, 0, map) == false);
+
+    cache.insert(QSize(4, 3), 0xFF0000, 0, makeMap(QSize(4, 3), 0xFF0000));
+    QCOMPARE(cache.count(), 1);
+    QVERIFY(cache.usage() > 0);
+
+    QVERIFY(cache.lookup(QSize(4, 3), 0xFF0000, 0, map) == true);
+    QCOMPARE(map, makeMap(QSize(4, 3), 0xFF0000));
+
+    // Every part of the key matters
+    QVERIFY(cache.lookup(QSize(4, 3), 0xFF0000, 1, map) == false);
+    QVERIFY(cache.lookup(QSize(4, 3), 0x00FF00, 0, map) == false);
+    QVERIFY(cache.lookup(QSize(3, 4), 0xFF0000, 0, map) == false);
+
+    cache.clear();
+    QCOMPARE(cache.count(), 0);
+    QCOMPARE(cache.usage(), qint64(0));
+    QVERIFY(cache.lookup(QSize(4, 3), 0xFF0000, 0, map) == false);
+}
+
+void RGBMapCache_Test::budget()
+{
+    QSize size(16, 16);
+    qint64 frameBytes = RGBMapCache::mapBytes(makeMap(size, 0));
+
+    RGBMapCache cache(frameBytes * 3);
+    QCOMPARE(cache.budget(), frameBytes * 3);
+
+    for (int step = 0; step < 10; step++)
+        cache.insert(size, 0xFFFFFF, step, makeMap(size, step));
+
+    // The first frames are kept, the others dropped
+    QCOMPARE(cache.count(), 3);
+    QCOMPARE(cache.usage(), frameBytes * 3);
+
+    RGBMap map;
+    QVERIFY(cache.lookup(size, 0xFFFFFF, 2, map) == true);
+    QCOMPARE(map, makeMap(size, 2));
+    QVERIFY(cache.lookup(size, 0xFFFFFF, 3, map) == false);
+}
+
+void RGBMapCache_Test::revision()
+{
+    RGBMapCache cache;
+    cache.setRevision(5);
+    cache.insert(QSize(2, 2), 0xFF, 0, makeMap(QSize(2, 2), 0xFF));
+
+    cache.setRevision(5);
+    QCOMPARE(cache.count(), 1);
+
+    cache.setRevision(6);
+    QCOMPARE(cache.count(), 0);
+}
+
+void RGBMapCache_Test::prefill()
+{
+    QSharedPointer<RGBMapCache> cache(new RGBMapCache());
+    RGBPlain *plain = new RGBPlain(m_doc);
+
+    RGBMapCache::prefill(cache, plain, QSize(8, 4), 0x00FF00, 5);
+    QThreadPool::globalInstance()->waitForDone();
+
+    QCOMPARE(cache->count(), 5);
+    for (int step = 0; step < 5; step++)
+    {
+        RGBMap map;
+        QVERIFY(cache->lookup(QSize(8, 4), 0x00FF00, step, map) == true);
+        QCOMPARE(map, makeMap(QSize(8, 4), 0x00FF00));
+    }
+}
+
+void RGBMapCache_Test::algorithmRevision()
+{
+    RGBText text(m_doc);
+    QVERIFY(text.isCacheable() == true);
+
+    uint revision = text.revision();
+    text.setText("Foo");
+    QVERIFY(text.revision() != revision);
+
+    revision = text.revision();
+    text.setXOffset(2);
+    QVERIFY(text.revision() != revision);
+
+    revision = text.revision();
+    text.setColors(Qt::red, Qt::blue);
+    QVERIFY(text.revision() != revision);
+
+    RGBPlain plain(m_doc);
+    QVERIFY(plain.isCacheable() == false);
+    QVERIFY(plain.isPrefillable() == false);
+
+    /* Animated images advance on every frame */
+    RGBImage image(m_doc);
+    QVERIFY(image.isCacheable() == true);
+    QVERIFY(image.isPrefillable() == true);
+    image.m_animatedSource = true;
+    QVERIFY(image.isCacheable() == false);
+    QVERIFY(image.isPrefillable() == false);
+
+    /* Script engines can't run in the prefill threads */
+    RGBScript script(m_doc);
+    QVERIFY(script.isPrefillable() == false);
+}
+
+QTEST_MAIN(RGBMapCache_Test)
@@ -107,6 +107,37 @@ void RGBMatrix_Test::group()
     QCOMPARE(mtx.fixtureGroup(), FixtureGroup::invalidId());
 }
 
+void RGBMatrix_Test::compileHeads()
+{
+    RGBMatrix mtx(m_doc);
+    QVERIFY(mtx.m_compiledHeadsDirty == true);
+
+    mtx.setFixtureGroup(0);
+    mtx.compileHeads(mtx.m_group);
+    QVERIFY(mtx.m_compiledHeadsDirty == false);
+    QCOMPARE(mtx.m_compiledHeads.count(), 25);
+
+    foreach (RGBMatrix::CompiledHead head, mtx.m_compiledHeads)
+    {
+        Fixture *fxi = m_doc->fixture(head.fixture);
+        QVERIFY(fxi != NULL);
+        QCOMPARE(head.universe, fxi->universe());
+        QCOMPARE(head.mixing, RGBMatrix::CompiledHead::RGBMixing);
+        QCOMPARE(head.color[0], fxi->head(0).rgbChannels().at(0));
+        QCOMPARE(head.color[1], fxi->head(0).rgbChannels().at(1));
+        QCOMPARE(head.color[2], fxi->head(0).rgbChannels().at(2));
+        QVERIFY(head.x >= 0 && head.x < 5);
+        QVERIFY(head.y >= 0 && head.y < 5);
+    }
+
+    /* Any change to the group requires a new compilation */
+    m_doc->fixtureGroup(0)->setName("Renamed Group");
+    QVERIFY(mtx.m_compiledHeadsDirty == true);
+
+    mtx.compileHeads(NULL);
+    QCOMPARE(mtx.m_compiledHeads.count(), 0);
+}
+
 void RGBMatrix_Test::color()
 {
     RGBMatrix mtx(m_doc);
@@ -152,8 +183,9 @@ void RGBMatrix_Test::previewMaps()
     int steps = mtx.stepsCount();
     QCOMPARE(steps, 0);
 
-    RGBMap map = mtx.previewMap(0, &handler);
-    QCOMPARE(map.size(), 0); // No fixture group
+    RGBMap map;
+    mtx.previewMap(0, &handler, map);
+    QCOMPARE(map.height(), 0); // No fixture group
 
     mtx.setFixtureGroup(0);
     steps = mtx.stepsCount();
@@ -164,12 +196,12 @@ void RGBMatrix_Test::previewMaps()
     mtx.setTotalDuration(8000);
     QCOMPARE(mtx.totalDuration(), uint(8000));
 
-    map = mtx.previewMap(0, &handler);
-    QCOMPARE(map.size(), 5);
+    mtx.previewMap(0, &handler, map);
+    QCOMPARE(map.height(), 5);
 
     for (int z = 0; z < steps; z++)
     {
-        map = mtx.previewMap(z, &handler);
+        mtx.previewMap(z, &handler, map);
         for (int y = 0; y < 5; y++)
         {
             for (int x = 0; x < 5; x++)
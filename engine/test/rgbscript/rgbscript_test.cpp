@@ -46,7 +46,8 @@ void RGBScript_Test::cleanupTestCase()
 void RGBScript_Test::initial()
 {
     RGBScript script(m_doc);
-    QVERIFY(script.s_engine == NULL);
+    QVERIFY(script.m_engine == NULL);
+    QVERIFY(script.m_engineMutex == NULL);
     QCOMPARE(script.m_apiVersion, 0);
     QCOMPARE(script.m_fileName, QString());
     QCOMPARE(script.m_contents, QString());
@@ -142,7 +143,9 @@ void RGBScript_Test::evaluateNoRgbMapFunction()
     RGBScript s(m_doc);
     s.m_contents = code;
     QCOMPARE(s.evaluate(), false);
-    QCOMPARE(s.rgbMap(QSize(5, 5), 1, 0), RGBMap());
+    RGBMap map;
+    s.rgbMap(QSize(5, 5), 1, 0, map);
+    QCOMPARE(map, RGBMap());
 }
 
 void RGBScript_Test::evaluateNoRgbMapStepCountFunction()
@@ -173,14 +176,16 @@ void RGBScript_Test::rgbMapStepCount()
 void RGBScript_Test::rgbMap()
 {
     RGBScript s = m_doc->rgbScriptsCache()->script("Stripes");
-    QVERIFY(s.rgbMap(QSize(3, 4), 0, 0).isEmpty() == false);
+    RGBMap map;
+    s.rgbMap(QSize(3, 4), 0, 0, map);
+    QVERIFY(map.isEmpty() == false);
 
     s.setProperty("orientation", "Vertical");
     QVERIFY(s.property("orientation") == "Vertical");
 
     for (int z = 0; z < 5; z++)
     {
-        RGBMap map = s.rgbMap(QSize(5, 5), QColor(Qt::red).rgb(), z);
+        s.rgbMap(QSize(5, 5), QColor(Qt::red).rgb(), z, map);
         for (int y = 0; y < 5; y++)
         {
             for (int x = 0; x < 5; x++)
@@ -194,4 +199,79 @@ void RGBScript_Test::rgbMap()
     }
 }
 
+void RGBScript_Test::rgbMapFlat()
+{
+    // API v3 script filling the flat pixels array with a diagonal
+    QString code("( function() { var algo = new Object; algo.apiVersion = 3;"
+                 "algo.rgbMapStepCount = function(width, height) { return width; };"
+                 "algo.rgbMap = function(width, height, rgb, step, pixels) {"
+                 "  for (var y = 0; y < height; y++)"
+                 "    if (y + step < width) pixels[y * width + y + step] = rgb;"
+                 "};"
+                 "return algo; } )()");
+    RGBScript s(m_doc);
+    s.m_fileName = "flat.js";
+    s.m_contents = code;
+    QCOMPARE(s.evaluate(), true);
+    QCOMPARE(s.apiVersion(), 3);
+
+    RGBMap map;
+    for (int step = 0; step < 3; step++)
+    {
+        s.rgbMap(QSize(6, 4), QColor(Qt::green).rgb(), step, map);
+        QCOMPARE(map.height(), 4);
+        QCOMPARE(map.width(), 6);
+        for (int y = 0; y < 4; y++)
+        {
+            for (int x = 0; x < 6; x++)
+            {
+                if (x == y + step)
+                    QCOMPARE(map[y][x], QColor(Qt::green).rgb());
+                else
+                    QCOMPARE(map[y][x], uint(0));
+            }
+        }
+    }
+
+    // A different size reallocates the script buffer
+    s.rgbMap(QSize(2, 2), QColor(Qt::green).rgb(), 0, map);
+    QCOMPARE(map.height(), 2);
+    QCOMPARE(map[1][1], QColor(Qt::green).rgb());
+    QCOMPARE(map[1][0], uint(0));
+}
+
+void RGBScript_Test::enginePool()
+{
+    RGBScript s = m_doc->rgbScriptsCache()->script("Stripes");
+    QVERIFY(s.m_engine != NULL);
+    QVERIFY(s.m_engineMutex != NULL);
+    QVERIFY(RGBScript::s_engines.count() > 0);
+    QVERIFY(RGBScript::s_engines.count() <= 8);
+    QCOMPARE(RGBScript::s_engineMutexes.count(), RGBScript::s_engines.count());
+
+    // Clones are spread over the whole pool
+    QList<RGBScript *> clones;
+    QSet<QMutex *> mutexes;
+    for (int i = 0; i < RGBScript::s_engines.count(); i++)
+    {
+        RGBScript *clone = static_cast<RGBScript *>(s.clone());
+        QVERIFY(clone->m_engine != NULL);
+        mutexes << clone->m_engineMutex;
+        clones << clone;
+    }
+    QCOMPARE(mutexes.count(), RGBScript::s_engines.count());
+
+    // Each clone evaluates the script in its own engine
+    foreach (RGBScript *clone, clones)
+    {
+        QCOMPARE(clone->rgbMapStepCount(QSize(10, 15)), 10);
+        RGBMap cloneMap, map;
+        clone->rgbMap(QSize(5, 5), QColor(Qt::red).rgb(), 0, cloneMap);
+        s.rgbMap(QSize(5, 5), QColor(Qt::red).rgb(), 0, map);
+        QCOMPARE(cloneMap, map);
+    }
+
+    qDeleteAll(clones);
+}
+
 QTEST_MAIN(RGBScript_Test)
@@ -41,6 +41,8 @@ private slots:
     void evaluateInvalidApiVersion();
     void rgbMapStepCount();
     void rgbMap();
+    void rgbMapFlat();
+    void enginePool();
 
 private:
     Doc * m_doc;
@@ -1,4 +1,5 @@
 TEMPLATE = subdirs
+SUBDIRS += audiomixer
 SUBDIRS += bus
 SUBDIRS += chaser
 SUBDIRS += chaserrunner
@@ -9,6 +10,7 @@ SUBDIRS += cuestack
 SUBDIRS += doc
 SUBDIRS += efx
 SUBDIRS += efxfixture
+SUBDIRS += engineprofiler
 SUBDIRS += fadechannel
 SUBDIRS += fixture
 SUBDIRS += fixturegroup
@@ -33,6 +35,8 @@ SUBDIRS += qlcmacros
 SUBDIRS += qlcphysical
 SUBDIRS += qlcpoint
 SUBDIRS += rgbalgorithm
+SUBDIRS += rgbmap
+SUBDIRS += rgbmapcache
 SUBDIRS += rgbmatrix
 SUBDIRS += rgbscript
 SUBDIRS += rgbtext
@@ -41,6 +45,7 @@ SUBDIRS += scenevalue
 !qmlui: SUBDIRS += script
 SUBDIRS += sequence
 SUBDIRS += universe
+SUBDIRS += universemonitor
 
 # Stubs
 SUBDIRS += iopluginstub
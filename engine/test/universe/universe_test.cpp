@@ -26,6 +26,7 @@
 #include "universe.h"
 #undef protected
 
+#include "universeworkerpool.h"
 #include "grandmaster.h"
 
 void Universe_Test::init()
@@ -335,6 +336,56 @@ void Universe_Test::write()
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(127));
 }
 
+void Universe_Test::writeHTPBatch()
+{
+    m_uni->setChannelCapability(0, QLCChannel::Intensity);
+    m_uni->setChannelCapability(4, QLCChannel::Intensity);
+    m_uni->setChannelCapability(9, QLCChannel::Pan);
+
+    QVERIFY(m_uni->write(0, 200) == true);
+    QVERIFY(m_uni->write(9, 200) == true);
+
+    int channels[] = { 0, 4, 9 };
+    uchar values[] = { 100, 50, 25 };
+    m_uni->writeHTPBatch(channels, values, 3);
+
+    // HTP channels keep the highest value, LTP channels take the new one
+    QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(200));
+    QCOMPARE(quint8(m_uni->postGMValues()->at(4)), quint8(50));
+    QCOMPARE(quint8(m_uni->postGMValues()->at(9)), quint8(25));
+    QCOMPARE(m_uni->usedChannels(), ushort(10));
+
+    m_gm->setValue(127);
+    values[1] = 200;
+    m_uni->writeHTPBatch(channels, values, 3);
+    QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(100));
+    QCOMPARE(quint8(m_uni->postGMValues()->at(4)), quint8(100));
+}
+
+void Universe_Test::updatePostGMValues()
+{
+    for (ushort i = 0; i < 40; i++)
+    {
+        m_uni->setChannelCapability(i, QLCChannel::Intensity);
+        m_uni->write(i, uchar(i * 6));
+    }
+
+    m_uni->setPassthrough(true);
+    for (int i = 0; i < 40; i++)
+        (*m_uni->m_passthroughValues)[i] = char(i % 2 ? 100 : 0);
+
+    m_gm->setValue(127);
+    m_uni->updatePostGMValues(0, 40);
+
+    for (int i = 0; i < 40; i++)
+    {
+        uchar expected = m_uni->applyGM(i, uchar(i * 6));
+        if (i % 2 && expected < 100)
+            expected = 100;
+        QCOMPARE(quint8(m_uni->postGMValues()->at(i)), quint8(expected));
+    }
+}
+
 void Universe_Test::writeRelative()
 {
     // 127 == 0
@@ -418,6 +469,64 @@ void Universe_Test::reset()
         QCOMPARE((int)m_uni->postGMValues()->at(i), 0);
 }
 
+void Universe_Test::changedBlocks()
+{
+    QCOMPARE(m_uni->changedBlocks(), quint32(0));
+
+    m_uni->write(0, 10);
+    m_uni->write(UNIVERSE_BLOCK_SIZE + 1, 20);
+    m_uni->write(UNIVERSE_SIZE - 1, 30);
+    QCOMPARE(m_uni->changedBlocks(), quint32((1 << 0) | (1 << 1) | (1u << 31)));
+    QCOMPARE(m_uni->changedBlocks(), quint32(0));
+
+    m_uni->write(UNIVERSE_BLOCK_SIZE * 5, 40);
+    QCOMPARE(m_uni->changedBlocks(), quint32(1 << 5));
+    QCOMPARE(m_uni->hasChanged(), false);
+
+    QCOMPARE(Universe::blocksMask(0, 0), quint32(0));
+    QCOMPARE(Universe::blocksMask(0, 1), quint32(1 << 0));
+    QCOMPARE(Universe::blocksMask(UNIVERSE_BLOCK_SIZE - 1, 2), quint32((1 << 0) | (1 << 1)));
+    QCOMPARE(Universe::blocksMask(UNIVERSE_BLOCK_SIZE * 2, UNIVERSE_BLOCK_SIZE), quint32(1 << 2));
+    QCOMPARE(Universe::blocksMask(0, UNIVERSE_SIZE), quint32(UINT_MAX));
+    QCOMPARE(Universe::blocksMask(UNIVERSE_SIZE - 2, 10), quint32(1u << 31));
+    QCOMPARE(Universe::blocksMask(UNIVERSE_SIZE, 1), quint32(0));
+}
+
+void Universe_Test::workerPool()
+{
+    UniverseWorkerPool pool(2);
+    QCOMPARE(pool.threadCount(), 2);
+    QCOMPARE(pool.isRunning(), false);
+
+    QList<Universe *> universes;
+    for (quint32 i = 0; i < 8; i++)
+    {
+        Universe *uni = new Universe(i, m_gm, this);
+        uni->setChannelCapability(0, QLCChannel::Pan);
+        uni->write(0, uchar(i + 1));
+        universes << uni;
+    }
+
+    pool.start();
+    QCOMPARE(pool.isRunning(), true);
+
+    for (int tick = 0; tick < 10; tick++)
+        pool.process(universes);
+
+    for (int i = 0; i < universes.count(); i++)
+    {
+        Universe *uni = universes.at(i);
+        QCOMPARE(int(uni->postGMValue(0)), i + 1);
+        // flushOutput has already synced the last written values
+        QCOMPARE(uni->hasChanged(), false);
+    }
+
+    pool.stop();
+    QCOMPARE(pool.isRunning(), false);
+
+    qDeleteAll(universes);
+}
+
 void Universe_Test::loadEmpty()
 {
     QBuffer buffer;
@@ -44,7 +44,11 @@ private slots:
     void applyGM();
     void write();
     void writeRelative();
+    void writeHTPBatch();
+    void updatePostGMValues();
     void reset();
+    void changedBlocks();
+    void workerPool();
 
     void loadEmpty();
     void loadPassthroughTrue();
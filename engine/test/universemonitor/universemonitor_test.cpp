@@ -0,0 +1,150 @@
+/*
+  Q Light Controller Plus
+  universemonitor_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QSignalSpy>
+#include <QtTest>
+
+#define private public
+#include "universemonitor_test.h"
+#include "universemonitor.h"
+#include "inputoutputmap.h"
+#include "universe.h"
+#include "doc.h"
+#undef private
+
+void UniverseMonitor_Test::initTestCase()
+{
+    m_doc = new Doc(this);
+}
+
+void UniverseMonitor_Test::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void UniverseMonitor_Test::rate()
+{
+    UniverseMonitor monitor(m_doc->inputOutputMap());
+    QCOMPARE(monitor.rate(), UNIVERSEMONITOR_DEFAULT_RATE);
+    QVERIFY(monitor.m_timer.isActive() == true);
+    QCOMPARE(monitor.m_timer.interval(), 1000 / UNIVERSEMONITOR_DEFAULT_RATE);
+
+    monitor.setRate(10);
+    QCOMPARE(monitor.rate(), 10);
+    QCOMPARE(monitor.m_timer.interval(), 100);
+
+    monitor.setRate(0);
+    QCOMPARE(monitor.rate(), 0);
+    QVERIFY(monitor.m_timer.isActive() == false);
+
+    monitor.setRate(-5);
+    QCOMPARE(monitor.rate(), 0);
+    QVERIFY(monitor.m_timer.isActive() == false);
+}
+
+void UniverseMonitor_Test::pull()
+{
+    UniverseMonitor monitor(m_doc->inputOutputMap(), 0);
+    QSignalSpy spy(&monitor, SIGNAL(universeWritten(quint32,QByteArray,quint32)));
+
+    /* Nothing published yet */
+    monitor.pull();
+    QCOMPARE(spy.count(), 0);
+
+    QList<Universe *> universes = m_doc->inputOutputMap()->claimUniverses();
+    universes.at(1)->write(0, 100);
+    universes.at(1)->write(UNIVERSE_BLOCK_SIZE * 3, 200);
+    universes.at(1)->flushOutput();
+    m_doc->inputOutputMap()->releaseUniverses(false);
+
+    monitor.pull();
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toUInt(), quint32(1));
+    QByteArray values = spy.at(0).at(1).toByteArray();
+    QCOMPARE(values.size(), UNIVERSE_BLOCK_SIZE * 3 + 1);
+    QCOMPARE(uchar(values.at(0)), uchar(100));
+    QCOMPARE(uchar(values.at(UNIVERSE_BLOCK_SIZE * 3)), uchar(200));
+    QCOMPARE(spy.at(0).at(2).toUInt(), quint32((1 << 0) | (1 << 3)));
+
+    /* Nothing new */
+    monitor.pull();
+    QCOMPARE(spy.count(), 1);
+}
+
+void UniverseMonitor_Test::coalesce()
+{
+    UniverseMonitor monitor(m_doc->inputOutputMap(), 0);
+    QSignalSpy spy(&monitor, SIGNAL(universeWritten(quint32,QByteArray,quint32)));
+
+    /* Skip what has been published by the previous tests */
+    monitor.pull();
+    spy.clear();
+
+    /* Several engine frames between two pulls result in a single
+     * update, with the changes of all the frames */
+    QList<Universe *> universes = m_doc->inputOutputMap()->claimUniverses();
+    Universe *uni = universes.at(0);
+    for (int i = 0; i < 10; i++)
+    {
+        uni->write(UNIVERSE_BLOCK_SIZE * i, 10 + i);
+        uni->flushOutput();
+    }
+    m_doc->inputOutputMap()->releaseUniverses(false);
+
+    monitor.pull();
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toUInt(), quint32(0));
+    QCOMPARE(spy.at(0).at(2).toUInt(), quint32(0x3FF));
+
+    QByteArray values = spy.at(0).at(1).toByteArray();
+    for (int i = 0; i < 10; i++)
+        QCOMPARE(uchar(values.at(UNIVERSE_BLOCK_SIZE * i)), uchar(10 + i));
+}
+
+void UniverseMonitor_Test::independentMonitors()
+{
+    UniverseMonitor fast(m_doc->inputOutputMap(), 0);
+    UniverseMonitor slow(m_doc->inputOutputMap(), 0);
+    fast.pull();
+    slow.pull();
+
+    QSignalSpy fastSpy(&fast, SIGNAL(universeWritten(quint32,QByteArray,quint32)));
+    QSignalSpy slowSpy(&slow, SIGNAL(universeWritten(quint32,QByteArray,quint32)));
+
+    Universe *uni = m_doc->inputOutputMap()->claimUniverses().at(0);
+    m_doc->inputOutputMap()->releaseUniverses(false);
+
+    uni->write(1, 1);
+    uni->flushOutput();
+    fast.pull();
+
+    uni->write(UNIVERSE_BLOCK_SIZE * 2, 2);
+    uni->flushOutput();
+    fast.pull();
+    slow.pull();
+
+    /* The fast monitor saw both frames, the slow one their sum */
+    QCOMPARE(fastSpy.count(), 2);
+    QCOMPARE(fastSpy.at(0).at(2).toUInt(), quint32(1 << 0));
+    QCOMPARE(fastSpy.at(1).at(2).toUInt(), quint32(1 << 2));
+    QCOMPARE(slowSpy.count(), 1);
+    QCOMPARE(slowSpy.at(0).at(2).toUInt(), quint32((1 << 0) | (1 << 2)));
+}
+
+QTEST_MAIN(UniverseMonitor_Test)
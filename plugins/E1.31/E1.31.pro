@@ -31,17 +31,21 @@ TRANSLATIONS += E131_pt_BR.ts
 TRANSLATIONS += E131_ca_ES.ts
 TRANSLATIONS += E131_ja_JP.ts
 
-HEADERS += ../interfaces/qlcioplugin.h
+HEADERS += ../interfaces/qlcioplugin.h \
+           ../interfaces/dmxinputmerger.h
 HEADERS += e131packetizer.h \
            e131controller.h \
+           e131syncsender.h \
            e131plugin.h \
            configuree131.h
 
 FORMS += configuree131.ui
 
-SOURCES += ../interfaces/qlcioplugin.cpp
+SOURCES += ../interfaces/qlcioplugin.cpp \
+           ../interfaces/dmxinputmerger.cpp
 SOURCES += e131packetizer.cpp \
            e131controller.cpp \
+           e131syncsender.cpp \
            e131plugin.cpp \
            configuree131.cpp
 
@@ -39,6 +39,8 @@
 #define KMapColumnE131Uni       5
 #define KMapColumnTransmitMode  6
 #define KMapColumnPriority      7
+#define KMapColumnSyncUni       8
+#define KMapColumnMergeMode     9
 
 #define PROP_UNIVERSE (Qt::UserRole + 0)
 #define PROP_LINE (Qt::UserRole + 1)
@@ -132,6 +134,13 @@ void ConfigureE131::fillMappingTree()
                 universeSpin->setRange(1, 0xffff);
                 universeSpin->setValue(info->inputUniverse);
                 m_uniMapTree->setItemWidget(item, KMapColumnE131Uni, universeSpin);
+
+                QComboBox *mergeCombo = new QComboBox(this);
+                mergeCombo->addItem(tr("HTP"));
+                mergeCombo->addItem(tr("LTP"));
+                if (info->inputMergeMode == DmxInputMerger::LTP)
+                    mergeCombo->setCurrentIndex(1);
+                m_uniMapTree->setItemWidget(item, KMapColumnMergeMode, mergeCombo);
             }
             if (info->type & E131Controller::Output)
             {
@@ -184,6 +193,14 @@ void ConfigureE131::fillMappingTree()
                 prioritySpin->setValue(info->outputPriority);
                 prioritySpin->setToolTip(tr("%1 - min, %2 - default, %3 - max").arg(E131_PRIORITY_MIN).arg(E131_PRIORITY_DEFAULT).arg(E131_PRIORITY_MAX));
                 m_uniMapTree->setItemWidget(item, KMapColumnPriority, prioritySpin);
+
+                QSpinBox *syncSpin = new QSpinBox(this);
+                syncSpin->setRange(0, 63999);
+                syncSpin->setValue(info->outputSyncAddress);
+                syncSpin->setSpecialValueText(tr("None"));
+                syncSpin->setToolTip(tr("Universe on which synchronization packets are sent. "
+                                        "Receivers output all the universes sharing it at the same time"));
+                m_uniMapTree->setItemWidget(item, KMapColumnSyncUni, syncSpin);
             }
         }
     }
@@ -343,6 +360,14 @@ void ConfigureE131::accept()
                 QSpinBox* e131uniSpin = qobject_cast<QSpinBox*>(m_uniMapTree->itemWidget(item, KMapColumnE131Uni));
                 m_plugin->setParameter(universe, line, QLCIOPlugin::Input,
                         E131_UNIVERSE, e131uniSpin->value());
+
+                QComboBox* mergeCombo = qobject_cast<QComboBox*>(m_uniMapTree->itemWidget(item, KMapColumnMergeMode));
+                if (mergeCombo->currentIndex() == 1)
+                    m_plugin->setParameter(universe, line, QLCIOPlugin::Input,
+                            E131_MERGEMODE, DmxInputMerger::mergeModeToString(DmxInputMerger::LTP));
+                else
+                    m_plugin->setParameter(universe, line, QLCIOPlugin::Input,
+                            E131_MERGEMODE, DmxInputMerger::mergeModeToString(DmxInputMerger::HTP));
             }
             else // if (type == E131Controller::Output)
             {
@@ -388,6 +413,10 @@ void ConfigureE131::accept()
                 QSpinBox* prioSpin = qobject_cast<QSpinBox*>(m_uniMapTree->itemWidget(item, KMapColumnPriority));
                 m_plugin->setParameter(universe, line, QLCIOPlugin::Output,
                         E131_PRIORITY, prioSpin->value());
+
+                QSpinBox* syncSpin = qobject_cast<QSpinBox*>(m_uniMapTree->itemWidget(item, KMapColumnSyncUni));
+                m_plugin->setParameter(universe, line, QLCIOPlugin::Output,
+                        E131_SYNCUNIVERSE, syncSpin->value());
             }
         }
     }
@@ -35,6 +35,7 @@ E131Controller::E131Controller(QNetworkInterface const& interface, QNetworkAddre
     , m_line(line)
     , m_UdpSocket(new QUdpSocket(this))
     , m_packetizer(new E131Packetizer())
+    , m_syncSender(NULL)
 {
     qDebug() << Q_FUNC_INFO;
     m_UdpSocket->bind(m_ipAddr, 0);
@@ -47,7 +48,8 @@ E131Controller::E131Controller(QNetworkInterface const& interface, QNetworkAddre
 E131Controller::~E131Controller()
 {
     qDebug() << Q_FUNC_INFO;
-    qDeleteAll(m_dmxValuesMap);
+    delete m_syncSender;
+    qDeleteAll(m_inputMergers);
 }
 
 QString E131Controller::getNetworkIP()
@@ -70,6 +72,7 @@ void E131Controller::addUniverse(quint32 universe, E131Controller::Type type)
         info.inputUcastPort = E131_DEFAULT_PORT;
         info.inputUniverse = universe + 1;
         info.inputSocket.clear();
+        info.inputMergeMode = DmxInputMerger::HTP;
         info.outputMulticast = true;
         info.outputMcastAddress = QHostAddress(QString("239.255.0.%1").arg(universe + 1));
         if (m_ipAddr != QHostAddress::LocalHost)
@@ -80,6 +83,8 @@ void E131Controller::addUniverse(quint32 universe, E131Controller::Type type)
         info.outputUniverse = universe + 1;
         info.outputTransmissionMode = Full;
         info.outputPriority = E131_PRIORITY_DEFAULT;
+        info.outputSyncAddress = 0;
+        info.outputSequence = 0;
         info.type = type;
         m_universeMap[universe] = info;
     }
@@ -90,6 +95,9 @@ void E131Controller::addUniverse(quint32 universe, E131Controller::Type type)
         info.inputSocket.clear();
         info.inputSocket = getInputSocket(true, info.inputMcastAddress, E131_DEFAULT_PORT);
     }
+
+    QMutexLocker locker(&m_dataMutex);
+    updateSyncGroups();
 }
 
 void E131Controller::removeUniverse(quint32 universe, E131Controller::Type type)
@@ -98,12 +106,18 @@ void E131Controller::removeUniverse(quint32 universe, E131Controller::Type type)
     {
         UniverseInfo& info = m_universeMap[universe];
         if (type == Input)
+        {
             info.inputSocket.clear();
+            delete m_inputMergers.take(universe);
+        }
 
+        QMutexLocker locker(&m_dataMutex);
         if (info.type == type)
             m_universeMap.take(universe);
         else
             info.type &= ~type;
+
+        updateSyncGroups();
     }
 }
 
@@ -213,6 +227,21 @@ void E131Controller::setInputUniverse(quint32 universe, quint32 e131Uni)
     info.inputUniverse = e131Uni;
 }
 
+void E131Controller::setInputMergeMode(quint32 universe, DmxInputMerger::MergeMode mode)
+{
+    if (m_universeMap.contains(universe) == false)
+        return;
+
+    m_universeMap[universe].inputMergeMode = mode;
+
+    DmxInputMerger *merger = m_inputMergers.value(universe, NULL);
+    if (merger != NULL)
+    {
+        merger->setMergeMode(mode);
+        emit frameReceived(universe, m_line, merger->frame());
+    }
+}
+
 void E131Controller::setOutputMulticast(quint32 universe, bool multicast)
 {
     if (m_universeMap.contains(universe) == false)
@@ -220,6 +249,7 @@ void E131Controller::setOutputMulticast(quint32 universe, bool multicast)
 
     QMutexLocker locker(&m_dataMutex);
     m_universeMap[universe].outputMulticast = multicast;
+    updateSyncGroups();
 }
 
 void E131Controller::setOutputMCastAddress(quint32 universe, QString address)
@@ -229,6 +259,7 @@ void E131Controller::setOutputMCastAddress(quint32 universe, QString address)
 
     QMutexLocker locker(&m_dataMutex);
     m_universeMap[universe].outputMcastAddress = QHostAddress(QString("239.255.0.%1").arg(address));
+    updateSyncGroups();
 }
 
 void E131Controller::setOutputUCastAddress(quint32 universe, QString address)
@@ -238,6 +269,7 @@ void E131Controller::setOutputUCastAddress(quint32 universe, QString address)
 
     QMutexLocker locker(&m_dataMutex);
     m_universeMap[universe].outputUcastAddress = QHostAddress(address);
+    updateSyncGroups();
 }
 
 void E131Controller::setOutputUCastPort(quint32 universe, quint16 port)
@@ -247,6 +279,7 @@ void E131Controller::setOutputUCastPort(quint32 universe, quint16 port)
 
     QMutexLocker locker(&m_dataMutex);
     m_universeMap[universe].outputUcastPort = port;
+    updateSyncGroups();
 }
 
 void E131Controller::setOutputUniverse(quint32 universe, quint32 e131Uni)
@@ -256,6 +289,7 @@ void E131Controller::setOutputUniverse(quint32 universe, quint32 e131Uni)
 
     QMutexLocker locker(&m_dataMutex);
     m_universeMap[universe].outputUniverse = e131Uni;
+    m_universeMap[universe].outputPacket.clear();
 }
 
 void E131Controller::setOutputPriority(quint32 universe, quint32 e131Priority)
@@ -265,6 +299,18 @@ void E131Controller::setOutputPriority(quint32 universe, quint32 e131Priority)
 
     QMutexLocker locker(&m_dataMutex);
     m_universeMap[universe].outputPriority = e131Priority;
+    m_universeMap[universe].outputPacket.clear();
+}
+
+void E131Controller::setOutputSyncAddress(quint32 universe, quint32 syncAddress)
+{
+    if (m_universeMap.contains(universe) == false)
+        return;
+
+    QMutexLocker locker(&m_dataMutex);
+    m_universeMap[universe].outputSyncAddress = syncAddress;
+    m_universeMap[universe].outputPacket.clear();
+    updateSyncGroups();
 }
 
 void E131Controller::setOutputTransmissionMode(quint32 universe, E131Controller::TransmissionMode mode)
@@ -274,6 +320,7 @@ void E131Controller::setOutputTransmissionMode(quint32 universe, E131Controller:
 
     QMutexLocker locker(&m_dataMutex);
     m_universeMap[universe].outputTransmissionMode = int(mode);
+    m_universeMap[universe].outputPacket.clear();
 }
 
 QString E131Controller::transmissionModeToString(E131Controller::TransmissionMode mode)
@@ -329,6 +376,11 @@ quint32 E131Controller::line()
 
 quint64 E131Controller::getPacketSentNumber()
 {
+    QMutexLocker locker(&m_dataMutex);
+
+    if (m_syncSender != NULL)
+        return m_packetSent + m_syncSender->packetsSent();
+
     return m_packetSent;
 }
 
@@ -340,43 +392,31 @@ quint64 E131Controller::getPacketReceivedNumber()
 void E131Controller::sendDmx(const quint32 universe, const QByteArray &data)
 {
     QMutexLocker locker(&m_dataMutex);
-    QByteArray dmxPacket;
-    QHostAddress outAddress = QHostAddress(QString("239.255.0.%1").arg(universe + 1));
-    quint16 outPort = E131_DEFAULT_PORT;
-    quint32 outUniverse = universe;
-    quint32 outPriority = E131_PRIORITY_DEFAULT;
-    TransmissionMode transmitMode = Full;
 
-    if (m_universeMap.contains(universe))
+    QMap<quint32, UniverseInfo>::iterator it = m_universeMap.find(universe);
+    if (it == m_universeMap.end())
     {
-        UniverseInfo const& info = m_universeMap[universe];
-        if (info.outputMulticast)
-        {
-            outAddress = info.outputMcastAddress;
-        }
-        else
-        {
-            outAddress = info.outputUcastAddress;
-            outPort = info.outputUcastPort;
-        }
-        outUniverse = info.outputUniverse;
-        outPriority = info.outputPriority;
-        transmitMode = TransmissionMode(info.outputTransmissionMode);
-    }
-    else
         qWarning() << Q_FUNC_INFO << "universe" << universe << "unknown";
-
-    if (transmitMode == Full)
-    {
-        QByteArray wholeuniverse(512, 0);
-        wholeuniverse.replace(0, data.length(), data);
-        m_packetizer->setupE131Dmx(dmxPacket, outUniverse, outPriority, wholeuniverse);
+        return;
     }
+
+    UniverseInfo &info = it.value();
+    int length = info.outputTransmissionMode == Full ? 512 : data.length();
+
+    /* The packet headers only change with the universe settings.
+     * Prepare them once and just patch the values afterwards */
+    if (info.outputPacket.size() != E131_DMX_HEADER_SIZE + length)
+        m_packetizer->setupE131DmxTemplate(info.outputPacket, info.outputUniverse, info.outputPriority,
+                                           length, info.outputSyncAddress);
+
+    E131Packetizer::updateE131Dmx(info.outputPacket, info.outputSequence++, data);
+
+    qint64 sent;
+    if (info.outputMulticast)
+        sent = m_UdpSocket->writeDatagram(info.outputPacket, info.outputMcastAddress, E131_DEFAULT_PORT);
     else
-        m_packetizer->setupE131Dmx(dmxPacket, outUniverse, outPriority, data);
+        sent = m_UdpSocket->writeDatagram(info.outputPacket, info.outputUcastAddress, info.outputUcastPort);
 
-    qint64 sent = m_UdpSocket->writeDatagram(dmxPacket.data(), dmxPacket.size(),
-                                             outAddress, outPort);
     if (sent < 0)
     {
         qDebug() << "sendDmx failed";
@@ -384,7 +424,57 @@ void E131Controller::sendDmx(const quint32 universe, const QByteArray &data)
         qDebug() << "Errmsg: " << m_UdpSocket->errorString();
     }
     else
+    {
         m_packetSent++;
+        if (info.outputSyncAddress != 0 && m_syncSender != NULL)
+            m_syncSender->universeSent(info.outputSyncAddress);
+    }
+}
+
+void E131Controller::flushDmx()
+{
+    QMutexLocker locker(&m_dataMutex);
+
+    if (m_syncSender != NULL)
+        m_syncSender->flush();
+}
+
+void E131Controller::updateSyncGroups()
+{
+    QMap<quint16, QList<E131Destination> > destinations;
+
+    foreach (UniverseInfo const& info, m_universeMap)
+    {
+        if ((info.type & Output) == 0 || info.outputSyncAddress == 0)
+            continue;
+
+        /* Sync packets go to the multicast address of the sync universe,
+         * and to every unicast receiver of the group */
+        E131Destination destination;
+        if (info.outputMulticast)
+            destination = E131Destination(E131Packetizer::multicastAddress(info.outputSyncAddress),
+                                          E131_DEFAULT_PORT);
+        else
+            destination = E131Destination(info.outputUcastAddress, info.outputUcastPort);
+
+        if (destinations[info.outputSyncAddress].contains(destination) == false)
+            destinations[info.outputSyncAddress].append(destination);
+    }
+
+    if (destinations.isEmpty() && m_syncSender == NULL)
+        return;
+
+    if (m_syncSender == NULL)
+        m_syncSender = new E131SyncSender(m_interface, m_ipAddr);
+
+    m_syncSender->clearGroups();
+
+    QMapIterator<quint16, QList<E131Destination> > it(destinations);
+    while (it.hasNext())
+    {
+        it.next();
+        m_syncSender->setGroup(it.key(), it.value());
+    }
 }
 
 void E131Controller::processPendingPackets()
@@ -401,8 +491,12 @@ void E131Controller::processPendingPackets()
 
         QByteArray dmxData;
         quint32 e131universe;
+        QByteArray cid;
+        int priority;
+        bool terminated;
         if (m_packetizer->checkPacket(datagram)
-                && m_packetizer->fillDMXdata(datagram, dmxData, e131universe))
+                && m_packetizer->fillDMXdata(datagram, dmxData, e131universe)
+                && m_packetizer->fillSourceInfo(datagram, cid, priority, terminated))
         {
             qDebug() << "Received packet with size: " << datagram.size() << ", from: " << senderAddress.toString()
                 << ", for E1.31 universe: " << e131universe;
@@ -414,19 +508,20 @@ void E131Controller::processPendingPackets()
                 UniverseInfo const& info = it.value();
                 if (info.inputSocket == socket && info.inputUniverse == e131universe)
                 {
-                    QByteArray *dmxValues;
-                    if (m_dmxValuesMap.contains(universe) == false)
-                        m_dmxValuesMap[universe] = new QByteArray(512, 0);
-                    dmxValues = m_dmxValuesMap[universe];
-
-                    for (int i = 0; i < dmxData.length(); i++)
+                    DmxInputMerger *merger = m_inputMergers.value(universe, NULL);
+                    if (merger == NULL)
                     {
-                        if (dmxValues->at(i) != dmxData.at(i))
-                        {
-                            dmxValues->replace(i, 1, (const char *)(dmxData.data() + i), 1);
-                            emit valueChanged(universe, m_line, i, (uchar)dmxData.at(i));
-                        }
+                        merger = new DmxInputMerger();
+                        merger->setMergeMode(DmxInputMerger::MergeMode(info.inputMergeMode));
+                        m_inputMergers[universe] = merger;
                     }
+
+                    if (terminated)
+                        merger->removeSource(cid);
+                    else
+                        merger->addFrame(cid, dmxData, priority);
+
+                    emit frameReceived(universe, m_line, merger->frame());
                 }
             }
         }
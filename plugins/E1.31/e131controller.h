@@ -32,6 +32,8 @@
 #include <QMutex>
 #include <QTimer>
 
+#include "dmxinputmerger.h"
+#include "e131syncsender.h"
 #include "e131packetizer.h"
 
 #define E131_DEFAULT_PORT     5568
@@ -43,6 +45,7 @@ typedef struct
     quint16 inputUcastPort;
     quint16 inputUniverse;
     QSharedPointer<QUdpSocket> inputSocket;
+    int inputMergeMode;
 
     bool outputMulticast;
     QHostAddress outputMcastAddress;
@@ -51,6 +54,12 @@ typedef struct
     quint16 outputUniverse;
     int outputTransmissionMode;
     int outputPriority;
+    /** Synchronization universe. 0 means no synchronization */
+    quint16 outputSyncAddress;
+
+    /** The output packet template, patched at each transmission */
+    QByteArray outputPacket;
+    uchar outputSequence;
 
     int type;
 } UniverseInfo;
@@ -76,6 +85,9 @@ public:
     /** Send DMX data to a specific port/universe */
     void sendDmx(const quint32 universe, const QByteArray& data);
 
+    /** Send the sync packets of the universes sent during the current tick */
+    void flushDmx();
+
     /** Return the controller IP address */
     QString getNetworkIP();
 
@@ -97,6 +109,10 @@ public:
     /** Set a specific E1.31 input universe for the given QLC+ universe */
     void setInputUniverse(quint32 universe, quint32 e131Uni);
 
+    /** Set how the sources with the same priority sending
+     *  to the given QLC+ universe are merged */
+    void setInputMergeMode(quint32 universe, DmxInputMerger::MergeMode mode);
+
     /** Set output as multicast for the given QLC+ universe */
     void setOutputMulticast(quint32 universe, bool multicast);
 
@@ -115,6 +131,10 @@ public:
     /** Set a specific E1.31 output priority for the given QLC+ universe */
     void setOutputPriority(quint32 universe, quint32 e131Priority);
 
+    /** Set the E1.31 synchronization universe of the given QLC+ universe.
+     *  0 disables synchronization */
+    void setOutputSyncAddress(quint32 universe, quint32 syncAddress);
+
     /** Set the transmission mode of the ArtNet DMX packets over the network.
      *  It can be 'Full', which transmits always 512 channels, or
      *  'Partial', which transmits only the channels actually used in a
@@ -149,6 +169,10 @@ public:
 private:
     QSharedPointer<QUdpSocket> getInputSocket(bool multicast, QHostAddress const& address, quint16 port);
 
+    /** Rebuild the synchronization groups from the output universes.
+     *  Called with m_dataMutex held */
+    void updateSyncGroups();
+
 private:
     /** The network interface associated to this controller */
     QNetworkInterface m_interface;
@@ -167,9 +191,13 @@ private:
     /** Helper class used to create or parse E131 packets */
     QScopedPointer<E131Packetizer> m_packetizer;
 
-    /** Keeps the current dmx values to send only the ones that changed */
-    /** It holds values for all the handled universes */
-    QMap<quint32, QByteArray*> m_dmxValuesMap;
+    /** The thread sending the synchronization packets. It is created
+     *  the first time an output universe is synchronized */
+    E131SyncSender *m_syncSender;
+
+    /** Merges the frames received from the sources of each input
+     *  universe. Accessed only by the thread receiving the packets */
+    QMap<quint32, DmxInputMerger*> m_inputMergers;
 
     /** Map of the QLC+ universes transmitted/received by this
      *  controller, with the related, specific parameters */
@@ -184,7 +212,7 @@ private slots:
     void processPendingPackets();
 
 signals:
-    void valueChanged(quint32 universe, quint32 input, quint32 channel, uchar value);
+    void frameReceived(quint32 universe, quint32 input, const QByteArray& data);
 };
 
 #endif
@@ -134,11 +134,6 @@ E131Packetizer::E131Packetizer()
 
     // DMX512-A START Code
     m_commonHeader.append((char)0x00);
-
-    m_sequence[0] = 1;
-    m_sequence[1] = 1;
-    m_sequence[2] = 1;
-    m_sequence[3] = 1;
 }
 
 E131Packetizer::~E131Packetizer()
@@ -149,17 +144,16 @@ E131Packetizer::~E131Packetizer()
  * Sender functions
  *********************************************************************/
 
-void E131Packetizer::setupE131Dmx(QByteArray& data, const int &universe, const int &priority, const QByteArray &values)
+void E131Packetizer::setupE131DmxTemplate(QByteArray& data, const int &universe, const int &priority,
+                                          const int &length, const int &syncAddress)
 {
-    data.clear();
-    data.append(m_commonHeader);
-
-    data.append(values);
+    data = m_commonHeader;
+    data.append(QByteArray(length, 0));
 
     int rootLayerSize = data.count() - 16;
     int e131LayerSize = data.count() - 38;
     int dmpLayerSize = data.count() - 115;
-    int valCountPlusOne = values.count() + 1;
+    int valCountPlusOne = length + 1;
 
     data[16] = 0x70 | (char)(rootLayerSize >> 8);
     data[17] = (char)(rootLayerSize & 0x00FF);
@@ -169,7 +163,8 @@ void E131Packetizer::setupE131Dmx(QByteArray& data, const int &universe, const i
 
     data[108] = (char) priority;
 
-    data[111] = m_sequence[universe];
+    data[109] = (char)(syncAddress >> 8);
+    data[110] = (char)(syncAddress & 0x00FF);
 
     data[113] = (char)(universe >> 8);
     data[114] = (char)(universe & 0x00FF);
@@ -179,11 +174,56 @@ void E131Packetizer::setupE131Dmx(QByteArray& data, const int &universe, const i
 
     data[123] = (char)(valCountPlusOne >> 8);
     data[124] = (char)(valCountPlusOne & 0x00FF);
+}
+
+void E131Packetizer::updateE131Dmx(QByteArray &data, uchar sequence, const QByteArray &values)
+{
+    int length = data.size() - E131_DMX_HEADER_SIZE;
+    int count = qMin(length, values.size());
+    char *packet = data.data();
+
+    packet[111] = (char)sequence;
+
+    memcpy(packet + E131_DMX_HEADER_SIZE, values.constData(), count);
+    if (count < length)
+        memset(packet + E131_DMX_HEADER_SIZE + count, 0, length - count);
+}
+
+void E131Packetizer::setupE131Sync(QByteArray &data, const int &syncAddress, uchar sequence)
+{
+    // Root layer, with the extended vector
+    data = m_commonHeader.left(38);
+    int rootLayerSize = E131_SYNC_SIZE - 16;
+    data[16] = 0x70 | (char)(rootLayerSize >> 8);
+    data[17] = (char)(rootLayerSize & 0x00FF);
+    data[21] = (char)0x08;
+
+    // Framing layer flags & PDU length
+    int syncLayerSize = E131_SYNC_SIZE - 38;
+    data.append(0x70 | (char)(syncLayerSize >> 8));
+    data.append((char)(syncLayerSize & 0x00FF));
+
+    // Identifies the synchronization packet
+    data.append((char)0x00);
+    data.append((char)0x00);
+    data.append((char)0x00);
+    data.append((char)0x01);
+
+    // Sequence number
+    data.append((char)sequence);
 
-    if (m_sequence[universe] == 0xff)
-        m_sequence[universe] = 1;
-    else
-        m_sequence[universe]++;
+    // Synchronization address
+    data.append((char)(syncAddress >> 8));
+    data.append((char)(syncAddress & 0x00FF));
+
+    // reserved
+    data.append('\0');
+    data.append('\0');
+}
+
+QHostAddress E131Packetizer::multicastAddress(const int &universe)
+{
+    return QHostAddress(quint32(0xEFFF0000) | quint32(universe & 0xFFFF));
 }
 
 bool E131Packetizer::checkPacket(QByteArray &data)
@@ -212,6 +252,10 @@ bool E131Packetizer::fillDMXdata(QByteArray& data, QByteArray &dmx, quint32 &uni
     if (data.isNull())
         return false;
 
+    /* Only DMX data. Other start codes (e.g. per-channel priorities) are not handled */
+    if (data[125] != (char)0x00)
+        return false;
+
     universe = (data[113] << 8) + data[114];
 
     unsigned int msb = (data[123] & 0xff);
@@ -224,3 +268,15 @@ bool E131Packetizer::fillDMXdata(QByteArray& data, QByteArray &dmx, quint32 &uni
     dmx.append(data.mid(126, length - 1));
     return true;
 }
+
+bool E131Packetizer::fillSourceInfo(QByteArray& data, QByteArray &cid, int &priority, bool &terminated)
+{
+    if (data.isNull())
+        return false;
+
+    cid = data.mid(22, 16);
+    priority = uchar(data[108]);
+    terminated = (data[112] & 0x40) != 0;
+
+    return true;
+}
@@ -27,6 +27,11 @@
 
 #define E131_PRIORITY_DEFAULT 100
 
+/** Size of the headers preceding the DMX values in a data packet */
+#define E131_DMX_HEADER_SIZE  126
+/** Size of a synchronization packet */
+#define E131_SYNC_SIZE        49
+
 class E131Packetizer
 {
     /*********************************************************************
@@ -41,8 +46,23 @@ public:
      * Sender functions
      *********************************************************************/
 
-    /** Prepare an E1.31 DMX packet */
-    void setupE131Dmx(QByteArray& data, const int& universe, const int& priority, const QByteArray &values);
+    /** Prepare the template of an E1.31 DMX packet carrying $length values.
+     *  Packets are then produced by patching the template with updateE131Dmx().
+     *  A non zero $syncAddress tells the receivers to wait for a synchronization
+     *  packet on that universe before outputting the values */
+    void setupE131DmxTemplate(QByteArray& data, const int& universe, const int& priority,
+                              const int& length, const int& syncAddress = 0);
+
+    /** Set the sequence number and the values of a packet prepared with
+     *  setupE131DmxTemplate(). $values are truncated or zero-padded to
+     *  the template length */
+    static void updateE131Dmx(QByteArray& data, uchar sequence, const QByteArray &values);
+
+    /** Prepare an E1.31 synchronization packet */
+    void setupE131Sync(QByteArray& data, const int& syncAddress, uchar sequence);
+
+    /** Get the multicast address of an E1.31 universe */
+    static QHostAddress multicastAddress(const int& universe);
 
     /*********************************************************************
      * Receiver functions
@@ -51,11 +71,16 @@ public:
     /** Verify the validity of an E1.31 packet and store the opCode in 'code' */
     bool checkPacket(QByteArray& data);
 
+    /** Extract the DMX values and the universe of an E1.31 DMX packet.
+     *  Packets with a non-zero start code are rejected */
     bool fillDMXdata(QByteArray& data, QByteArray& dmx, quint32 &universe);
 
+    /** Extract the CID of the sender of an E1.31 DMX packet, its
+     *  priority and whether it is terminating its stream */
+    bool fillSourceInfo(QByteArray& data, QByteArray& cid, int& priority, bool& terminated);
+
 private:
     QByteArray m_commonHeader;
-    QHash<int, uchar> m_sequence;
 };
 
 #endif
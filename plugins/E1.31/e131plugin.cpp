@@ -75,7 +75,7 @@ QString E131Plugin::name()
 
 int E131Plugin::capabilities() const
 {
-    return QLCIOPlugin::Output | QLCIOPlugin::Input | QLCIOPlugin::Infinite;
+    return QLCIOPlugin::Output | QLCIOPlugin::Input | QLCIOPlugin::Infinite | QLCIOPlugin::Network;
 }
 
 QString E131Plugin::pluginInfo()
@@ -169,8 +169,8 @@ bool E131Plugin::openOutput(quint32 output, quint32 universe)
         E131Controller *controller = new E131Controller(m_IOmapping.at(output).interface,
                                                         m_IOmapping.at(output).address,
                                                         output, this);
-        connect(controller, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)),
-                this, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)));
+        connect(controller, SIGNAL(frameReceived(quint32,quint32,QByteArray)),
+                this, SIGNAL(frameReceived(quint32,quint32,QByteArray)));
         m_IOmapping[output].controller = controller;
     }
 
@@ -208,6 +208,16 @@ void E131Plugin::writeUniverse(quint32 universe, quint32 output, const QByteArra
         controller->sendDmx(universe, data);
 }
 
+void E131Plugin::flushUniverses()
+{
+    for (int i = 0; i < m_IOmapping.count(); i++)
+    {
+        E131Controller *controller = m_IOmapping.at(i).controller;
+        if (controller != NULL)
+            controller->flushDmx();
+    }
+}
+
 /*************************************************************************
   * Inputs
   *************************************************************************/
@@ -239,8 +249,8 @@ bool E131Plugin::openInput(quint32 input, quint32 universe)
         E131Controller *controller = new E131Controller(m_IOmapping.at(input).interface,
                                                         m_IOmapping.at(input).address,
                                                         input, this);
-        connect(controller, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)),
-                this, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)));
+        connect(controller, SIGNAL(frameReceived(quint32,quint32,QByteArray)),
+                this, SIGNAL(frameReceived(quint32,quint32,QByteArray)));
         m_IOmapping[input].controller = controller;
     }
 
@@ -330,6 +340,17 @@ void E131Plugin::setParameter(quint32 universe, quint32 line, Capability type,
             controller->setInputUCastPort(universe, value.toUInt());
         else if (name == E131_UNIVERSE)
             controller->setInputUniverse(universe, value.toUInt());
+        else if (name == E131_MERGEMODE)
+        {
+            DmxInputMerger::MergeMode mode = DmxInputMerger::stringToMergeMode(value.toString());
+            controller->setInputMergeMode(universe, mode);
+            // HTP is the default, don't save it
+            if (mode == DmxInputMerger::HTP)
+            {
+                QLCIOPlugin::unSetParameter(universe, line, type, name);
+                return;
+            }
+        }
         else
         {
             qWarning() << Q_FUNC_INFO << name << "is not a valid E1.31 input parameter";
@@ -352,6 +373,16 @@ void E131Plugin::setParameter(quint32 universe, quint32 line, Capability type,
             controller->setOutputTransmissionMode(universe, E131Controller::stringToTransmissionMode(value.toString()));
         else if (name == E131_PRIORITY)
             controller->setOutputPriority(universe, value.toUInt());
+        else if (name == E131_SYNCUNIVERSE)
+        {
+            controller->setOutputSyncAddress(universe, value.toUInt());
+            // no synchronization is the default, don't save it
+            if (value.toUInt() == 0)
+            {
+                QLCIOPlugin::unSetParameter(universe, line, type, name);
+                return;
+            }
+        }
         else
             qWarning() << Q_FUNC_INFO << name << "is not a valid E1.31 output parameter";
     }
@@ -44,6 +44,8 @@ typedef struct
 #define E131_UNIVERSE "universe"
 #define E131_TRANSMITMODE "transmitMode"
 #define E131_PRIORITY "priority"
+#define E131_SYNCUNIVERSE "syncUniverse"
+#define E131_MERGEMODE "mergeMode"
 
 class E131Plugin : public QLCIOPlugin
 {
@@ -95,6 +97,9 @@ public:
     /** @reimp */
     void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
 
+    /** @reimp */
+    void flushUniverses();
+
     /*************************************************************************
      * Inputs
      *************************************************************************/
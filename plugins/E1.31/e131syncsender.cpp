@@ -0,0 +1,180 @@
+/*
+  Q Light Controller Plus
+  e131syncsender.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QMutexLocker>
+#include <QDebug>
+
+#include "e131syncsender.h"
+
+E131SyncSender::E131SyncSender(QNetworkInterface const& interface, QHostAddress const& address,
+                               QObject *parent)
+    : QThread(parent)
+    , m_interface(interface)
+    , m_ipAddr(address)
+    , m_running(false)
+    , m_flushRequested(false)
+    , m_pendingCount(0)
+    , m_packetsSent(0)
+{
+}
+
+E131SyncSender::~E131SyncSender()
+{
+    stop();
+}
+
+void E131SyncSender::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_running = false;
+        m_condition.wakeOne();
+    }
+    wait();
+}
+
+void E131SyncSender::clearGroups()
+{
+    QMutexLocker locker(&m_mutex);
+    m_groups.clear();
+    m_pendingCount = 0;
+}
+
+void E131SyncSender::setGroup(quint16 syncAddress, QList<E131Destination> const& destinations)
+{
+    QMutexLocker locker(&m_mutex);
+
+    SyncGroup group;
+    group.sent = false;
+    group.sequence = 0;
+    group.destinations = destinations;
+
+    if (m_groups.contains(syncAddress))
+    {
+        group.sent = m_groups[syncAddress].sent;
+        group.sequence = m_groups[syncAddress].sequence;
+    }
+
+    m_groups[syncAddress] = group;
+
+    if (m_running == false)
+    {
+        m_running = true;
+        start(QThread::HighPriority);
+    }
+}
+
+void E131SyncSender::universeSent(quint16 syncAddress)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QMap<quint16, SyncGroup>::iterator it = m_groups.find(syncAddress);
+    if (it == m_groups.end())
+        return;
+
+    if (it.value().sent == false)
+    {
+        it.value().sent = true;
+        m_pendingCount++;
+    }
+}
+
+void E131SyncSender::flush()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_running == false || m_pendingCount == 0)
+        return;
+
+    m_flushRequested = true;
+    m_condition.wakeOne();
+}
+
+quint64 E131SyncSender::packetsSent() const
+{
+    return m_packetsSent.load();
+}
+
+void E131SyncSender::run()
+{
+    /* The socket lives in this thread, like the controller one */
+    QUdpSocket udpSocket;
+    udpSocket.bind(m_ipAddr, 0);
+    udpSocket.setMulticastInterface(m_interface);
+    udpSocket.setSocketOption(QAbstractSocket::MulticastLoopbackOption, false);
+
+    QMutexLocker locker(&m_mutex);
+
+    while (m_running)
+    {
+        if (m_flushRequested == false)
+        {
+            m_condition.wait(&m_mutex);
+            continue;
+        }
+
+        m_flushRequested = false;
+        if (m_pendingCount == 0)
+            continue;
+
+        /* One sync packet per group sent during the tick */
+        int count = 0;
+        QMap<quint16, SyncGroup>::iterator it = m_groups.begin();
+        for (; it != m_groups.end(); ++it)
+        {
+            SyncGroup &group = it.value();
+            if (group.sent == false)
+                continue;
+
+            if (count == m_syncPackets.count())
+            {
+                m_syncPackets.append(QByteArray());
+                m_syncDestinations.append(QList<E131Destination>());
+            }
+
+            m_packetizer.setupE131Sync(m_syncPackets[count], it.key(), group.sequence++);
+            m_syncDestinations[count] = group.destinations;
+            group.sent = false;
+            count++;
+        }
+
+        m_pendingCount = 0;
+
+        /* Don't make universeSent() wait for the network */
+        locker.unlock();
+
+        for (int i = 0; i < count; i++)
+        {
+            foreach (E131Destination const& destination, m_syncDestinations.at(i))
+            {
+                qint64 sent = udpSocket.writeDatagram(m_syncPackets.at(i), destination.first, destination.second);
+                if (sent < 0)
+                {
+                    qDebug() << "sendSync failed";
+                    qDebug() << "Errno: " << udpSocket.error();
+                    qDebug() << "Errmsg: " << udpSocket.errorString();
+                }
+                else
+                    m_packetsSent.fetchAndAddRelaxed(1);
+            }
+        }
+
+        locker.relock();
+    }
+}
@@ -0,0 +1,119 @@
+/*
+  Q Light Controller Plus
+  e131syncsender.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef E131SYNCSENDER_H
+#define E131SYNCSENDER_H
+
+#if defined(ANDROID)
+#include <QNetworkInterface>
+#include <QHostAddress>
+#include <QUdpSocket>
+#else
+#include <QtNetwork>
+#endif
+#include <QWaitCondition>
+#include <QAtomicInteger>
+#include <QThread>
+#include <QVector>
+#include <QMutex>
+#include <QPair>
+#include <QMap>
+
+#include "e131packetizer.h"
+
+typedef QPair<QHostAddress, quint16> E131Destination;
+
+/**
+ * E131SyncSender sends the E1.31 synchronization packets of an
+ * E131Controller from a dedicated thread.
+ *
+ * Universes sharing the same synchronization address form a group.
+ * When flush() is called at the end of a tick, one sync packet is sent
+ * to the destinations of each group having universes sent during the
+ * tick, and the receivers output all the universes of the group at once.
+ *
+ * The sync packets are sent through a socket owned by the thread,
+ * bound to the same address as the controller one, since QUdpSocket
+ * can't be shared between threads.
+ */
+class E131SyncSender : public QThread
+{
+    Q_OBJECT
+
+public:
+    E131SyncSender(QNetworkInterface const& interface, QHostAddress const& address,
+                   QObject *parent = 0);
+    ~E131SyncSender();
+
+    /** Stop the thread. Pending sync packets are dropped */
+    void stop();
+
+    /** Remove all the synchronization groups */
+    void clearGroups();
+
+    /** Define the synchronization group of $syncAddress
+     *  and the destinations of its sync packets */
+    void setGroup(quint16 syncAddress, QList<E131Destination> const& destinations);
+
+    /** Tell that a universe of the $syncAddress group has been sent */
+    void universeSent(quint16 syncAddress);
+
+    /** Send the sync packets of the groups sent during the current tick.
+     *  This is called once per tick, after all the universes have been sent */
+    void flush();
+
+    /** Get the number of packets sent so far */
+    quint64 packetsSent() const;
+
+protected:
+    /** @reimp */
+    void run();
+
+private:
+    typedef struct
+    {
+        bool sent;
+        uchar sequence;
+        QList<E131Destination> destinations;
+    } SyncGroup;
+
+    /** The interface and address the sync socket is bound to */
+    QNetworkInterface m_interface;
+    QHostAddress m_ipAddr;
+
+    E131Packetizer m_packetizer;
+
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    bool m_running;
+    bool m_flushRequested;
+
+    /** The synchronization groups, by sync address */
+    QMap<quint16, SyncGroup> m_groups;
+    int m_pendingCount;
+
+    /** Reused to build the sync packets of a tick, which are then
+     *  sent with m_mutex released */
+    QVector<QByteArray> m_syncPackets;
+    QVector<QList<E131Destination> > m_syncDestinations;
+
+    QAtomicInteger<quint64> m_packetsSent;
+};
+
+#endif
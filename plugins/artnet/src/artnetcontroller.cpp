@@ -40,6 +40,7 @@ ArtNetController::ArtNetController(QNetworkInterface const& interface, QNetworkA
     , m_line(line)
     , m_udpSocket(udpSocket)
     , m_packetizer(new ArtNetPacketizer())
+    , m_sender(NULL)
     , m_pollTimer(NULL)
 {
     if (m_ipAddr == QHostAddress::LocalHost)
@@ -59,7 +60,8 @@ ArtNetController::ArtNetController(QNetworkInterface const& interface, QNetworkA
 ArtNetController::~ArtNetController()
 {
     qDebug() << Q_FUNC_INFO;
-    qDeleteAll(m_dmxValuesMap);
+    delete m_sender;
+    qDeleteAll(m_inputMergers);
 }
 
 ArtNetController::Type ArtNetController::type()
@@ -80,6 +82,11 @@ quint32 ArtNetController::line()
 
 quint64 ArtNetController::getPacketSentNumber()
 {
+    QMutexLocker locker(&m_dataMutex);
+
+    if (m_sender != NULL)
+        return m_packetSent + m_sender->packetsSent();
+
     return m_packetSent;
 }
 
@@ -114,6 +121,7 @@ void ArtNetController::addUniverse(quint32 universe, ArtNetController::Type type
     {
         UniverseInfo info;
         info.inputUniverse = universe;
+        info.inputMergeMode = DmxInputMerger::HTP;
         info.outputAddress = m_broadcastAddr;
         info.outputUniverse = universe;
         info.outputTransmissionMode = Full;
@@ -121,6 +129,14 @@ void ArtNetController::addUniverse(quint32 universe, ArtNetController::Type type
         m_universeMap[universe] = info;
     }
 
+    if (type == Output)
+    {
+        QMutexLocker locker(&m_dataMutex);
+        if (m_sender == NULL)
+            m_sender = new ArtNetSender(m_udpSocket, m_broadcastAddr);
+    }
+    updateSenderUniverses();
+
     // send Polls if we open an Output
     if (type == Output && m_pollTimer == NULL)
     {
@@ -138,6 +154,9 @@ void ArtNetController::removeUniverse(quint32 universe, ArtNetController::Type t
 {
     if (m_universeMap.contains(universe))
     {
+        if (type == Input)
+            delete m_inputMergers.take(universe);
+
         if (m_universeMap[universe].type == type)
             m_universeMap.take(universe);
         else
@@ -149,8 +168,34 @@ void ArtNetController::removeUniverse(quint32 universe, ArtNetController::Type t
                        this, SLOT(slotSendPoll()));
             delete m_pollTimer;
             m_pollTimer = NULL;
+
+            QMutexLocker locker(&m_dataMutex);
+            if (m_sender != NULL)
+            {
+                m_packetSent += m_sender->packetsSent();
+                delete m_sender;
+                m_sender = NULL;
+            }
         }
+        updateSenderUniverses();
+    }
+}
+
+void ArtNetController::updateSenderUniverses()
+{
+    QMutexLocker locker(&m_dataMutex);
+
+    if (m_sender == NULL)
+        return;
+
+    int count = 0;
+    foreach (UniverseInfo info, m_universeMap.values())
+    {
+        if (info.type & Output)
+            count++;
     }
+
+    m_sender->setUniversesCount(count);
 }
 
 bool ArtNetController::setInputUniverse(quint32 universe, quint32 artnetUni)
@@ -164,6 +209,23 @@ bool ArtNetController::setInputUniverse(quint32 universe, quint32 artnetUni)
     return universe == artnetUni;
 }
 
+bool ArtNetController::setInputMergeMode(quint32 universe, DmxInputMerger::MergeMode mode)
+{
+    if (!m_universeMap.contains(universe))
+        return false;
+
+    m_universeMap[universe].inputMergeMode = int(mode);
+
+    DmxInputMerger *merger = m_inputMergers.value(universe, NULL);
+    if (merger != NULL)
+    {
+        merger->setMergeMode(mode);
+        emit frameReceived(universe, m_line, merger->frame());
+    }
+
+    return mode == DmxInputMerger::HTP;
+}
+
 bool ArtNetController::setOutputIPAddress(quint32 universe, QString address)
 {
     if (!m_universeMap.contains(universe))
@@ -259,7 +321,6 @@ UniverseInfo *ArtNetController::getUniverseInfo(quint32 universe)
 void ArtNetController::sendDmx(const quint32 universe, const QByteArray &data)
 {
     QMutexLocker locker(&m_dataMutex);
-    QByteArray dmxPacket;
     QHostAddress outAddress = m_broadcastAddr;
     quint32 outUniverse = universe;
     TransmissionMode transmitMode = Full;
@@ -272,24 +333,23 @@ void ArtNetController::sendDmx(const quint32 universe, const QByteArray &data)
         transmitMode = TransmissionMode(info.outputTransmissionMode);
     }
 
+    if (m_sender == NULL)
+        return;
+
     if (transmitMode == Full)
-    {
-        QByteArray wholeuniverse(512, 0);
-        wholeuniverse.replace(0, data.length(), data);
-        m_packetizer->setupArtNetDmx(dmxPacket, outUniverse, wholeuniverse);
-    }
+        m_packetizer->setupArtNetDmx(m_dmxPacket, outUniverse, data, 512);
     else
-        m_packetizer->setupArtNetDmx(dmxPacket, outUniverse, data);
+        m_packetizer->setupArtNetDmx(m_dmxPacket, outUniverse, data);
 
-    qint64 sent = m_udpSocket->writeDatagram(dmxPacket, outAddress, ARTNET_PORT);
-    if (sent < 0)
-    {
-        qWarning() << "sendDmx failed";
-        qWarning() << "Errno: " << m_udpSocket->error();
-        qWarning() << "Errmgs: " << m_udpSocket->errorString();
-    }
-    else
-        m_packetSent++;
+    m_sender->queuePacket(universe, m_dmxPacket, outAddress);
+}
+
+void ArtNetController::flushDmx()
+{
+    QMutexLocker locker(&m_dataMutex);
+
+    if (m_sender != NULL)
+        m_sender->flush();
 }
 
 bool ArtNetController::handleArtNetPollReply(QByteArray const& datagram, QHostAddress const& senderAddress)
@@ -328,8 +388,6 @@ bool ArtNetController::handleArtNetPoll(QByteArray const& datagram, QHostAddress
 
 bool ArtNetController::handleArtNetDmx(QByteArray const& datagram, QHostAddress const& senderAddress)
 {
-    Q_UNUSED(senderAddress);
-
     QByteArray dmxData;
     quint32 artnetUniverse;
     if (!m_packetizer->fillDMXdata(datagram, dmxData, artnetUniverse))
@@ -351,26 +409,24 @@ bool ArtNetController::handleArtNetDmx(QByteArray const& datagram, QHostAddress
 
         if ((info.type & Input) && info.inputUniverse == artnetUniverse)
         {
-            QByteArray *dmxValues;
-            if (m_dmxValuesMap.contains(universe) == false)
-                m_dmxValuesMap[universe] = new QByteArray(512, 0);
-            dmxValues = m_dmxValuesMap[universe];
+            DmxInputMerger *merger = m_inputMergers.value(universe, NULL);
+            if (merger == NULL)
+            {
+                merger = new DmxInputMerger();
+                merger->setMergeMode(DmxInputMerger::MergeMode(info.inputMergeMode));
+                m_inputMergers[universe] = merger;
+            }
 
 #if _DEBUG_RECEIVED_PACKETS
             qDebug() << "[ArtNet] -> universe" << (universe + 1);
 #endif
 
-            for (int i = 0; i < dmxData.length(); i++)
-            {
-                if (dmxValues->at(i) != dmxData.at(i))
-                {
-#if _DEBUG_RECEIVED_PACKETS
-                    qDebug() << "[ArtNet] a value differs";
-#endif
-                    dmxValues->replace(i, 1, (const char *)(dmxData.data() + i), 1);
-                    emit valueChanged(universe, m_line, i, (uchar)dmxData.at(i));
-                }
-            }
+            /* Art-Net has no source identifier: nodes are told apart by their address */
+            quint32 ip = senderAddress.toIPv4Address();
+            merger->addFrame(QByteArray((const char *)&ip, sizeof(ip)), dmxData);
+
+            emit frameReceived(universe, m_line, merger->frame());
+
             ++m_packetReceived;
             return true;
         }
@@ -33,12 +33,15 @@
 #include <QTimer>
 
 #include "artnetpacketizer.h"
+#include "dmxinputmerger.h"
+#include "artnetsender.h"
 
 #define ARTNET_PORT      6454
 
 typedef struct
 {
     ushort inputUniverse;
+    int inputMergeMode;
 
     QHostAddress outputAddress;
     ushort outputUniverse;
@@ -66,9 +69,13 @@ public:
 
     ~ArtNetController();
 
-    /** Send DMX data to a specific port/universe */
+    /** Queue DMX data of a specific port/universe for transmission.
+     *  The packets are sent by the output thread, as a batch */
     void sendDmx(const quint32 universe, const QByteArray& data);
 
+    /** Send the DMX data queued during the current tick */
+    void flushDmx();
+
     /** Return the controller IP address */
     QString getNetworkIP();
 
@@ -85,6 +92,10 @@ public:
      *  Return true if this restores default input universe */
     bool setInputUniverse(quint32 universe, quint32 artnetUni);
 
+    /** Set how the sources sending to the given QLC+ universe are merged.
+     *  Return true if this restores default merge mode */
+    bool setInputMergeMode(quint32 universe, DmxInputMerger::MergeMode mode);
+
     /** Set a specific output IP address for the given QLC+ universe.
      *  Return true if this restores default output IP address */
     bool setOutputIPAddress(quint32 universe, QString address);
@@ -159,9 +170,16 @@ private:
     /** Map of the ArtNet nodes discovered with ArtPoll */
     QHash<QHostAddress, ArtNetNodeInfo> m_nodesList;
 
-    /** Keeps the current dmx values to send only the ones that changed */
-    /** It holds values for all the handled universes */
-    QMap<int, QByteArray *> m_dmxValuesMap;
+    /** Merges the frames received from the nodes sending to each input
+     *  universe. Accessed only by the thread receiving the packets */
+    QMap<quint32, DmxInputMerger *> m_inputMergers;
+
+    /** Buffer reused to build the outgoing ArtDmx packets */
+    QByteArray m_dmxPacket;
+
+    /** The thread transmitting the ArtDmx packets. It exists
+     *  as long as at least one output universe is open */
+    ArtNetSender *m_sender;
 
     /** Map of the QLC+ universes transmitted/received by this
      *  controller, with the related, specific parameters */
@@ -173,6 +191,10 @@ private:
 
     QTimer* m_pollTimer;
 
+private:
+    /** Tell the sender how many universes are transmitted */
+    void updateSenderUniverses();
+
 private:
     bool handleArtNetPollReply(QByteArray const& datagram, QHostAddress const& senderAddress);
     bool handleArtNetPoll(QByteArray const& datagram, QHostAddress const& senderAddress);
@@ -188,7 +210,7 @@ protected slots:
     void slotSendPoll();
 
 signals:
-    void valueChanged(quint32 universe, quint32 input, quint32 channel, uchar value);
+    void frameReceived(quint32 universe, quint32 input, const QByteArray& data);
 };
 
 #endif
@@ -120,22 +120,27 @@ void ArtNetPacketizer::setupArtNetPollReply(QByteArray &data, QHostAddress ipAdd
         data.append((char)0x00); // bindIp[4], BindIndex, Status2 and filler
 }
 
-void ArtNetPacketizer::setupArtNetDmx(QByteArray& data, const int &universe, const QByteArray &values)
+void ArtNetPacketizer::setupArtNetDmx(QByteArray& data, const int &universe, const QByteArray &values,
+                                      int minLength)
 {
-    data.clear();
-    data.append(m_commonHeader);
-    const char opCodeMSB = (ARTNET_DMX >> 8);
-    data[9] = opCodeMSB;
-    data.append(m_sequence[universe]); // Sequence
-    data.append('\0'); // Physical
-    data.append((char)(universe & 0x00FF));
-    data.append((char)(universe >> 8));
-    int padLength = values.isEmpty() ? 2 : (values.length() % 2); // length must be even in the range 2-512
-    int len = values.length() + padLength;
-    data.append((char)(len >> 8));
-    data.append((char)(len & 0x00FF));
-    data.append(values);
-    data.append(QByteArray(padLength, 0));
+    int length = qMax(values.length(), minLength);
+    int padLength = length == 0 ? 2 : (length % 2); // length must be even in the range 2-512
+    int len = length + padLength;
+
+    data.resize(ARTNET_DMX_HEADER_SIZE + len);
+    char *packet = data.data();
+
+    memcpy(packet, m_commonHeader.constData(), m_commonHeader.length());
+    packet[9] = (ARTNET_DMX >> 8); // OpCode MSB
+    packet[12] = m_sequence[universe]; // Sequence
+    packet[13] = '\0'; // Physical
+    packet[14] = (char)(universe & 0x00FF);
+    packet[15] = (char)(universe >> 8);
+    packet[16] = (char)(len >> 8);
+    packet[17] = (char)(len & 0x00FF);
+
+    memcpy(packet + ARTNET_DMX_HEADER_SIZE, values.constData(), values.length());
+    memset(packet + ARTNET_DMX_HEADER_SIZE + values.length(), 0, len - values.length());
 
     if (m_sequence[universe] == 0xff)
         m_sequence[universe] = 1;
@@ -143,6 +148,16 @@ void ArtNetPacketizer::setupArtNetDmx(QByteArray& data, const int &universe, con
         m_sequence[universe]++;
 }
 
+void ArtNetPacketizer::setupArtNetSync(QByteArray &data)
+{
+    data.clear();
+    data.append(m_commonHeader);
+    const char opCodeMSB = (ARTNET_SYNC >> 8);
+    data[9] = opCodeMSB;
+    data.append('\0'); // Aux1
+    data.append('\0'); // Aux2
+}
+
 /*********************************************************************
  * Receiver functions
  *********************************************************************/
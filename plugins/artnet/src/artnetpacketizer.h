@@ -31,6 +31,7 @@
 #define ARTNET_COMMAND        0x2400
 #define ARTNET_DMX            0x5000
 #define ARTNET_NZS            0x5100
+#define ARTNET_SYNC           0x5200
 #define ARTNET_ADDRESS        0x6000
 #define ARTNET_INPUT          0x7000
 #define ARTNET_TODREQUEST     0x8000
@@ -62,6 +63,9 @@
 
 #define ARTNET_CODE_STR "Art-Net"
 
+#define ARTNET_DMX_HEADER_SIZE 18
+#define ARTNET_SYNC_SIZE       14
+
 typedef struct
 {
     QString shortName;
@@ -88,8 +92,13 @@ public:
     /** Prepare an ArtNetPollReply packet */
     void setupArtNetPollReply(QByteArray &data, QHostAddress ipAddr, QString MACaddr);
 
-    /** Prepare an ArtNetDmx packet */
-    void setupArtNetDmx(QByteArray& data, const int& universe, const QByteArray &values);
+    /** Prepare an ArtNetDmx packet. The $data storage is reused when
+     *  large enough, and $values are zero-padded up to $minLength */
+    void setupArtNetDmx(QByteArray& data, const int& universe, const QByteArray &values,
+                        int minLength = 0);
+
+    /** Prepare an ArtSync packet */
+    void setupArtNetSync(QByteArray& data);
 
     /*********************************************************************
      * Receiver functions
@@ -75,7 +75,7 @@ QString ArtNetPlugin::name()
 
 int ArtNetPlugin::capabilities() const
 {
-    return QLCIOPlugin::Output | QLCIOPlugin::Input | QLCIOPlugin::Infinite;
+    return QLCIOPlugin::Output | QLCIOPlugin::Input | QLCIOPlugin::Infinite | QLCIOPlugin::Network;
 }
 
 QString ArtNetPlugin::pluginInfo()
@@ -182,8 +182,8 @@ bool ArtNetPlugin::openOutput(quint32 output, quint32 universe)
                                                             m_IOmapping.at(output).address,
                                                             getUdpSocket(),
                                                             output, this);
-        connect(controller, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)),
-                this, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)));
+        connect(controller, SIGNAL(frameReceived(quint32,quint32,QByteArray)),
+                this, SIGNAL(frameReceived(quint32,quint32,QByteArray)));
         m_IOmapping[output].controller = controller;
     }
 
@@ -221,6 +221,16 @@ void ArtNetPlugin::writeUniverse(quint32 universe, quint32 output, const QByteAr
         controller->sendDmx(universe, data);
 }
 
+void ArtNetPlugin::flushUniverses()
+{
+    for (int i = 0; i < m_IOmapping.count(); i++)
+    {
+        ArtNetController *controller = m_IOmapping.at(i).controller;
+        if (controller != NULL)
+            controller->flushDmx();
+    }
+}
+
 /*************************************************************************
   * Inputs
   *************************************************************************/
@@ -252,8 +262,8 @@ bool ArtNetPlugin::openInput(quint32 input, quint32 universe)
                                                             m_IOmapping.at(input).address,
                                                             getUdpSocket(),
                                                             input, this);
-        connect(controller, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)),
-                this, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)));
+        connect(controller, SIGNAL(frameReceived(quint32,quint32,QByteArray)),
+                this, SIGNAL(frameReceived(quint32,quint32,QByteArray)));
         m_IOmapping[input].controller = controller;
     }
 
@@ -345,6 +355,8 @@ void ArtNetPlugin::setParameter(quint32 universe, quint32 line, Capability type,
     {
         if (name == ARTNET_INPUTUNI)
             unset = controller->setInputUniverse(universe, value.toUInt());
+        else if (name == ARTNET_MERGEMODE)
+            unset = controller->setInputMergeMode(universe, DmxInputMerger::stringToMergeMode(value.toString()));
         else
         {
             qWarning() << Q_FUNC_INFO << name << "is not a valid ArtNet input parameter";
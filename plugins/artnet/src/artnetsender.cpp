@@ -0,0 +1,262 @@
+/*
+  Q Light Controller Plus
+  artnetsender.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QVarLengthArray>
+#include <QMutexLocker>
+#include <QDebug>
+
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+ #include <sys/socket.h>
+ #include <netinet/in.h>
+ #include <arpa/inet.h>
+ #include <cstring>
+ #include <cerrno>
+ #define USE_SENDMMSG
+#endif
+
+#include "artnetpacketizer.h"
+#include "artnetcontroller.h"
+#include "artnetsender.h"
+
+ArtNetSender::ArtNetSender(QSharedPointer<QUdpSocket> const& udpSocket,
+                           QHostAddress const& syncAddress, QObject *parent)
+    : QThread(parent)
+    , m_udpSocket(udpSocket)
+    , m_syncAddress(syncAddress)
+    , m_running(false)
+    , m_flushRequested(false)
+    , m_pendingCount(0)
+    , m_universesCount(0)
+    , m_socketFamily(-1)
+    , m_packetsSent(0)
+{
+    ArtNetPacketizer packetizer;
+    packetizer.setupArtNetSync(m_syncPacket);
+}
+
+ArtNetSender::~ArtNetSender()
+{
+    stop();
+}
+
+void ArtNetSender::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_running = false;
+        m_condition.wakeOne();
+    }
+    wait();
+}
+
+void ArtNetSender::queuePacket(quint32 universe, QByteArray &packet, QHostAddress const& address)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_running == false)
+    {
+        m_running = true;
+        start(QThread::HighPriority);
+    }
+
+    PacketSlot &slot = m_slots[universe];
+    slot.packet.swap(packet);
+    slot.address = address;
+
+    if (slot.pending == false)
+    {
+        slot.pending = true;
+        m_pendingCount++;
+    }
+}
+
+void ArtNetSender::flush()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_running == false || m_pendingCount == 0)
+        return;
+
+    m_flushRequested = true;
+    m_condition.wakeOne();
+}
+
+void ArtNetSender::setUniversesCount(int count)
+{
+    QMutexLocker locker(&m_mutex);
+    m_universesCount = count;
+}
+
+quint64 ArtNetSender::packetsSent() const
+{
+    return m_packetsSent.load();
+}
+
+void ArtNetSender::run()
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (m_running)
+    {
+        if (m_flushRequested == false)
+        {
+            m_condition.wait(&m_mutex);
+            continue;
+        }
+
+        m_flushRequested = false;
+        if (m_pendingCount == 0)
+            continue;
+
+        /* Everything queued during the tick goes out as one batch,
+         * with a single ArtSync packet */
+        int count = takeBatch();
+        bool sync = m_universesCount > 1;
+
+        locker.unlock();
+        sendBatch(count, sync);
+        locker.relock();
+    }
+}
+
+int ArtNetSender::takeBatch()
+{
+    int count = 0;
+
+    QHash<quint32, PacketSlot>::iterator it = m_slots.begin();
+    for (; it != m_slots.end(); ++it)
+    {
+        PacketSlot &slot = it.value();
+        if (slot.pending == false)
+            continue;
+
+        if (count == m_batchPackets.count())
+        {
+            m_batchPackets.append(QByteArray());
+            m_batchAddresses.append(QHostAddress());
+        }
+
+        /* Hand the previously sent buffer back to the slot */
+        m_batchPackets[count].swap(slot.packet);
+        m_batchAddresses[count] = slot.address;
+        slot.pending = false;
+        count++;
+    }
+
+    m_pendingCount = 0;
+
+    return count;
+}
+
+void ArtNetSender::sendBatch(int count, bool sync)
+{
+    int total = sync ? count + 1 : count;
+
+#ifdef USE_SENDMMSG
+    int fd = int(m_udpSocket->socketDescriptor());
+    if (fd != -1)
+    {
+        /* The socket is bound dual-stack when IPv6 is available.
+         * In that case, IPv4 destinations must be given as mapped addresses */
+        if (m_socketFamily == -1)
+        {
+            struct sockaddr_storage local;
+            socklen_t length = sizeof(local);
+            if (::getsockname(fd, (struct sockaddr *)&local, &length) == 0)
+                m_socketFamily = local.ss_family;
+            else
+                m_socketFamily = AF_INET;
+        }
+
+        QVarLengthArray<struct mmsghdr, 64> messages(total);
+        QVarLengthArray<struct iovec, 64> vectors(total);
+        QVarLengthArray<struct sockaddr_storage, 64> addresses(total);
+
+        for (int i = 0; i < total; i++)
+        {
+            const QByteArray &packet = i < count ? m_batchPackets.at(i) : m_syncPacket;
+            const QHostAddress &address = i < count ? m_batchAddresses.at(i) : m_syncAddress;
+            socklen_t addressLength;
+
+            std::memset(&addresses[i], 0, sizeof(struct sockaddr_storage));
+            if (m_socketFamily == AF_INET6)
+            {
+                struct sockaddr_in6 *in6 = (struct sockaddr_in6 *)&addresses[i];
+                quint32 ip = htonl(address.toIPv4Address());
+                in6->sin6_family = AF_INET6;
+                in6->sin6_port = htons(ARTNET_PORT);
+                in6->sin6_addr.s6_addr[10] = 0xff;
+                in6->sin6_addr.s6_addr[11] = 0xff;
+                std::memcpy(&in6->sin6_addr.s6_addr[12], &ip, sizeof(ip));
+                addressLength = sizeof(struct sockaddr_in6);
+            }
+            else
+            {
+                struct sockaddr_in *in = (struct sockaddr_in *)&addresses[i];
+                in->sin_family = AF_INET;
+                in->sin_port = htons(ARTNET_PORT);
+                in->sin_addr.s_addr = htonl(address.toIPv4Address());
+                addressLength = sizeof(struct sockaddr_in);
+            }
+
+            vectors[i].iov_base = (void *)packet.constData();
+            vectors[i].iov_len = packet.size();
+
+            std::memset(&messages[i], 0, sizeof(struct mmsghdr));
+            messages[i].msg_hdr.msg_name = &addresses[i];
+            messages[i].msg_hdr.msg_namelen = addressLength;
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int sent = 0;
+        while (sent < total)
+        {
+            int ret = ::sendmmsg(fd, messages.data() + sent, total - sent, 0);
+            if (ret < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                qWarning() << "[ArtNet] sendmmsg failed:" << strerror(errno);
+                break;
+            }
+            sent += ret;
+        }
+
+        m_packetsSent.fetchAndAddRelaxed(sent);
+        return;
+    }
+#endif
+
+    for (int i = 0; i < total; i++)
+    {
+        const QByteArray &packet = i < count ? m_batchPackets.at(i) : m_syncPacket;
+        const QHostAddress &address = i < count ? m_batchAddresses.at(i) : m_syncAddress;
+
+        qint64 sent = m_udpSocket->writeDatagram(packet, address, ARTNET_PORT);
+        if (sent < 0)
+        {
+            qWarning() << "sendDmx failed";
+            qWarning() << "Errno: " << m_udpSocket->error();
+            qWarning() << "Errmgs: " << m_udpSocket->errorString();
+        }
+        else
+            m_packetsSent.fetchAndAddRelaxed(1);
+    }
+}
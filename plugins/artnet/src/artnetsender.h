@@ -0,0 +1,127 @@
+/*
+  Q Light Controller Plus
+  artnetsender.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef ARTNETSENDER_H
+#define ARTNETSENDER_H
+
+#if defined(ANDROID)
+#include <QHostAddress>
+#include <QUdpSocket>
+#include <QSharedPointer>
+#else
+#include <QtNetwork>
+#endif
+#include <QWaitCondition>
+#include <QAtomicInteger>
+#include <QThread>
+#include <QVector>
+#include <QMutex>
+#include <QHash>
+
+/**
+ * ArtNetSender transmits the ArtDmx packets of an ArtNetController from
+ * a dedicated thread, so that the universe threads never block on the
+ * network.
+ *
+ * The packets queued during a tick are sent together in a single batch
+ * (one sendmmsg() call where available) when flush() is called at the
+ * end of the tick. The batch is followed by one ArtSync packet when more
+ * than one universe is transmitted, so that the receiving nodes output
+ * all the universes at the same time.
+ */
+class ArtNetSender : public QThread
+{
+    Q_OBJECT
+
+public:
+    ArtNetSender(QSharedPointer<QUdpSocket> const& udpSocket,
+                 QHostAddress const& syncAddress, QObject *parent = 0);
+    ~ArtNetSender();
+
+    /** Stop the sender thread, dropping the packets not sent yet */
+    void stop();
+
+    /**
+     * Queue the ArtDmx $packet of $universe for transmission to $address.
+     * A packet still queued for the same universe is replaced.
+     * The content of $packet is swapped with a previously sent buffer,
+     * so that no memory is allocated once running.
+     */
+    void queuePacket(quint32 universe, QByteArray& packet, QHostAddress const& address);
+
+    /** Send the packets queued during the current tick. This is called
+     *  once per tick, after all the universes have been written */
+    void flush();
+
+    /** Set the number of universes transmitted at each tick.
+     *  An ArtSync packet follows each batch when there is more than one */
+    void setUniversesCount(int count);
+
+    /** Get the number of packets sent so far */
+    quint64 packetsSent() const;
+
+protected:
+    /** @reimp */
+    void run();
+
+private:
+    /** Move the queued packets to the batch. Called with m_mutex held */
+    int takeBatch();
+
+    /** Send the first $count packets of the batch, followed
+     *  by an ArtSync packet if $sync is true */
+    void sendBatch(int count, bool sync);
+
+private:
+    typedef struct
+    {
+        QByteArray packet;
+        QHostAddress address;
+        bool pending;
+    } PacketSlot;
+
+    /** The UDP socket shared with the controller */
+    QSharedPointer<QUdpSocket> m_udpSocket;
+
+    /** Address and content of the ArtSync packet */
+    QHostAddress m_syncAddress;
+    QByteArray m_syncPacket;
+
+    /** Protects everything below, up to the batch */
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    bool m_running;
+    bool m_flushRequested;
+
+    /** The packets queued by the universe threads, by universe */
+    QHash<quint32, PacketSlot> m_slots;
+    int m_pendingCount;
+    int m_universesCount;
+
+    /** The batch being sent. Accessed only by the sender thread */
+    QVector<QByteArray> m_batchPackets;
+    QVector<QHostAddress> m_batchAddresses;
+
+    /** Address family of the socket, detected on the first batch */
+    int m_socketFamily;
+
+    QAtomicInteger<quint64> m_packetsSent;
+};
+
+#endif
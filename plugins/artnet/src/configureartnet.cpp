@@ -38,6 +38,7 @@
 #define KMapColumnIPAddress     2
 #define KMapColumnArtNetUni     3
 #define KMapColumnTransmitMode  4
+#define KMapColumnMergeMode     5
 
 #define PROP_UNIVERSE (Qt::UserRole + 0)
 #define PROP_LINE (Qt::UserRole + 1)
@@ -143,6 +144,13 @@ void ConfigureArtNet::fillMappingTree()
                 spin->setRange(0, ARTNET_UNIVERSE_MAX);
                 spin->setValue(info->inputUniverse);
                 m_uniMapTree->setItemWidget(item, KMapColumnArtNetUni, spin);
+
+                QComboBox *mergeCombo = new QComboBox(this);
+                mergeCombo->addItem(tr("HTP"));
+                mergeCombo->addItem(tr("LTP"));
+                if (info->inputMergeMode == DmxInputMerger::LTP)
+                    mergeCombo->setCurrentIndex(1);
+                m_uniMapTree->setItemWidget(item, KMapColumnMergeMode, mergeCombo);
             }
             if (info->type & ArtNetController::Output)
             {
@@ -247,6 +255,19 @@ void ConfigureArtNet::accept()
                 m_plugin->setParameter(universe, line, cap, ARTNET_TRANSMITMODE,
                         ArtNetController::transmissionModeToString(transmissionMode));
             }
+
+            QComboBox *mergeCombo = qobject_cast<QComboBox*>(m_uniMapTree->itemWidget(item, KMapColumnMergeMode));
+            if (mergeCombo != NULL)
+            {
+                DmxInputMerger::MergeMode mergeMode;
+                if (mergeCombo->currentIndex() == 0)
+                    mergeMode = DmxInputMerger::HTP;
+                else
+                    mergeMode = DmxInputMerger::LTP;
+
+                m_plugin->setParameter(universe, line, cap, ARTNET_MERGEMODE,
+                        DmxInputMerger::mergeModeToString(mergeMode));
+            }
         }
     }
 
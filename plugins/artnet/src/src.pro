@@ -32,17 +32,21 @@ TRANSLATIONS += ArtNet_pt_BR.ts
 TRANSLATIONS += ArtNet_ca_ES.ts
 TRANSLATIONS += ArtNet_ja_JP.ts
 
-HEADERS += ../../interfaces/qlcioplugin.h
+HEADERS += ../../interfaces/qlcioplugin.h \
+           ../../interfaces/dmxinputmerger.h
 HEADERS += artnetpacketizer.h \
            artnetcontroller.h \
+           artnetsender.h \
            artnetplugin.h \
            configureartnet.h
 
 FORMS += configureartnet.ui
 
-SOURCES += ../../interfaces/qlcioplugin.cpp
+SOURCES += ../../interfaces/qlcioplugin.cpp \
+           ../../interfaces/dmxinputmerger.cpp
 SOURCES += artnetpacketizer.cpp \
            artnetcontroller.cpp \
+           artnetsender.cpp \
            artnetplugin.cpp \
            configureartnet.cpp
 
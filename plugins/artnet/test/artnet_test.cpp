@@ -22,6 +22,7 @@
 #define private public
 #include "artnet_test.h"
 #include "artnetpacketizer.h"
+#include "dmxinputmerger.h"
 #undef private
 
 /****************************************************************************
@@ -60,6 +61,100 @@ void ArtNet_Test::setupArtNetDmx()
 
     QCOMPARE(data.size(), 18 + 52);
     QCOMPARE(data.data(), "Art-Net");
+
+    // partial data padded to a full universe, reusing the buffer
+    ap.setupArtNetDmx(data, 0, fifty, 512);
+
+    QCOMPARE(data.size(), 18 + 512);
+    QCOMPARE(data.data(), "Art-Net");
+    QCOMPARE(int(data.at(18 + 49)), 10);
+    QCOMPARE(int(data.at(18 + 50)), 0);
+    QCOMPARE(int(data.at(18 + 511)), 0);
+    QCOMPARE(int(uchar(data.at(16))), 2);
+    QCOMPARE(int(uchar(data.at(17))), 0);
+}
+
+void ArtNet_Test::setupArtNetSync()
+{
+    ArtNetPacketizer ap;
+    QByteArray data;
+
+    ap.setupArtNetSync(data);
+
+    QCOMPARE(data.size(), ARTNET_SYNC_SIZE);
+    QCOMPARE(data.data(), "Art-Net");
+    QCOMPARE(int(uchar(data.at(8))), 0x00);
+    QCOMPARE(int(uchar(data.at(9))), 0x52);
+    QCOMPARE(int(uchar(data.at(10))), 0x00);
+    QCOMPARE(int(uchar(data.at(11))), 0x0e);
+    QCOMPARE(int(uchar(data.at(12))), 0x00);
+    QCOMPARE(int(uchar(data.at(13))), 0x00);
+}
+
+void ArtNet_Test::inputMerger()
+{
+    DmxInputMerger merger;
+    QCOMPARE(merger.mergeMode(), DmxInputMerger::HTP);
+    QCOMPARE(merger.sourcesCount(), 0);
+    QVERIFY(merger.frame().isEmpty());
+
+    QByteArray first(512, 0);
+    first[0] = 100;
+    first[1] = 20;
+    QByteArray second(512, 0);
+    second[0] = 50;
+    second[1] = 200;
+    second[511] = 1;
+
+    /* A single source goes through as is */
+    merger.addFrame("A", first);
+    QCOMPARE(merger.sourcesCount(), 1);
+    QCOMPARE(merger.frame(), first);
+
+    /* HTP: the highest value of each channel */
+    merger.addFrame("B", second);
+    QCOMPARE(merger.sourcesCount(), 2);
+    QCOMPARE(int(uchar(merger.frame().at(0))), 100);
+    QCOMPARE(int(uchar(merger.frame().at(1))), 200);
+    QCOMPARE(int(uchar(merger.frame().at(511))), 1);
+
+    /* LTP: the latest change of each channel */
+    merger.setMergeMode(DmxInputMerger::LTP);
+    QCOMPARE(merger.frame(), second);
+    first[0] = 10;
+    merger.addFrame("A", first);
+    QCOMPARE(int(uchar(merger.frame().at(0))), 10);
+    QCOMPARE(int(uchar(merger.frame().at(1))), 200);
+    QCOMPARE(int(uchar(merger.frame().at(511))), 1);
+
+    /* A full merge (here, a new source) keeps the owner of each channel */
+    merger.addFrame("C", QByteArray(512, 0), MERGER_DEFAULT_PRIORITY - 1);
+    QCOMPARE(merger.sourcesCount(), 3);
+    QCOMPARE(int(uchar(merger.frame().at(0))), 10);
+    QCOMPARE(int(uchar(merger.frame().at(1))), 200);
+    QCOMPARE(int(uchar(merger.frame().at(511))), 1);
+    merger.removeSource("C");
+    QCOMPARE(int(uchar(merger.frame().at(0))), 10);
+    QCOMPARE(int(uchar(merger.frame().at(1))), 200);
+
+    /* Only the sources with the highest priority are merged */
+    merger.setMergeMode(DmxInputMerger::HTP);
+    merger.addFrame("A", first, MERGER_DEFAULT_PRIORITY + 1);
+    QCOMPARE(merger.frame(), first);
+
+    /* Sources can be removed, or time out */
+    merger.removeSource("A");
+    QCOMPARE(merger.sourcesCount(), 1);
+    QCOMPARE(merger.frame(), second);
+
+    merger.m_sources[0].lastSeen -= MERGER_SOURCE_TIMEOUT + 1;
+    merger.addFrame("A", first);
+    QCOMPARE(merger.sourcesCount(), 1);
+    QCOMPARE(merger.frame(), first);
+
+    QCOMPARE(DmxInputMerger::stringToMergeMode(MERGE_LTP), DmxInputMerger::LTP);
+    QCOMPARE(DmxInputMerger::stringToMergeMode("foo"), DmxInputMerger::HTP);
+    QCOMPARE(DmxInputMerger::mergeModeToString(DmxInputMerger::LTP), QString(MERGE_LTP));
 }
 
 QTEST_MAIN(ArtNet_Test)
@@ -28,6 +28,8 @@ class ArtNet_Test : public QObject
 
 private slots:
     void setupArtNetDmx();
+    void setupArtNetSync();
+    void inputMerger();
 };
 
 #endif
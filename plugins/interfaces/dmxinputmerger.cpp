@@ -0,0 +1,273 @@
+/*
+  Q Light Controller Plus
+  dmxinputmerger.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#   include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   include <arm_neon.h>
+#endif
+
+#include "dmxinputmerger.h"
+
+/** HTP merge of $count $src values into $dst */
+static void htpMerge(uchar *dst, const uchar *src, int count)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_max_epu8(d, s));
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; i + 16 <= count; i += 16)
+        vst1q_u8(dst + i, vmaxq_u8(vld1q_u8(dst + i), vld1q_u8(src + i)));
+#endif
+    for (; i < count; i++)
+    {
+        if (dst[i] < src[i])
+            dst[i] = src[i];
+    }
+}
+
+DmxInputMerger::DmxInputMerger()
+    : m_mergeMode(HTP)
+    , m_topPriority(-1)
+    , m_sequence(0)
+{
+    m_clock.start();
+}
+
+DmxInputMerger::~DmxInputMerger()
+{
+}
+
+DmxInputMerger::MergeMode DmxInputMerger::mergeMode() const
+{
+    return m_mergeMode;
+}
+
+void DmxInputMerger::setMergeMode(DmxInputMerger::MergeMode mode)
+{
+    if (m_mergeMode == mode)
+        return;
+
+    m_mergeMode = mode;
+    merge();
+}
+
+QString DmxInputMerger::mergeModeToString(DmxInputMerger::MergeMode mode)
+{
+    switch (mode)
+    {
+        default:
+        case HTP:
+            return QString(MERGE_HTP);
+        break;
+        case LTP:
+            return QString(MERGE_LTP);
+        break;
+    }
+}
+
+DmxInputMerger::MergeMode DmxInputMerger::stringToMergeMode(const QString &mode)
+{
+    if (mode == QString(MERGE_LTP))
+        return LTP;
+    else
+        return HTP;
+}
+
+void DmxInputMerger::addFrame(QByteArray const& source, QByteArray const& data, int priority)
+{
+    qint64 now = m_clock.elapsed();
+    bool sourcesChanged = removeExpiredSources(now);
+
+    int index = 0;
+    while (index < m_sources.count() && m_sources.at(index).id != source)
+        index++;
+
+    if (index == m_sources.count())
+    {
+        Source newSource;
+        newSource.id = source;
+        newSource.priority = priority;
+        newSource.lastSeen = now;
+        m_sources.append(newSource);
+        sourcesChanged = true;
+    }
+
+    Source &src = m_sources[index];
+    int length = data.size();
+    int oldLength = qMin(src.data.size(), length);
+    const uchar *newValues = reinterpret_cast<const uchar *>(data.constData());
+    quint64 sequence = ++m_sequence;
+
+    /* A top priority source sending a frame of the same length only
+     * affects the channels it changed, as far as LTP is concerned */
+    if (m_mergeMode == LTP && sourcesChanged == false &&
+        src.priority == priority && priority == m_topPriority &&
+        src.data.size() == length && m_frame.size() >= length)
+    {
+        uchar *oldValues = reinterpret_cast<uchar *>(src.data.data());
+        quint64 *changes = src.changes.data();
+        uchar *frame = reinterpret_cast<uchar *>(m_frame.data());
+
+        for (int i = 0; i < length; i++)
+        {
+            if (oldValues[i] != newValues[i])
+            {
+                oldValues[i] = newValues[i];
+                changes[i] = sequence;
+                frame[i] = newValues[i];
+            }
+        }
+        src.lastSeen = now;
+        return;
+    }
+
+    /* Stamp the channels changed by this frame. The ones the source
+     * didn't send before count as changed */
+    src.changes.resize(length);
+    quint64 *changes = src.changes.data();
+    const uchar *oldValues = reinterpret_cast<const uchar *>(src.data.constData());
+
+    for (int i = 0; i < oldLength; i++)
+    {
+        if (oldValues[i] != newValues[i])
+            changes[i] = sequence;
+    }
+    for (int i = oldLength; i < length; i++)
+        changes[i] = sequence;
+
+    /* Copy the values into the buffer of the source, which is
+     * reallocated only when its length changes */
+    src.data.resize(length);
+    memcpy(src.data.data(), data.constData(), length);
+    src.priority = priority;
+    src.lastSeen = now;
+
+    merge();
+}
+
+void DmxInputMerger::removeSource(QByteArray const& source)
+{
+    for (int i = 0; i < m_sources.count(); i++)
+    {
+        if (m_sources.at(i).id == source)
+        {
+            m_sources.remove(i);
+            merge();
+            return;
+        }
+    }
+}
+
+int DmxInputMerger::sourcesCount() const
+{
+    return m_sources.count();
+}
+
+QByteArray const& DmxInputMerger::frame() const
+{
+    return m_frame;
+}
+
+bool DmxInputMerger::removeExpiredSources(qint64 now)
+{
+    bool removed = false;
+
+    for (int i = m_sources.count() - 1; i >= 0; i--)
+    {
+        if (now - m_sources.at(i).lastSeen > MERGER_SOURCE_TIMEOUT)
+        {
+            m_sources.remove(i);
+            removed = true;
+        }
+    }
+
+    return removed;
+}
+
+void DmxInputMerger::merge()
+{
+    /* Without sources, hold the last merged frame */
+    if (m_sources.isEmpty())
+    {
+        m_topPriority = -1;
+        return;
+    }
+
+    int length = 0;
+
+    m_topPriority = -1;
+    for (int i = 0; i < m_sources.count(); i++)
+    {
+        Source const& src = m_sources.at(i);
+        if (src.priority > m_topPriority)
+        {
+            m_topPriority = src.priority;
+            length = src.data.size();
+        }
+        else if (src.priority == m_topPriority)
+        {
+            length = qMax(length, src.data.size());
+        }
+    }
+
+    m_frame.resize(length);
+    uchar *frame = reinterpret_cast<uchar *>(m_frame.data());
+    memset(frame, 0, length);
+
+    if (m_mergeMode == LTP)
+    {
+        /* Each channel takes the value of the top priority source
+         * which changed it last */
+        m_latestChanges.fill(0, length);
+        quint64 *owners = m_latestChanges.data();
+
+        foreach (Source const& src, m_sources)
+        {
+            if (src.priority != m_topPriority)
+                continue;
+
+            const uchar *values = reinterpret_cast<const uchar *>(src.data.constData());
+            const quint64 *changes = src.changes.constData();
+
+            for (int i = 0; i < src.data.size(); i++)
+            {
+                if (changes[i] >= owners[i])
+                {
+                    owners[i] = changes[i];
+                    frame[i] = values[i];
+                }
+            }
+        }
+        return;
+    }
+
+    foreach (Source const& src, m_sources)
+    {
+        if (src.priority == m_topPriority)
+            htpMerge(frame, reinterpret_cast<const uchar *>(src.data.constData()), src.data.size());
+    }
+}
@@ -0,0 +1,133 @@
+/*
+  Q Light Controller Plus
+  dmxinputmerger.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef DMXINPUTMERGER_H
+#define DMXINPUTMERGER_H
+
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <QVector>
+#include <QString>
+
+/** Time in milliseconds after which a silent source is dropped
+ *  (the E1.31 network data loss timeout) */
+#define MERGER_SOURCE_TIMEOUT   2500
+
+/** Priority of the sources which don't provide one
+ *  (the E1.31 default priority) */
+#define MERGER_DEFAULT_PRIORITY 100
+
+#define MERGE_HTP "HTP"
+#define MERGE_LTP "LTP"
+
+/**
+ * DmxInputMerger merges the DMX frames received for the same universe
+ * from several network sources (e.g. redundant consoles).
+ *
+ * Each source has its own frame buffer. Only the sources with the highest
+ * priority contribute to the merged frame, either with the highest value
+ * of each channel (HTP) or with the latest change of each channel (LTP).
+ * For LTP, every source remembers when each of its channels last changed,
+ * so a channel is owned by the source which changed it last, whatever
+ * the other channels do.
+ * Sources which stop transmitting are dropped after a timeout.
+ *
+ * A merger is meant to be used by a single thread: the one receiving
+ * the packets of the universe.
+ */
+class DmxInputMerger
+{
+public:
+    enum MergeMode { HTP, LTP };
+
+    DmxInputMerger();
+    ~DmxInputMerger();
+
+    /** Get/Set the way sources with the same priority are merged */
+    MergeMode mergeMode() const;
+    void setMergeMode(MergeMode mode);
+
+    /** Converts a MergeMode value into a human readable string */
+    static QString mergeModeToString(MergeMode mode);
+
+    /** Converts a human readable string into a MergeMode value */
+    static MergeMode stringToMergeMode(const QString& mode);
+
+    /**
+     * Store the frame received from $source and update the merged frame.
+     *
+     * @param source an identifier of the source (e.g. the sACN CID or
+     *               the address of the sender)
+     * @param data the DMX values received
+     * @param priority the priority of the source
+     */
+    void addFrame(QByteArray const& source, QByteArray const& data,
+                  int priority = MERGER_DEFAULT_PRIORITY);
+
+    /** Remove $source (e.g. when it terminates its stream)
+     *  and update the merged frame */
+    void removeSource(QByteArray const& source);
+
+    /** Get the number of sources currently merged */
+    int sourcesCount() const;
+
+    /** Get the result of the last merge */
+    QByteArray const& frame() const;
+
+private:
+    /** Drop the sources not heard from in MERGER_SOURCE_TIMEOUT.
+     *  Return true if any source has been dropped */
+    bool removeExpiredSources(qint64 now);
+
+    /** Merge all the sources with the highest priority */
+    void merge();
+
+private:
+    typedef struct
+    {
+        QByteArray id;
+        QByteArray data;
+        /** The sequence number of the last change of each channel */
+        QVector<quint64> changes;
+        int priority;
+        qint64 lastSeen;
+    } Source;
+
+    /** Just a few sources are expected, so they're kept contiguous */
+    QVector<Source> m_sources;
+
+    MergeMode m_mergeMode;
+
+    /** The highest priority of the current sources */
+    int m_topPriority;
+
+    /** Incremented for every frame received, to order the LTP changes */
+    quint64 m_sequence;
+
+    /** The latest change of each channel found by an LTP merge,
+     *  kept to avoid reallocating it at every merge */
+    QVector<quint64> m_latestChanges;
+
+    /** The time base of the sources timeout */
+    QElapsedTimer m_clock;
+
+    QByteArray m_frame;
+};
+
+#endif
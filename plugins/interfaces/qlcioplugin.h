@@ -128,7 +128,10 @@ public:
         Output      = 1 << 0,
         Input       = 1 << 1,
         Feedback    = 1 << 2,
-        Infinite    = 1 << 3
+        Infinite    = 1 << 3,
+        /** Outputs are sent to network nodes holding the last values
+         *  received, so unchanged universes can be refreshed less often */
+        Network     = 1 << 4
     };
 
     /**
@@ -203,6 +206,13 @@ public:
      */
     virtual void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
 
+    /**
+     * Called once at the end of each MasterTimer tick, after all the
+     * universes of the tick have been written. Plugins batching their
+     * output can use this to transmit what has been written so far.
+     */
+    virtual void flushUniverses();
+
     /*************************************************************************
      * Inputs
      *************************************************************************/
@@ -282,6 +292,18 @@ signals:
      */
     void valueChanged(quint32 universe, quint32 input, quint32 channel, uchar value, const QString& key = 0);
 
+    /**
+     * Tells that a whole DMX frame has been received on an input line.
+     * Plugins receiving complete universes (e.g. from the network) use
+     * this instead of emitting valueChanged for each channel: the
+     * changed channels are detected by the receiving InputPatch.
+     *
+     * @param universe The universe ID detected from the data received
+     * @param input The input line which received the frame
+     * @param data The DMX values of the frame, starting from channel 0
+     */
+    void frameReceived(quint32 universe, quint32 input, const QByteArray& data);
+
     /*************************************************************************
      * Configure
      *************************************************************************/
@@ -33,6 +33,7 @@
 #define KMapColumnInputPort     2
 #define KMapColumnOutputAddress 3
 #define KMapColumnOutputPort    4
+#define KMapColumnOutputMode    5
 
 #define PROP_UNIVERSE (Qt::UserRole + 0)
 #define PROP_LINE (Qt::UserRole + 1)
@@ -159,6 +160,13 @@ void ConfigureOSC::fillMappingTree()
                 spin->setRange(1, 65535);
                 spin->setValue(info->outputPort);
                 m_uniMapTree->setItemWidget(item, KMapColumnOutputPort, spin);
+
+                QComboBox *modeCombo = new QComboBox(this);
+                modeCombo->addItem(tr("Single"), OSCController::Single);
+                modeCombo->addItem(tr("Bundle"), OSCController::Bundle);
+                modeCombo->addItem(tr("Blob"), OSCController::Blob);
+                modeCombo->setCurrentIndex(modeCombo->findData(info->outputMode));
+                m_uniMapTree->setItemWidget(item, KMapColumnOutputMode, modeCombo);
             }
         }
     }
@@ -221,6 +229,13 @@ void ConfigureOSC::accept()
                 else
                     m_plugin->setParameter(universe, line, cap, OSC_OUTPUTPORT, outSpin->value());
             }
+
+            QComboBox *modeCombo = qobject_cast<QComboBox*>(m_uniMapTree->itemWidget(item, KMapColumnOutputMode));
+            if (modeCombo != NULL)
+            {
+                OSCController::OutputMode mode = OSCController::OutputMode(modeCombo->itemData(modeCombo->currentIndex()).toInt());
+                m_plugin->setParameter(universe, line, cap, OSC_OUTPUTMODE, OSCController::outputModeToString(mode));
+            }
         }
     }
 
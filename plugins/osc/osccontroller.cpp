@@ -35,6 +35,9 @@ OSCController::OSCController(QString ipaddr, Type type, quint32 line, QObject *p
     qDebug() << "[OSCController] type: " << type;
     // Ensure packets will be sent from the correct interface
     m_outputSocket->bind(m_ipAddr, 0);
+
+    m_bundlePacket.reserve(OSC_MAX_BUNDLE_SIZE);
+    m_messagePacket.reserve(OSC_MAX_BUNDLE_SIZE);
 }
 
 OSCController::~OSCController()
@@ -72,6 +75,7 @@ void OSCController::addUniverse(quint32 universe, OSCController::Type type)
         }
         info.feedbackPort = 9000 + universe;
         info.outputPort = 9000 + universe;
+        info.outputMode = Single;
         info.type = type;
         m_universeMap[universe] = info;
     }
@@ -183,6 +187,44 @@ bool OSCController::setOutputPort(quint32 universe, quint16 port)
     return port == 9000 + universe;
 }
 
+bool OSCController::setOutputMode(quint32 universe, OSCController::OutputMode mode)
+{
+    if (m_universeMap.contains(universe) == false)
+        return false;
+
+    QMutexLocker locker(&m_dataMutex);
+    m_universeMap[universe].outputMode = mode;
+
+    return mode == Single;
+}
+
+QString OSCController::outputModeToString(OSCController::OutputMode mode)
+{
+    switch (mode)
+    {
+        default:
+        case Single:
+            return QString(OUTPUT_SINGLE);
+        break;
+        case Bundle:
+            return QString(OUTPUT_BUNDLE);
+        break;
+        case Blob:
+            return QString(OUTPUT_BLOB);
+        break;
+    }
+}
+
+OSCController::OutputMode OSCController::stringToOutputMode(const QString &mode)
+{
+    if (mode == QString(OUTPUT_BUNDLE))
+        return Bundle;
+    else if (mode == QString(OUTPUT_BLOB))
+        return Blob;
+    else
+        return Single;
+}
+
 QList<quint32> OSCController::universesList() const
 {
     return m_universeMap.keys();
@@ -243,20 +285,79 @@ void OSCController::sendDmx(const quint32 universe, const QByteArray &dmxData)
     QByteArray dmxPacket;
     QHostAddress outAddress = QHostAddress::Null;
     quint32 outPort = 7700 + universe;
+    int outputMode = Single;
 
     if (m_universeMap.contains(universe))
     {
         outAddress = m_universeMap[universe].outputAddress;
         outPort = m_universeMap[universe].outputPort;
+        outputMode = m_universeMap[universe].outputMode;
     }
 
-    for (int i = 0; i < dmxData.length(); i++)
+    if (m_dmxValuesMap.contains(universe) == false)
+        m_dmxValuesMap[universe] = new QByteArray(512, 0);
+
+    QByteArray *dmxValues = m_dmxValuesMap[universe];
+    int length = qMin(dmxData.length(), dmxValues->length());
+
+    if (outputMode == Bundle)
     {
-        if (m_dmxValuesMap.contains(universe) == false)
-            m_dmxValuesMap[universe] = new QByteArray(512, 0);
+        m_packetizer->setupOSCBundle(m_bundlePacket);
+
+        for (int i = 0; i < length; i++)
+        {
+            if (dmxData[i] == dmxValues->at(i))
+                continue;
 
-        QByteArray *dmxValues = m_dmxValuesMap[universe];
+            (*dmxValues)[i] = dmxData[i];
+            m_packetizer->setupOSCDmx(m_messagePacket, universe, i, dmxData[i]);
+            appendToBundle(m_messagePacket, outAddress, outPort);
+        }
+
+        sendBundle(outAddress, outPort);
+        return;
+    }
+    else if (outputMode == Blob)
+    {
+        m_packetizer->setupOSCBundle(m_bundlePacket);
 
+        int i = 0;
+        while (i < length)
+        {
+            if (dmxData[i] == dmxValues->at(i))
+            {
+                i++;
+                continue;
+            }
+
+            // Extend the range up to the last changed channel, as long
+            // as the unchanged channels in between are only a few
+            int start = i;
+            int end = i + 1;
+            for (int unchanged = 0; i < length && unchanged <= OSC_BLOB_MERGE_GAP; i++)
+            {
+                if (dmxData[i] != dmxValues->at(i))
+                {
+                    end = i + 1;
+                    unchanged = 0;
+                }
+                else
+                    unchanged++;
+            }
+
+            dmxValues->replace(start, end - start, dmxData.constData() + start, end - start);
+            m_packetizer->setupOSCDmxBlob(m_messagePacket, universe, start,
+                                          dmxData.constData() + start, end - start);
+            appendToBundle(m_messagePacket, outAddress, outPort);
+            i = end;
+        }
+
+        sendBundle(outAddress, outPort);
+        return;
+    }
+
+    for (int i = 0; i < length; i++)
+    {
         if (dmxData[i] != dmxValues->at(i))
         {
             dmxValues->replace(i, 1, (const char *)(dmxData.data() + i), 1);
@@ -274,6 +375,32 @@ void OSCController::sendDmx(const quint32 universe, const QByteArray &dmxData)
     }
 }
 
+void OSCController::appendToBundle(QByteArray const& message, QHostAddress const& address, quint16 port)
+{
+    if (m_bundlePacket.size() + 4 + message.size() > OSC_MAX_BUNDLE_SIZE)
+        sendBundle(address, port);
+
+    m_packetizer->appendOSCBundleMessage(m_bundlePacket, message);
+}
+
+void OSCController::sendBundle(QHostAddress const& address, quint16 port)
+{
+    if (m_bundlePacket.size() <= OSC_BUNDLE_HEADER_SIZE)
+        return;
+
+    qint64 sent = m_outputSocket->writeDatagram(m_bundlePacket.constData(), m_bundlePacket.size(),
+                                             address, port);
+    if (sent < 0)
+    {
+        qDebug() << "[OSC] sendDmx failed. Errno: " << m_outputSocket->error();
+        qDebug() << "Errmgs: " << m_outputSocket->errorString();
+    }
+    else
+        m_packetSent++;
+
+    m_packetizer->setupOSCBundle(m_bundlePacket);
+}
+
 void OSCController::sendFeedback(const quint32 universe, quint32 channel, uchar value, const QString &key)
 {
     QMutexLocker locker(&m_dataMutex);
@@ -36,6 +36,14 @@
 
 #include "oscpacketizer.h"
 
+#define OUTPUT_SINGLE "Single"
+#define OUTPUT_BUNDLE "Bundle"
+#define OUTPUT_BLOB   "Blob"
+
+/** Maximum number of unchanged channels between two changed
+ *  ranges for them to be merged into a single blob message */
+#define OSC_BLOB_MERGE_GAP 16
+
 typedef struct
 {
     QSharedPointer<QUdpSocket> inputSocket;
@@ -47,6 +55,7 @@ typedef struct
 
     QHostAddress outputAddress;
     quint16 outputPort;
+    int outputMode;
 
     // cache of the OSC paths with multiple values, used to correctly
     // handle the flow of input and feedback values
@@ -64,6 +73,12 @@ class OSCController : public QObject
 public:
     enum Type { Unknown = 0x0, Input = 0x01, Output = 0x02 };
 
+    /** How DMX changes are transmitted:
+     *  Single: one datagram per changed channel
+     *  Bundle: the changed channels packed into OSC bundles
+     *  Blob: the changed ranges sent as raw DMX blobs, packed into OSC bundles */
+    enum OutputMode { Single, Bundle, Blob };
+
     OSCController(QString ipaddr,
                    Type type, quint32 line, QObject *parent = 0);
 
@@ -101,6 +116,16 @@ public:
      *  Return true if this restores default output port */
     bool setOutputPort(quint32 universe, quint16 port);
 
+    /** Set the way DMX changes are transmitted for the given universe.
+     *  Return true if this restores the default output mode */
+    bool setOutputMode(quint32 universe, OutputMode mode);
+
+    /** Converts a OutputMode value into a human readable string */
+    static QString outputModeToString(OutputMode mode);
+
+    /** Converts a human readable string into a OutputMode value */
+    static OutputMode stringToOutputMode(const QString& mode);
+
     /** Return the list of the universes handled by
      *  this controller */
     QList<quint32> universesList() const;
@@ -129,6 +154,13 @@ public:
 private:
     QSharedPointer<QUdpSocket> getInputSocket(quint16 port);
 
+    /** Append $message to m_bundlePacket, sending the bundle first
+     *  if the message would not fit into it */
+    void appendToBundle(QByteArray const& message, QHostAddress const& address, quint16 port);
+
+    /** Send m_bundlePacket, if it contains any message */
+    void sendBundle(QHostAddress const& address, quint16 port);
+
 protected:
     /** Calculate a 16bit unsigned hash as a unique representation
      *  of a OSC path. If new, the hash is added to the hash map (m_hashMap) */
@@ -164,6 +196,10 @@ private:
     /** It holds values for all the handled universes */
     QMap<quint32, QByteArray *> m_dmxValuesMap;
 
+    /** Reused to build the outgoing bundles and their messages */
+    QByteArray m_bundlePacket;
+    QByteArray m_messagePacket;
+
     /** Map of the QLC+ universes transmitted/received by this
      *  controller, with the related, specific parameters */
     QMap<quint32, UniverseInfo> m_universeMap;
@@ -36,7 +36,7 @@ OSCPacketizer::~OSCPacketizer()
 
 void OSCPacketizer::setupOSCDmx(QByteArray &data, quint32 universe, quint32 channel, uchar value)
 {
-    data.clear();
+    data.resize(0);
     QString path = QString("/%1/dmx/%2").arg(universe).arg(channel);
     data.append(path);
 
@@ -92,6 +92,56 @@ void OSCPacketizer::setupOSCGeneric(QByteArray &data, QString &path, QString typ
     }
 }
 
+void OSCPacketizer::setupOSCDmxBlob(QByteArray &data, quint32 universe, quint32 channel,
+                                    const char *values, int length)
+{
+    data.resize(0);
+    QString path = QString("/%1/dmx/%2").arg(universe).arg(channel);
+    data.append(path);
+
+    // add trailing zeros to reach a multiple of 4
+    int zeroNumber = 4 - (path.length() % 4);
+    if (zeroNumber > 0)
+        data.append(QByteArray(zeroNumber, 0x00));
+
+    data.append(",b");
+    data.append((char)0x00);
+    data.append((char)0x00);
+
+    // Blob size, followed by the values padded to a multiple of 4
+    data.append((char)((length >> 24) & 0xFF));
+    data.append((char)((length >> 16) & 0xFF));
+    data.append((char)((length >> 8) & 0xFF));
+    data.append((char)(length & 0xFF));
+    data.append(values, length);
+
+    zeroNumber = (4 - (length % 4)) % 4;
+    if (zeroNumber > 0)
+        data.append(QByteArray(zeroNumber, 0x00));
+}
+
+void OSCPacketizer::setupOSCBundle(QByteArray &data)
+{
+    // keep the capacity reserved by the caller
+    data.resize(0);
+    data.append("#bundle");
+    data.append((char)0x00);
+
+    // Time tag 1 means "immediately"
+    data.append(QByteArray(7, 0x00));
+    data.append((char)0x01);
+}
+
+void OSCPacketizer::appendOSCBundleMessage(QByteArray &data, QByteArray const& message)
+{
+    int size = message.size();
+    data.append((char)((size >> 24) & 0xFF));
+    data.append((char)((size >> 16) & 0xFF));
+    data.append((char)((size >> 8) & 0xFF));
+    data.append((char)(size & 0xFF));
+    data.append(message);
+}
+
 /*********************************************************************
  * Receiver functions
  *********************************************************************/
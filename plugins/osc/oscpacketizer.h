@@ -26,6 +26,13 @@
 #ifndef OSCPACKETIZER_H
 #define OSCPACKETIZER_H
 
+/** Maximum size of an OSC bundle, to fit in a single
+ *  UDP datagram on an Ethernet link (1500 - IP/UDP headers) */
+#define OSC_MAX_BUNDLE_SIZE 1472
+
+/** Size of the '#bundle' string and time tag of an OSC bundle */
+#define OSC_BUNDLE_HEADER_SIZE 16
+
 class OSCPacketizer
 {
     /*********************************************************************
@@ -76,6 +83,35 @@ public:
      */
     void setupOSCGeneric(QByteArray& data, QString &path, QString types, QByteArray &values);
 
+    /**
+     * Prepare an OSC DMX message carrying a range of raw DMX values
+     * as a blob (OSC 'b'), using a OSC path like /$universe/dmx/$channel
+     *
+     * @param data the message composed by this function to be sent on the network
+     * @param universe the universe used to compose the OSC message path
+     * @param channel the first DMX channel of the range
+     * @param values the DMX values of the range
+     * @param length the number of DMX values of the range
+     */
+    void setupOSCDmxBlob(QByteArray& data, quint32 universe, quint32 channel,
+                         const char *values, int length);
+
+    /**
+     * Prepare an empty OSC bundle, to be executed immediately
+     *
+     * @param data the bundle composed by this function
+     */
+    void setupOSCBundle(QByteArray& data);
+
+    /**
+     * Append an OSC message to a bundle previously
+     * prepared with setupOSCBundle
+     *
+     * @param data the bundle the message is appended to
+     * @param message the OSC message to append
+     */
+    void appendOSCBundleMessage(QByteArray& data, QByteArray const& message);
+
     /*********************************************************************
      * Receiver functions
      *********************************************************************/
@@ -73,7 +73,8 @@ QString OSCPlugin::name()
 
 int OSCPlugin::capabilities() const
 {
-    return QLCIOPlugin::Output | QLCIOPlugin::Input | QLCIOPlugin::Feedback | QLCIOPlugin::Infinite;
+    return QLCIOPlugin::Output | QLCIOPlugin::Input | QLCIOPlugin::Feedback | QLCIOPlugin::Infinite |
+           QLCIOPlugin::Network;
 }
 
 QString OSCPlugin::pluginInfo()
@@ -337,6 +338,8 @@ void OSCPlugin::setParameter(quint32 universe, quint32 line, Capability type,
         unset = controller->setOutputIPAddress(universe, value.toString());
     else if (name == OSC_OUTPUTPORT)
         unset = controller->setOutputPort(universe, value.toUInt());
+    else if (name == OSC_OUTPUTMODE)
+        unset = controller->setOutputMode(universe, OSCController::stringToOutputMode(value.toString()));
     else
     {
         qWarning() << Q_FUNC_INFO << name << "is not a valid OSC parameter";
@@ -41,6 +41,7 @@ typedef struct
 #define OSC_FEEDBACKPORT "feedbackPort"
 #define OSC_OUTPUTIP "outputIP"
 #define OSC_OUTPUTPORT "outputPort"
+#define OSC_OUTPUTMODE "outputMode"
 
 
 class OSCPlugin : public QLCIOPlugin
@@ -25,6 +25,7 @@
 #include "contextmanager.h"
 #include "monitorproperties.h"
 #include "genericdmxsource.h"
+#include "universemonitor.h"
 #include "functionmanager.h"
 #include "fixturemanager.h"
 #include "qlcfixturemode.h"
@@ -91,7 +92,10 @@ ContextManager::ContextManager(QQuickView *view, Doc *doc,
     connect(m_fixtureManager, &FixtureManager::positionTypeValueChanged, this, &ContextManager::slotPositionChanged);
     connect(m_fixtureManager, &FixtureManager::presetChanged, this, &ContextManager::slotPresetChanged);
 
-    connect(m_doc->inputOutputMap(), SIGNAL(universeWritten(quint32,QByteArray)), this, SLOT(slotUniverseWritten(quint32,QByteArray)));
+    UniverseMonitor *monitor = new UniverseMonitor(m_doc->inputOutputMap(),
+                                                   UNIVERSEMONITOR_DEFAULT_RATE, this);
+    connect(monitor, SIGNAL(universeWritten(quint32,QByteArray,quint32)),
+            this, SLOT(slotUniverseWritten(quint32,QByteArray,quint32)));
     connect(m_functionManager, &FunctionManager::isEditingChanged, this, &ContextManager::slotFunctionEditingChanged);
 }
 
@@ -1264,13 +1268,10 @@ void ContextManager::slotPresetChanged(const QLCChannel *channel, quint8 value)
     }
 }
 
-void ContextManager::slotUniverseWritten(quint32 idx, const QByteArray &ua)
+void ContextManager::slotUniverseWritten(quint32 idx, const QByteArray &ua, quint32 changedBlocks)
 {
-    for (Fixture *fixture : m_doc->fixtures())
+    for (Fixture *fixture : m_doc->fixturesInBlocks(idx, changedBlocks))
     {
-        if (fixture->universe() != idx)
-            continue;
-
         QByteArray prevValues;
         prevValues.append(fixture->channelValues());
 
@@ -528,15 +528,15 @@ void RGBMatrixEditor::slotPreviewTimeout()
         m_previewStepHandler->checkNextStep(m_matrix->runOrder(), m_matrix->startColor(),
                                             m_matrix->endColor(), m_matrix->stepsCount());
 
-        map = m_matrix->previewMap(m_previewStepHandler->currentStepIndex(), m_previewStepHandler);
+        m_matrix->previewMap(m_previewStepHandler->currentStepIndex(), m_previewStepHandler, map);
 
         //qDebug() << "Step changing. Index:" << m_previewStepHandler->currentStepIndex() << ", map size:" << map.size();
 
         m_previewElapsed = 0;
 /*
-        for (int y = 0; y < map.size(); y++)
+        for (int y = 0; y < map.height(); y++)
         {
-            for (int x = 0; x < map[y].size(); x++)
+            for (int x = 0; x < map.width(); x++)
             {
                 QLCPoint pt(x, y);
                 if (m_group->head(pt).isValid())
@@ -563,7 +563,7 @@ void RGBMatrixEditor::slotPreviewTimeout()
             QLCPoint pt(it.key());
             //GroupHead head(it.value());
             int ptIdx = pt.x() + (pt.y() * m_group->size().width());
-            if (ptIdx < m_previewData.size())
+            if (ptIdx < m_previewData.size() && pt.x() < map.width() && pt.y() < map.height())
                 m_previewData[ptIdx] = QVariant(QColor(map[pt.y()][pt.x()]));
         }
 
@@ -91,7 +91,21 @@ function writeCurrentStep()
     for (var i = map.rows.length - 1; i >= 0; i--) {
         map.deleteRow(i);
     }
-    var rgb = testAlgo.rgbMap(width, height, getCurrentColorInt(), currentStep);
+    var rgb;
+    if (testAlgo.apiVersion >= 3)
+    {
+        // API v3 scripts fill a flat array of width * height pixels
+        var pixels = new Uint32Array(width * height);
+        testAlgo.rgbMap(width, height, getCurrentColorInt(), currentStep, pixels);
+        rgb = new Array(height);
+        for (var i = 0; i < height; i++) {
+            rgb[i] = pixels.subarray(i * width, (i + 1) * width);
+        }
+    }
+    else
+    {
+        rgb = testAlgo.rgbMap(width, height, getCurrentColorInt(), currentStep);
+    }
 
     for (var y = 0; y < height; y++)
     {
@@ -29,6 +29,7 @@ var testAlgo;
     {
         var algo = new Object;
         algo.apiVersion = 1;
+        algo.cacheable = true;
         algo.name = "Even/Odd";
         algo.author = "Heikki Junnila";
 
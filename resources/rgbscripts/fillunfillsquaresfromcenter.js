@@ -25,6 +25,7 @@ var testAlgo;
     {
         var algo = new Object;
         algo.apiVersion = 1;
+        algo.cacheable = true;
         algo.name = "Fill Unfill Squares From Center";
         algo.author = "David Garyga";
 
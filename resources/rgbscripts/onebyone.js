@@ -25,6 +25,7 @@ var testAlgo;
   {
     var algo = new Object;
     algo.apiVersion = 2;
+    algo.cacheable = true;
     algo.name = "One By One";
     algo.author = "Jano Svitok";
 
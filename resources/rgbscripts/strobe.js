@@ -24,6 +24,7 @@ var testAlgo;
     function () {
       var algo = {};
       algo.apiVersion = 2;
+      algo.cacheable = true;
       algo.name = "Strobe";
       algo.author = "Rob Nieuwenhuizen";
       algo.properties = [];
@@ -35,6 +35,7 @@
 #include "inputoutputmanager.h"
 #include "functionselection.h"
 #include "functionmanager.h"
+#include "universemonitor.h"
 #include "inputoutputmap.h"
 #include "virtualconsole.h"
 #include "fixturemanager.h"
@@ -300,8 +301,10 @@ void App::init()
     connect(m_doc->inputOutputMap(), SIGNAL(blackoutChanged(bool)), this, SLOT(slotBlackoutChanged(bool)));
 
     // Listen to DMX value changes and update each Fixture values array
-    connect(m_doc->inputOutputMap(), SIGNAL(universeWritten(quint32, const QByteArray&)),
-            this, SLOT(slotUniverseWritten(quint32, const QByteArray&)));
+    UniverseMonitor *monitor = new UniverseMonitor(m_doc->inputOutputMap(),
+                                                   UNIVERSEMONITOR_DEFAULT_RATE, this);
+    connect(monitor, SIGNAL(universeWritten(quint32, const QByteArray&, quint32)),
+            this, SLOT(slotUniverseWritten(quint32, const QByteArray&, quint32)));
 
     // Enable/Disable panic button
     connect(m_doc->masterTimer(), SIGNAL(functionListChanged()), this, SLOT(slotRunningFunctionsChanged()));
@@ -529,15 +532,10 @@ void App::slotDocModified(bool state)
         setWindowTitle(caption);
 }
 
-void App::slotUniverseWritten(quint32 idx, const QByteArray &ua)
+void App::slotUniverseWritten(quint32 idx, const QByteArray &ua, quint32 changedBlocks)
 {
-    foreach(Fixture *fixture, m_doc->fixtures())
-    {
-        if (fixture->universe() != idx)
-            continue;
-
+    foreach(Fixture *fixture, m_doc->fixturesInBlocks(idx, changedBlocks))
         fixture->setChannelValues(ua);
-    }
 }
 
 /*****************************************************************************
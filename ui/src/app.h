@@ -126,7 +126,7 @@ public:
 
 private slots:
     void slotDocModified(bool state);
-    void slotUniverseWritten(quint32 idx, const QByteArray& ua);
+    void slotUniverseWritten(quint32 idx, const QByteArray& ua, quint32 changedBlocks);
 
 private:
     void initDoc();
@@ -203,7 +203,8 @@ void DmxDumpFactory::slotDumpNonZeroChanged(bool active)
 void DmxDumpFactory::accept()
 {
     QByteArray dumpMask = m_properties->channelsMask();
-    QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses();
+    UniverseSnapshotPtr snapshot = m_doc->inputOutputMap()->universesSnapshot();
+    QList<Universe*> const& ua = snapshot->universes();
 
     QByteArray preGMValues(ua.size() * UNIVERSE_SIZE, 0); //= ua->preGMValues();
 
@@ -222,8 +223,6 @@ void DmxDumpFactory::accept()
         }
     }
 
-    m_doc->inputOutputMap()->releaseUniverses(false);
-
     Scene *newScene = NULL;
     if (m_selectedSceneID != Function::invalidId())
         newScene = qobject_cast<Scene*>(m_doc->function(m_selectedSceneID));
@@ -1281,11 +1281,7 @@ void FixtureManager::removeFixture()
             so it's rather safe to reset the fixture's address space here. */
         Fixture* fxi = m_doc->fixture(id);
         Q_ASSERT(fxi != NULL);
-        QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses();
-        int universe = fxi->universe();
-        if (universe < ua.count())
-            ua[universe]->reset(fxi->address(), fxi->channels());
-        m_doc->inputOutputMap()->releaseUniverses();
+        m_doc->inputOutputMap()->resetUniverseChannels(fxi->universe(), fxi->address(), fxi->channels());
 
         m_doc->deleteFixture(id);
     }
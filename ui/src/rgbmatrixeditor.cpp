@@ -495,7 +495,8 @@ bool RGBMatrixEditor::createPreviewItems()
     m_previewHandler->initializeDirection(m_matrix->direction(), m_matrix->startColor(),
                                           m_matrix->endColor(), m_matrix->stepsCount());
 
-    RGBMap map = m_matrix->previewMap(m_previewHandler->currentStepIndex(), m_previewHandler);
+    RGBMap map;
+    m_matrix->previewMap(m_previewHandler->currentStepIndex(), m_previewHandler, map);
 
     if (map.isEmpty())
         return false;
@@ -554,14 +555,14 @@ void RGBMatrixEditor::slotPreviewTimeout()
         m_previewHandler->checkNextStep(m_matrix->runOrder(), m_matrix->startColor(),
                                         m_matrix->endColor(), m_matrix->stepsCount());
 
-        map = m_matrix->previewMap(m_previewHandler->currentStepIndex(), m_previewHandler);
+        m_matrix->previewMap(m_previewHandler->currentStepIndex(), m_previewHandler, map);
 
         m_previewIterator -= MAX(m_matrix->duration(), MasterTimer::tick());
         elapsed += MAX(m_matrix->duration(), MasterTimer::tick());
     }
-    for (int y = 0; y < map.size(); y++)
+    for (int y = 0; y < map.height(); y++)
     {
-        for (int x = 0; x < map[y].size(); x++)
+        for (int x = 0; x < map.width(); x++)
         {
             QLCPoint pt(x, y);
             if (m_previewHash.contains(pt) == true)
@@ -1030,9 +1031,10 @@ void RGBMatrixEditor::slotSaveToSequenceClicked()
             sequence->setFadeOutSpeed(m_matrix->fadeOutSpeed());
         }
 
+        RGBMap map;
         for (int i = 0; i < totalSteps; i++)
         {
-            RGBMap map = m_matrix->previewMap(currentStep, m_previewHandler);
+            m_matrix->previewMap(currentStep, m_previewHandler, map);
             ChaserStep step;
             step.fid = grpScene->id();
             step.hold = m_matrix->duration() - m_matrix->fadeInSpeed();
@@ -1040,9 +1042,9 @@ void RGBMatrixEditor::slotSaveToSequenceClicked()
             step.fadeIn = m_matrix->fadeInSpeed();
             step.fadeOut = m_matrix->fadeOutSpeed();
 
-            for (int y = 0; y < map.size(); y++)
+            for (int y = 0; y < map.height(); y++)
             {
-                for (int x = 0; x < map[y].size(); x++)
+                for (int x = 0; x < map.width(); x++)
                 {
                     uint col = map[y][x];
                     QColor rgb = QColor(col);
@@ -39,6 +39,7 @@
 #include "grandmasterslider.h"
 #include "simpledeskengine.h"
 #include "speeddialwidget.h"
+#include "universemonitor.h"
 #include "fixtureconsole.h"
 #include "playbackslider.h"
 #include "consolechannel.h"
@@ -133,7 +134,9 @@ SimpleDesk::SimpleDesk(QWidget* parent, Doc* doc)
     connect(m_doc->inputOutputMap(), SIGNAL(universeRemoved(quint32)),
             this, SLOT(slotDocChanged()));
 
-    connect(m_doc->inputOutputMap(), SIGNAL(universeWritten(quint32, const QByteArray&)),
+    UniverseMonitor *monitor = new UniverseMonitor(m_doc->inputOutputMap(),
+                                                   UNIVERSEMONITOR_DEFAULT_RATE, this);
+    connect(monitor, SIGNAL(universeWritten(quint32, const QByteArray&, quint32)),
             this, SLOT(slotUniverseWritten(quint32, const QByteArray&)));
 }
 
@@ -375,14 +378,13 @@ uchar SimpleDesk::getAbsoluteChannelValue(uint address)
         return m_engine->value(address);
     else
     {
-        QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses();
+        UniverseSnapshotPtr snapshot = m_doc->inputOutputMap()->universesSnapshot();
+        QList<Universe*> const& ua = snapshot->universes();
         int uni = address >> 9;
         uint channel = address & 0x01FF;
-        if (uni >= ua.count())
-            return 0;
-        uchar value = ua.at(uni)->preGMValue(channel);
-        m_doc->inputOutputMap()->releaseUniverses(false);
-        return value;
+        if (uni < ua.count())
+            return ua.at(uni)->preGMValue(channel);
+        return 0;
     }
 }
 
@@ -137,6 +137,7 @@ HEADERS += virtualconsole/addvcbuttonmatrix.h \
            virtualconsole/vcframe.h \
            virtualconsole/vcframepageshortcut.h \
            virtualconsole/vcframeproperties.h \
+           virtualconsole/vcinputrouter.h \
            virtualconsole/vclabel.h \
            virtualconsole/vcmatrix.h \
            virtualconsole/vcmatrixcontrol.h \
@@ -314,6 +315,7 @@ SOURCES += virtualconsole/addvcbuttonmatrix.cpp \
            virtualconsole/vcframe.cpp \
            virtualconsole/vcframepageshortcut.cpp \
            virtualconsole/vcframeproperties.cpp \
+           virtualconsole/vcinputrouter.cpp \
            virtualconsole/vclabel.cpp \
            virtualconsole/vcmatrix.cpp \
            virtualconsole/vcmatrixcontrol.cpp \
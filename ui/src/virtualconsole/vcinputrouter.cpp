@@ -0,0 +1,147 @@
+/*
+  Q Light Controller Plus
+  vcinputrouter.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QPointer>
+#include <QDebug>
+
+#include "inputoutputmap.h"
+#include "vcinputrouter.h"
+#include "vcwidget.h"
+
+VCInputRouter::VCInputRouter(InputOutputMap *ioMap)
+    : QObject(ioMap)
+{
+    setObjectName("VCInputRouter");
+
+    connect(ioMap, SIGNAL(inputValueChanged(quint32,quint32,uchar)),
+            this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
+}
+
+VCInputRouter::~VCInputRouter()
+{
+}
+
+VCInputRouter *VCInputRouter::router(InputOutputMap *ioMap)
+{
+    Q_ASSERT(ioMap != NULL);
+
+    VCInputRouter *router = ioMap->findChild<VCInputRouter *>("VCInputRouter", Qt::FindDirectChildrenOnly);
+    if (router == NULL)
+        router = new VCInputRouter(ioMap);
+
+    return router;
+}
+
+quint64 VCInputRouter::key(quint32 universe, quint32 channel)
+{
+    return (quint64(universe) << 32) | (channel & 0xFFFF);
+}
+
+/****************************************************************************
+ * Subscriptions
+ ****************************************************************************/
+
+void VCInputRouter::setSubscriptions(VCWidget *widget, const QList<QPair<quint32, quint32> >& sources)
+{
+    if (widget == NULL)
+        return;
+
+    removeObject(widget);
+
+    if (sources.isEmpty())
+    {
+        disconnect(widget, SIGNAL(destroyed(QObject*)), this, SLOT(slotWidgetDestroyed(QObject*)));
+        return;
+    }
+
+    QSet<quint64> keys;
+    for (int i = 0; i < sources.count(); i++)
+    {
+        quint64 k = key(sources.at(i).first, sources.at(i).second);
+        if (keys.contains(k))
+            continue;
+
+        keys.insert(k);
+        m_routes[k].append(widget);
+    }
+
+    m_widgetKeys.insert(widget, keys);
+    connect(widget, SIGNAL(destroyed(QObject*)), this, SLOT(slotWidgetDestroyed(QObject*)),
+            Qt::UniqueConnection);
+}
+
+void VCInputRouter::unsubscribe(VCWidget *widget)
+{
+    setSubscriptions(widget, QList<QPair<quint32, quint32> >());
+}
+
+int VCInputRouter::subscribers(quint32 universe, quint32 channel) const
+{
+    return m_routes.value(key(universe, channel)).count();
+}
+
+void VCInputRouter::removeObject(QObject *object)
+{
+    QSet<quint64> keys = m_widgetKeys.take(object);
+    foreach (quint64 k, keys)
+    {
+        QHash<quint64, QList<VCWidget *> >::iterator it = m_routes.find(k);
+        if (it == m_routes.end())
+            continue;
+
+        /* Compare as QObject pointers: $object may be half destroyed */
+        QList<VCWidget *>& widgets = it.value();
+        for (int i = widgets.count() - 1; i >= 0; i--)
+        {
+            if (static_cast<QObject *>(widgets.at(i)) == object)
+                widgets.removeAt(i);
+        }
+
+        if (widgets.isEmpty())
+            m_routes.erase(it);
+    }
+}
+
+/****************************************************************************
+ * Delivery
+ ****************************************************************************/
+
+void VCInputRouter::slotInputValueChanged(quint32 universe, quint32 channel, uchar value)
+{
+    QHash<quint64, QList<VCWidget *> >::const_iterator it = m_routes.constFind(key(universe, channel));
+    if (it == m_routes.constEnd())
+        return;
+
+    /* A widget may change the subscriptions (e.g. by flipping a page),
+     * or even be deleted, while handling the value */
+    QList<QPointer<VCWidget> > widgets;
+    foreach (VCWidget *widget, it.value())
+        widgets.append(widget);
+
+    foreach (QPointer<VCWidget> widget, widgets)
+    {
+        if (widget.isNull() == false)
+            widget->slotInputValueChanged(universe, channel, value);
+    }
+}
+
+void VCInputRouter::slotWidgetDestroyed(QObject *object)
+{
+    removeObject(object);
+}
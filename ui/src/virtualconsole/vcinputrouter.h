@@ -0,0 +1,89 @@
+/*
+  Q Light Controller Plus
+  vcinputrouter.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef VCINPUTROUTER_H
+#define VCINPUTROUTER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QSet>
+
+class InputOutputMap;
+class VCWidget;
+
+/** @addtogroup ui_vc
+ * @{
+ */
+
+/**
+ * VCInputRouter delivers external input values to the Virtual Console
+ * widgets bound to them.
+ *
+ * Instead of every input-enabled widget receiving (as a queued event)
+ * every input value and filtering it, the router receives each value
+ * once and dispatches it only to the widgets subscribed to its
+ * (universe, channel) pair. Pages are not part of the index: widgets
+ * still discard the values of pages they are not showing.
+ *
+ * There is one router per InputOutputMap, created on demand as its child.
+ */
+class VCInputRouter : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(VCInputRouter)
+
+public:
+    /** Get the router of $ioMap, creating it if needed */
+    static VCInputRouter *router(InputOutputMap *ioMap);
+
+    ~VCInputRouter();
+
+    /** Replace the (universe, channel) pairs $widget is subscribed to.
+     *  Channels may carry a page in the upper 16 bits, which is ignored */
+    void setSubscriptions(VCWidget *widget, const QList<QPair<quint32, quint32> >& sources);
+
+    /** Remove every subscription of $widget */
+    void unsubscribe(VCWidget *widget);
+
+    /** Return the number of widgets subscribed to ($universe, $channel) */
+    int subscribers(quint32 universe, quint32 channel) const;
+
+private:
+    VCInputRouter(InputOutputMap *ioMap);
+
+    static quint64 key(quint32 universe, quint32 channel);
+
+    /** Remove every subscription of $object, that may be already destroyed */
+    void removeObject(QObject *object);
+
+private slots:
+    void slotInputValueChanged(quint32 universe, quint32 channel, uchar value);
+    void slotWidgetDestroyed(QObject *object);
+
+private:
+    /** (universe, channel) => subscribed widgets */
+    QHash<quint64, QList<VCWidget *> > m_routes;
+    /** widget => its (universe, channel) keys */
+    QHash<QObject *, QSet<quint64> > m_widgetKeys;
+};
+
+/** @} */
+
+#endif
@@ -47,6 +47,7 @@
 
 #include "qlcinputchannel.h"
 #include "virtualconsole.h"
+#include "vcinputrouter.h"
 #include "vcproperties.h"
 #include "inputpatch.h"
 #include "vcwidget.h"
@@ -586,8 +587,6 @@ void VCWidget::setInputSource(QSharedPointer<QLCInputSource> const& source, quin
     // Connect when the first valid input source is set
     if (m_inputs.isEmpty() == true && !source.isNull() && source->isValid() == true)
     {
-        connect(m_doc->inputOutputMap(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
-                this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
         connect(m_doc->inputOutputMap(), SIGNAL(profileChanged(quint32,QString)),
                 this, SLOT(slotInputProfileChanged(quint32,QString)));
     }
@@ -650,11 +649,23 @@ void VCWidget::setInputSource(QSharedPointer<QLCInputSource> const& source, quin
     // Disconnect when there are no more input sources present
     if (m_inputs.isEmpty() == true)
     {
-        disconnect(m_doc->inputOutputMap(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
-                   this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
         disconnect(m_doc->inputOutputMap(), SIGNAL(profileChanged(quint32,QString)),
                    this, SLOT(slotInputProfileChanged(quint32,QString)));
     }
+
+    updateInputRouting();
+}
+
+void VCWidget::updateInputRouting()
+{
+    QList<QPair<quint32, quint32> > sources;
+    foreach (QSharedPointer<QLCInputSource> src, m_inputs)
+    {
+        if (!src.isNull() && src->isValid())
+            sources.append(QPair<quint32, quint32>(src->universe(), src->channel()));
+    }
+
+    VCInputRouter::router(m_doc->inputOutputMap())->setSubscriptions(this, sources);
 }
 
 QSharedPointer<QLCInputSource> VCWidget::inputSource(quint8 id) const
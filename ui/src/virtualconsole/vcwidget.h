@@ -473,6 +473,13 @@ protected slots:
 protected:
     QHash <quint8, QSharedPointer<QLCInputSource> > m_inputs;
 
+private:
+    /** Subscribe to the input router with the current input sources */
+    void updateInputRouting();
+
+    /** The router delivers the input values to slotInputValueChanged() */
+    friend class VCInputRouter;
+
     /*********************************************************************
      * Key sequence handler
      *********************************************************************/
@@ -44,6 +44,7 @@
 #include "vcpropertieseditor.h"
 #include "vcxypadproperties.h"
 #include "qlcinputchannel.h"
+#include "universemonitor.h"
 #include "virtualconsole.h"
 #include "ctkrangeslider.h"
 #include "mastertimer.h"
@@ -177,8 +178,13 @@ VCXYPad::VCXYPad(QWidget* parent, Doc* doc) : VCWidget(parent, doc)
     setLiveEdit(m_liveEdit);
 
     m_doc->masterTimer()->registerDMXSource(this);
-    connect(m_doc->inputOutputMap(), SIGNAL(universeWritten(quint32,QByteArray)),
-            this, SLOT(slotUniverseWritten(quint32,QByteArray)));
+
+    /* All the pads share the monitor of the Virtual Console */
+    if (VirtualConsole::instance() != NULL)
+    {
+        connect(VirtualConsole::instance()->universeMonitor(), SIGNAL(universeWritten(quint32,QByteArray,quint32)),
+                this, SLOT(slotUniverseWritten(quint32,QByteArray)));
+    }
 }
 
 VCXYPad::~VCXYPad()
@@ -555,8 +561,33 @@ void VCXYPad::slotRangeValueChanged()
         sendFeedback(m_vRangeSlider->maximumValue(), widthInputSourceId);
 }
 
+bool VCXYPad::usesUniverse(quint32 universe) const
+{
+    if (m_scene)
+    {
+        foreach (SceneChannel sc, m_sceneChannels)
+        {
+            if (sc.m_universe == universe)
+                return true;
+        }
+        return false;
+    }
+
+    foreach (VCXYPadFixture fixture, m_fixtures)
+    {
+        if (fixture.isEnabled() && fixture.universe() == universe)
+            return true;
+    }
+
+    return false;
+}
+
 void VCXYPad::slotUniverseWritten(quint32 idx, const QByteArray &universeData)
 {
+    /* The shared monitor reports every universe */
+    if (usesUniverse(idx) == false)
+        return;
+
     QVariantList positions;
 
     if (m_scene)
@@ -192,6 +192,10 @@ public slots:
     void slotRangeValueChanged();
     void slotUniverseWritten(quint32 idx, const QByteArray& universeData);
 
+private:
+    /** Return true if the pad controls some channels of $universe */
+    bool usesUniverse(quint32 universe) const;
+
 signals:
     void fixturePositions(const QVariantList positions);
 
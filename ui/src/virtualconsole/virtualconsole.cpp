@@ -45,6 +45,7 @@
 #include "addvcslidermatrix.h"
 #include "vcaudiotriggers.h"
 #include "virtualconsole.h"
+#include "universemonitor.h"
 #include "dmxdumpfactory.h"
 #include "vcproperties.h"
 #include "vcspeeddial.h"
@@ -73,6 +74,7 @@ VirtualConsole::VirtualConsole(QWidget* parent, Doc* doc)
     : QWidget(parent)
     , m_doc(doc)
     , m_latestWidgetId(0)
+    , m_universeMonitor(NULL)
 
     , m_editAction(EditNone)
     , m_toolbar(NULL)
@@ -142,6 +144,9 @@ VirtualConsole::VirtualConsole(QWidget* parent, Doc* doc)
 
     Q_ASSERT(doc != NULL);
 
+    m_universeMonitor = new UniverseMonitor(m_doc->inputOutputMap(),
+                                            UNIVERSEMONITOR_DEFAULT_RATE, this);
+
     /* Main layout */
     new QHBoxLayout(this);
     layout()->setMargin(1);
@@ -180,6 +185,11 @@ Doc *VirtualConsole::getDoc()
     return m_doc;
 }
 
+UniverseMonitor *VirtualConsole::universeMonitor() const
+{
+    return m_universeMonitor;
+}
+
 quint32 VirtualConsole::newWidgetId()
 {
     /* This results in an endless loop if there are UINT_MAX-1 widgets. That,
@@ -29,6 +29,8 @@
 #include "vcproperties.h"
 #include "doc.h"
 
+class UniverseMonitor;
+
 class QXmlStreamReader;
 class QXmlStreamWriter;
 class VirtualConsole;
@@ -65,6 +67,9 @@ public:
 
     Doc *getDoc();
 
+    /** Get the monitor shared by the widgets displaying universe values */
+    UniverseMonitor *universeMonitor() const;
+
 protected:
     /** Create a new widget ID */
     quint32 newWidgetId();
@@ -77,6 +82,9 @@ private:
     /** Latest assigned widget ID */
     quint32 m_latestWidgetId;
 
+    /** Pulls the universe values for all the widgets at once */
+    UniverseMonitor *m_universeMonitor;
+
     /*********************************************************************
      * Properties
      *********************************************************************/
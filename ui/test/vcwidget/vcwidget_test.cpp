@@ -29,6 +29,7 @@
 #include "virtualconsole.h"
 #include "qlcinputsource.h"
 #include "vcwidget_test.h"
+#include "vcinputrouter.h"
 #include "mastertimer.h"
 #include "stubwidget.h"
 #include "vcwidget.h"
@@ -307,6 +308,11 @@ void VCWidget_Test::inputSource()
     QCOMPARE(src->universe(), quint32(1));
     QCOMPARE(src->channel(), quint32(2));
 
+    // Only the bound channel is routed to the widget
+    VCInputRouter *router = VCInputRouter::router(m_doc->inputOutputMap());
+    QCOMPARE(router->subscribers(1, 2), 1);
+    QCOMPARE(router->subscribers(1, 3), 0);
+
     src = stub.inputSource(0);
     QVERIFY(src->isValid() == true);
     QCOMPARE(src->universe(), quint32(1));
@@ -324,10 +330,21 @@ void VCWidget_Test::inputSource()
     QVERIFY(src->isValid() == true);
     QCOMPARE(src->universe(), quint32(3));
     QCOMPARE(src->channel(), quint32(4));
+    QCOMPARE(router->subscribers(1, 2), 0);
+    QCOMPARE(router->subscribers(3, 4), 1);
 
     stub.setInputSource(QSharedPointer<QLCInputSource>(new QLCInputSource()));
     src = stub.inputSource();
     QVERIFY(src == NULL);
+    QCOMPARE(router->subscribers(3, 4), 0);
+
+    {
+        // Destroyed widgets are unsubscribed
+        StubWidget other(&w, m_doc);
+        other.setInputSource(QSharedPointer<QLCInputSource>(new QLCInputSource(5, 6)));
+        QCOMPARE(router->subscribers(5, 6), 1);
+    }
+    QCOMPARE(router->subscribers(5, 6), 0);
 
     // Just for coverage - the implementation does nothing
     stub.slotInputValueChanged(0, 1, 2);
@@ -27,6 +27,7 @@
 #include "webaccessconfiguration.h"
 #include "webaccesssimpledesk.h"
 #include "webaccessnetwork.h"
+#include "engineprofiler.h"
 #include "vcaudiotriggers.h"
 #include "virtualconsole.h"
 #include "commonjscss.h"
@@ -566,6 +567,52 @@ void WebAccess::slotHandleWebSocketRequest(QHttpConnection *conn, QString data)
             }
             return;
         }
+        else if (apiCmd == "getEngineProfile")
+        {
+            // Stage|ID|Name|Samples|p50|p99|max|... with times in microseconds
+            foreach (EngineProfiler::Summary summary, EngineProfiler::instance()->summaries())
+            {
+                QString name;
+                if (summary.stage == EngineProfiler::FunctionWriteStage)
+                {
+                    Function *f = m_doc->function(summary.id);
+                    name = (f != NULL) ? f->name() : QString();
+                }
+                else if (summary.stage == EngineProfiler::FadersStage ||
+                         summary.stage == EngineProfiler::OutputStage)
+                {
+                    name = m_doc->inputOutputMap()->getUniverseNameByID(summary.id);
+                }
+
+                wsAPIMessage.append(QString("%1|%2|%3|%4|%5|%6|%7|")
+                                    .arg(EngineProfiler::stageToString(summary.stage))
+                                    .arg(summary.id).arg(name).arg(summary.count)
+                                    .arg(summary.p50 / 1000).arg(summary.p99 / 1000)
+                                    .arg(summary.max / 1000));
+            }
+            // remove trailing separator
+            wsAPIMessage.truncate(wsAPIMessage.length() - 1);
+        }
+        else if (apiCmd == "setEngineProfiler")
+        {
+            if (m_auth && user && user->level < SUPER_ADMIN_LEVEL)
+                return;
+
+            if (cmdList.count() < 3)
+                return;
+
+            EngineProfiler *profiler = EngineProfiler::instance();
+            if (cmdList[2].toInt() != 0)
+            {
+                profiler->reset();
+                profiler->setEnabled(true);
+            }
+            else
+            {
+                profiler->setEnabled(false);
+            }
+            return;
+        }
         else if (apiCmd == "getWidgetsNumber")
         {
             VCFrame *mainFrame = m_vc->contents();